@@ -20,10 +20,14 @@
 
 #include <csvexport.h>
 
+#include <QByteArray>
 #include <QFile>
+#include <QPair>
+#include <QRect>
 #include <QTextCodec>
-#include <QTextStream>
-#include <QByteArray>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
 
 #include <kdebug.h>
 #include <kmessagebox.h>
@@ -31,7 +35,10 @@
 #include <KoFilterChain.h>
 #include <KoFilterManager.h>
 
+#include <kcells/KCCalculationSettings.h>
+#include <kcells/KCCell.h>
 #include <kcells/KCCellStorage.h>
+#include <kcells/kcells_limits.h>
 #include <kcells/KCMap.h>
 #include <kcells/KCSheet.h>
 #include <kcells/part/KCDoc.h>
@@ -44,22 +51,106 @@
 K_PLUGIN_FACTORY(CSVExportFactory, registerPlugin<CSVExport>();)
 K_EXPORT_PLUGIN(CSVExportFactory("kofficefilters"))
 
-CSVExport::CSVExport(QObject* parent, const QVariantList &)
-        : KoFilter(parent), m_eol("\n")
+// the number of rows collected at once; the chunks of a wave are encoded in parallel
+static const int g_rowsPerChunk = 4096;
+
+namespace
 {
-}
+/**
+ * The text of the non-empty cells of a row, sorted by column.
+ */
+typedef QVector<QPair<int, QString> > RowData;
+
+/**
+ * Consecutive rows, that are encoded together.
+ */
+struct Chunk {
+    QVector<RowData> rows;
+    QByteArray data;
+};
+
+/**
+ * Quotes, joins and encodes the rows of a chunk.
+ * Used from several threads at once; it must not touch the document.
+ */
+class ChunkEncoder
+{
+public:
+    typedef void result_type;
+
+    ChunkEncoder(QTextCodec* codec, QChar textQuote, QChar csvDelimiter, const QString& eol,
+                 int firstColumn, int lastColumn, bool fillRows)
+            : codec(codec)
+            , textQuote(textQuote)
+            , csvDelimiter(csvDelimiter)
+            , eol(eol)
+            , firstColumn(firstColumn)
+            , lastColumn(lastColumn)
+            , fillRows(fillRows) {}
+
+    void operator()(Chunk& chunk) const {
+        QString str;
+        for (int i = 0; i < chunk.rows.count(); ++i) {
+            const RowData& row = chunk.rows[i];
+            // The delimiters are only written up to the last non-empty cell,
+            // unless all rows should have the same number of columns.
+            int delimiters = 0;
+            for (int j = 0; j < row.count(); ++j) {
+                for (; delimiters < row[j].first - firstColumn; ++delimiters)
+                    str += csvDelimiter;
+                str += quote(row[j].second);
+            }
+            if (fillRows) {
+                for (; delimiters < lastColumn - firstColumn; ++delimiters)
+                    str += csvDelimiter;
+            }
+            str += eol;
+        }
+        // Do not write a byte order mark; QTextStream did not either.
+        QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+        chunk.data = codec->fromUnicode(str.constData(), str.length(), &state);
+        chunk.rows.clear();
+    }
 
-QString CSVExport::exportCSVCell(const KCDoc* doc, KCSheet const * const sheet,
-                                 int col, int row, QChar const & textQuote, QChar csvDelimiter)
+private:
+    QString quote(QString text) const {
+        // quote only when needed (try to mimic excel)
+        bool quote = false;
+        if (text.indexOf(textQuote) != -1) {
+            QString doubleTextQuote(textQuote);
+            doubleTextQuote.append(textQuote);
+            text.replace(textQuote, doubleTextQuote);
+            quote = true;
+
+        } else if (text[0].isSpace() || text[text.length()-1].isSpace())
+            quote = true;
+        else if (text.indexOf(csvDelimiter) != -1)
+            quote = true;
+
+        if (quote) {
+            text.prepend(textQuote);
+            text.append(textQuote);
+        }
+        return text;
+    }
+
+    QTextCodec* codec;
+    QChar textQuote;
+    QChar csvDelimiter;
+    QString eol;
+    int firstColumn;
+    int lastColumn;
+    bool fillRows;
+};
+
+/**
+ * \return the text of \p cell to export
+ */
+QString cellText(const KCCell& cell)
 {
-    // This function, given a cell, returns a string corresponding to its export in CSV format
-    // It proceeds by:
-    //  - getting the value of the cell, if any
-    //  - protecting quote characters within cells, if any
-    //  - enclosing the cell in quotes if the cell is non empty
-
-    Q_UNUSED(doc);
-    const KCCell cell(sheet, col, row);
+    // This function, given a cell, returns a string corresponding to its value.
+    // The quoting is done by ChunkEncoder.
+    const KCSheet* const sheet = cell.sheet();
     QString text;
 
     if (!cell.isDefault() && !cell.isEmpty()) {
@@ -74,28 +165,80 @@ QString CSVExport::exportCSVCell(const KCDoc* doc, KCSheet const * const sheet,
         else
             text = cell.displayText();
     }
+    return text;
+}
 
-    // quote only when needed (try to mimic excel)
-    bool quote = false;
-    if (!text.isEmpty()) {
-        if (text.indexOf(textQuote) != -1) {
-            QString doubleTextQuote(textQuote);
-            doubleTextQuote.append(textQuote);
-            text.replace(textQuote, doubleTextQuote);
-            quote = true;
-
-        } else if (text[0].isSpace() || text[text.length()-1].isSpace())
-            quote = true;
-        else if (text.indexOf(csvDelimiter) != -1)
-            quote = true;
+/**
+ * Determines the area in \p range , that contains non-empty cells.
+ * \return the area or an empty rectangle, if there are no non-empty cells
+ */
+QRect usedArea(const KCSheet* sheet, const QRect& range)
+{
+    const KCCellStorage* const storage = sheet->cellStorage();
+    const int bottom = qMin(range.bottom(), storage->rows(false));
+    int maxRow = 0;
+    int maxCol = 0;
+    for (int row = range.top(); row <= bottom; ++row) {
+        KCCell cell = storage->firstInRow(row, KCCellStorage::VisitContent);
+        while (!cell.isNull() && cell.column() <= range.right()) {
+            if (cell.column() >= range.left() && !cell.isEmpty()) {
+                maxRow = row;
+                maxCol = qMax(maxCol, cell.column());
+            }
+            cell = storage->nextInRow(cell.column(), row, KCCellStorage::VisitContent);
+        }
     }
+    if (maxRow == 0)
+        return QRect();
+    return QRect(QPoint(range.left(), range.top()), QPoint(maxCol, maxRow));
+}
+}
 
-    if (quote) {
-        text.prepend(textQuote);
-        text.append(textQuote);
-    }
+CSVExport::CSVExport(QObject* parent, const QVariantList &)
+        : KoFilter(parent), m_eol("\n")
+{
+}
 
-    return text;
+bool CSVExport::exportRange(QIODevice* out, const KCSheet* sheet, const QRect& range, bool fillRows,
+                            QTextCodec* codec, QChar textQuote, QChar csvDelimiter)
+{
+    const KCCellStorage* const storage = sheet->cellStorage();
+    const ChunkEncoder encoder(codec, textQuote, csvDelimiter, m_eol,
+                               range.left(), range.right(), fillRows);
+    // idealThreadCount() is -1, if the number of cores is unknown
+    const int chunkCount = qMax(1, QThread::idealThreadCount());
+
+    int row = range.top();
+    while (row <= range.bottom()) {
+        // Collect the cell texts of a few chunks. The document is not thread safe.
+        QList<Chunk> chunks;
+        for (int i = 0; i < chunkCount && row <= range.bottom(); ++i) {
+            Chunk chunk;
+            const int last = qMin(row + g_rowsPerChunk - 1, range.bottom());
+            chunk.rows.resize(last - row + 1);
+            for (int index = 0; row <= last; ++row, ++index) {
+                RowData& rowData = chunk.rows[index];
+                KCCell cell = storage->firstInRow(row, KCCellStorage::VisitContent);
+                while (!cell.isNull() && cell.column() <= range.right()) {
+                    if (cell.column() >= range.left()) {
+                        const QString text = cellText(cell);
+                        if (!text.isEmpty())
+                            rowData.append(qMakePair(cell.column(), text));
+                    }
+                    cell = storage->nextInRow(cell.column(), row, KCCellStorage::VisitContent);
+                }
+            }
+            chunks.append(chunk);
+        }
+
+        QtConcurrent::blockingMap(chunks, encoder);
+        for (int i = 0; i < chunks.count(); ++i) {
+            if (out->write(chunks[i].data) != chunks[i].data.size())
+                return false;
+        }
+        emit sigProgress(100 * (row - range.top()) / range.height());
+    }
+    return true;
 }
 
 // The reason why we use the KoDocument* approach and not the QDomDocument
@@ -155,6 +298,21 @@ KoFilter::ConversionStatus CSVExport::convert(const QByteArray & from, const QBy
         csvDelimiter = ',';
     }
 
+    // Check for a selection to export, before the output file gets truncated.
+    const bool selectionOnly = expDialog && expDialog->exportSelectionOnly();
+    KCView const * const view = ksdoc->views().isEmpty() ? 0 : static_cast<KCView*>(ksdoc->views().first());
+    if (selectionOnly && !view) { // no view if embedded document
+        delete expDialog;
+        return KoFilter::StupidError;
+    }
+
+    QFile out(m_chain->outputFile());
+    if (!out.open(QIODevice::WriteOnly)) {
+        kError(30501) << "Unable to open output file!" << endl;
+        out.close();
+        delete expDialog;
+        return KoFilter::StupidError;
+    }
 
     // Now get hold of the sheet to export
     // (Hey, this could be part of the dialog too, choosing which sheet to export....
@@ -162,62 +320,22 @@ KoFilter::ConversionStatus CSVExport::convert(const QByteArray & from, const QBy
     // Ok, for now we'll use the first sheet - my document has only one sheet anyway ;-)))
 
     bool first = true;
-    QString str;
+    bool ok = true;
     QChar textQuote;
     if (expDialog)
         textQuote = expDialog->getTextQuote();
     else
         textQuote = '"';
 
-    if (expDialog && expDialog->exportSelectionOnly()) {
+    if (selectionOnly) {
         kDebug(30501) << "Export as selection mode";
-        KCView const * const view = ksdoc->views().isEmpty() ? 0 : static_cast<KCView*>(ksdoc->views().first());
-
-        if (!view) { // no view if embedded document
-            delete expDialog;
-            return KoFilter::StupidError;
-        }
-
         KCSheet const * const sheet = view->activeSheet();
 
-        QRect selection = view->selection()->lastRange();
-        // Compute the highest row and column indexes (within the selection)
-        // containing non-empty cells, respectively called CSVMaxRow CSVMaxCol.
-        // The CSV will have CSVMaxRow rows, all with CSVMaxCol columns
-        int right       = selection.right();
-        int bottom      = selection.bottom();
-        int CSVMaxRow   = 0;
-        int CSVMaxCol   = 0;
-
-        for (int idxRow = 1, row = selection.top(); row <= bottom; ++row, ++idxRow) {
-            for (int idxCol = 1, col = selection.left(); col <= right; ++col, ++idxCol) {
-                if (!KCCell(sheet, col, row).isEmpty()) {
-                    if (idxRow > CSVMaxRow)
-                        CSVMaxRow = idxRow;
-
-                    if (idxCol > CSVMaxCol)
-                        CSVMaxCol = idxCol;
-                }
-            }
-        }
-
-        for (int idxRow = 1, row = selection.top();
-                row <= bottom && idxRow <= CSVMaxRow; ++row, ++idxRow) {
-            int idxCol = 1;
-            for (int col = selection.left();
-                    col <= right && idxCol <= CSVMaxCol; ++col, ++idxCol) {
-                str += exportCSVCell(ksdoc, sheet, col, row, textQuote, csvDelimiter);
-
-                if (idxCol < CSVMaxCol)
-                    str += csvDelimiter;
-            }
-
-            // This is to deal with the case of non-rectangular selections
-            for (; idxCol < CSVMaxCol; ++idxCol)
-                str += csvDelimiter;
-
-            str += m_eol;
-        }
+        // The CSV will have all rows and columns of the selection up to the
+        // last ones containing non-empty cells.
+        const QRect range = usedArea(sheet, view->selection()->lastRange());
+        if (!range.isEmpty())
+            ok = exportRange(&out, sheet, range, true, codec, textQuote, csvDelimiter);
     } else {
         kDebug(30501) << "Export as full mode";
         foreach(const KCSheet * const sheet, ksdoc->map()->sheetList()) {
@@ -225,34 +343,18 @@ KoFilter::ConversionStatus CSVExport::convert(const QByteArray & from, const QBy
                 continue;
             }
 
-            // Compute the highest row and column indexes containing non-empty cells,
-            // respectively called CSVMaxRow CSVMaxCol.
-            // The CSV will have CSVMaxRow rows, all with CSVMaxCol columns
-            int sheetMaxRow = sheet->cellStorage()->rows();
-            int sheetMaxCol = sheet->cellStorage()->columns();
-            int CSVMaxRow   = 0;
-            int CSVMaxCol   = 0;
-
-            for (int row = 1 ; row <= sheetMaxRow ; ++row) {
-                for (int col = 1 ; col <= sheetMaxCol ; col++) {
-                    if (!KCCell(sheet, col, row).isEmpty()) {
-                        if (row > CSVMaxRow)
-                            CSVMaxRow = row;
-
-                        if (col > CSVMaxCol)
-                            CSVMaxCol = col;
-                    }
-                }
-            }
+            // Compute the highest row and column indexes containing non-empty cells.
+            const QRect range = usedArea(sheet, QRect(1, 1, KS_colMax, KS_rowMax));
 
             // Skip the sheet altogether if it is empty
-            if (CSVMaxRow + CSVMaxCol == 0)
+            if (range.isEmpty())
                 continue;
 
-            kDebug(30501) << "Max row x column:" << CSVMaxRow << " x" << CSVMaxCol;
+            kDebug(30501) << "Max row x column:" << range.bottom() << " x" << range.right();
 
             // Print sheet separators, except for the first sheet
             if (!first || (expDialog && expDialog->printAlwaysSheetDelimiter())) {
+                QString str;
                 if (!first)
                     str += m_eol;
 
@@ -269,62 +371,30 @@ KoFilter::ConversionStatus CSVExport::convert(const QByteArray & from, const QBy
                 str += name;
                 str += m_eol;
                 str += m_eol;
+
+                QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+                const QByteArray data = codec->fromUnicode(str.constData(), str.length(), &state);
+                ok = out.write(data) == data.size();
             }
 
             first = false;
 
-
-            // this is just a bad approximation which fails for documents with less than 50 rows, but
-            // we don't need any progress stuff there anyway :) (Werner)
-            int value = 0;
-            int step  = CSVMaxRow > 50 ? CSVMaxRow / 50 : 1;
-
             // Print the CSV for the sheet data
-            for (int row = 1, i = 1 ; row <= CSVMaxRow ; ++row, ++i) {
-                if (i > step) {
-                    value += 2;
-                    emit sigProgress(value);
-                    i = 0;
-                }
-
-                QString collect;  // buffer delimiters while reading empty cells
-
-                for (int col = 1 ; col <= CSVMaxCol ; col++) {
-                    const QString txt = exportCSVCell(ksdoc, sheet, col, row, textQuote, csvDelimiter);
-
-                    // if we encounter a non-empty cell, commit the buffered delimiters
-                    if (!txt.isEmpty()) {
-                        str += collect + txt;
-                        collect.clear();
-                    }
-
-                    collect += csvDelimiter;
-                }
-                // Here, throw away buffered delimiters. They're trailing and therefore
-                // superfluous.
-
-                str += m_eol;
-            }
+            if (ok)
+                ok = exportRange(&out, sheet, range, false, codec, textQuote, csvDelimiter);
+            if (!ok)
+                break;
         }
     }
 
     emit sigProgress(100);
 
-    QFile out(m_chain->outputFile());
-    if (!out.open(QIODevice::WriteOnly)) {
-        kError(30501) << "Unable to open output file!" << endl;
-        out.close();
-        delete expDialog;
-        return KoFilter::StupidError;
-    }
-
-    QTextStream outStream(&out);
-    outStream.setCodec(codec);
-
-    outStream << str;
-
     out.close();
     delete expDialog;
+    if (!ok) {
+        kError(30501) << "Unable to write the output file!" << endl;
+        return KoFilter::CreationError;
+    }
     return KoFilter::OK;
 }
 
@@ -26,8 +26,10 @@
 #include <KoFilter.h>
 #include <QVariantList>
 
+class QIODevice;
+class QRect;
+class QTextCodec;
 class KCSheet;
-class KCDoc;
 
 class CSVExport : public KoFilter
 {
@@ -40,8 +42,15 @@ public:
     virtual KoFilter::ConversionStatus convert(const QByteArray & from, const QByteArray & to);
 
 private:
-    QString exportCSVCell(const KCDoc* doc, KCSheet const * const sheet,
-                          int col, int row, QChar const & textQuote, QChar csvDelimiter);
+    /**
+     * Writes the cells in \p range of \p sheet to \p out .
+     * The text of the cells is collected in chunks of rows, which are then
+     * quoted, joined and encoded in parallel and written in order.
+     * \param fillRows if \c true , all rows get the same number of delimiters
+     * \return \c false , if writing failed
+     */
+    bool exportRange(QIODevice* out, const KCSheet* sheet, const QRect& range, bool fillRows,
+                     QTextCodec* codec, QChar textQuote, QChar csvDelimiter);
 
 private:
     QString m_eol; ///< End of line (LF, CR or CRLF)
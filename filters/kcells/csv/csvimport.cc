@@ -20,10 +20,14 @@
 
 #include "csvimport.h"
 
+#include <QBitArray>
+#include <QBuffer>
 #include <QByteArray>
 #include <QFile>
 #include <QRegExp>
+#include <QThread>
 #include <QVector>
+#include <QtConcurrentMap>
 
 #include <kapplication.h>
 #include <kmessagebox.h>
@@ -44,6 +48,9 @@
 #include <kcells/KCStyle.h>
 #include <kcells/KCValue.h>
 #include <kcells/KCValueConverter.h>
+#include <kcells/KCValueParser.h>
+
+#include "csvtokenizer.h"
 
 // hehe >:->
 
@@ -53,6 +60,239 @@
  perl -e '$i=0;while($i<30000) { print rand().",".rand()."\n"; $i++ }' > file.csv
 */
 
+// the number of lines shown in the preview of the import dialog
+static const int g_previewLines = 1000;
+// the size of the parts of the file split into fields in parallel
+static const int g_chunkSize = 4 * 1024 * 1024;
+
+namespace
+{
+/**
+ * A field of the CSV file.
+ */
+struct Field {
+    int row;
+    int column;
+    QString text;
+    KCValue value;  // the value, if it was parsed in advance
+    bool parsed;
+};
+
+/**
+ * A part of the CSV file ending at a line end.
+ * As every line end starts a new row in the state machine of the tokenizer
+ * (even in quoted fields), the chunks can be split into fields independently.
+ */
+struct Chunk {
+    QByteArray data;
+    QVector<Field> fields;
+    int rows;   // the number of line ends in the chunk
+};
+
+/**
+ * Splits a chunk into fields and parses the fields of numeric columns.
+ * Used from several threads at once; it must not touch the document.
+ */
+class ChunkTokenizer
+{
+public:
+    typedef void result_type;
+
+    ChunkTokenizer(const KoCsvImportDialog* dialog, const QBitArray& numericColumns,
+                   const QString& negativeSign)
+            : codec(dialog->codec())
+            , delimiter(dialog->delimiter())
+            , textQuote(dialog->textQuote())
+            , ignoreDuplicates(dialog->ignoreDuplicates())
+            , decimalSymbol(dialog->decimalSymbol())
+            , negativeSign(negativeSign)
+            , numericColumns(numericColumns) {}
+
+    void operator()(Chunk& chunk) const {
+        {
+            QBuffer buffer(&chunk.data);
+            buffer.open(QIODevice::ReadOnly);
+            CSVTokenizer tokenizer(&buffer, codec, delimiter, textQuote, ignoreDuplicates);
+            Field field;
+            while (tokenizer.readField(field.text, field.row, field.column)) {
+                field.parsed = false;
+                if (field.column < numericColumns.count() && numericColumns.testBit(field.column)) {
+                    field.value = KCValueParser::readPlainNumber(field.text.trimmed(), negativeSign,
+                                                                 decimalSymbol, &field.parsed);
+                }
+                chunk.fields.append(field);
+            }
+            chunk.rows = tokenizer.currentRow() - 1;
+        }
+        chunk.data.clear();
+    }
+
+private:
+    QTextCodec* codec;
+    QString delimiter;
+    QChar textQuote;
+    bool ignoreDuplicates;
+    QString decimalSymbol;
+    QString negativeSign;
+    QBitArray numericColumns;
+};
+
+/**
+ * Stores the fields in the sheet.
+ */
+class FieldWriter
+{
+public:
+    FieldWriter(KCSheet* sheet, const KoCsvImportDialog* dialog, int endRow);
+
+    /**
+     * Stores \p field in the sheet, if it is in the range to import.
+     * \return \c false , if the field is beyond the last row to import
+     */
+    bool write(const Field& field);
+
+    /**
+     * Widens the columns to their contents.
+     */
+    void adjustColumnWidths();
+
+private:
+    KCSheet* const sheet;
+    const KoCsvImportDialog* const dialog;
+    const int startRow;
+    const int startCol;
+    const int endRow;
+    const int endCol;
+    const double defaultWidth;
+    QFontMetrics fm;
+    QVector<double> widths;
+    QVector<KoCsvImportDialog::DataType> dataTypes;
+};
+
+FieldWriter::FieldWriter(KCSheet* sheet, const KoCsvImportDialog* dialog, int endRow)
+        : sheet(sheet)
+        , dialog(dialog)
+        , startRow(dialog->startRow())
+        , startCol(dialog->startCol())
+        , endRow(endRow)
+        , endCol(dialog->endCol())
+        , defaultWidth(sheet->map()->defaultColumnFormat()->width())
+        , fm(KCCell(sheet, 1, 1).style().font())
+{
+}
+
+bool FieldWriter::write(const Field& field)
+{
+    if (endRow != -1 && field.row > endRow)
+        return false;
+    if (field.row < startRow || field.column < startCol || (endCol != -1 && field.column > endCol))
+        return true; // skipped by the user
+    if (field.text.isEmpty())
+        return true;
+    const QString& text = field.text;
+
+    const int col = field.column - startCol;
+    if (col >= widths.count()) {
+        const int oldCount = widths.count();
+        widths.resize(col + 1);
+        dataTypes.resize(col + 1);
+        for (int i = oldCount; i <= col; ++i) {
+            widths[i] = defaultWidth;
+            dataTypes[i] = dialog->dataType(i);
+        }
+    }
+
+    // ### FIXME: how to calculate the width of numbers (as they might not be in the right format)
+    const double len = fm.width(text);
+    if (len > widths[col])
+        widths[col] = len;
+
+    KCCell cell(sheet, col + 1, field.row - startRow + 1);
+    const KCValueConverter* const converter = sheet->map()->converter();
+
+    switch (dataTypes[col]) {
+    case KoCsvImportDialog::Generic:
+    default: {
+        if (field.parsed) {
+            // the same as KCCell::parseUserInput() does for numbers
+            cell.setUserInput(text);
+            cell.setValue(field.value);
+        } else
+            cell.parseUserInput(text);
+        break;
+    }
+    case KoCsvImportDialog::Text: {
+        KCValue value(text);
+        cell.setValue(value);
+        cell.setUserInput(converter->asString(value).asString());
+        break;
+    }
+    case KoCsvImportDialog::Date: {
+        KCValue value(text);
+        cell.setValue(converter->asDate(value));
+        cell.setUserInput(converter->asString(value).asString());
+        break;
+    }
+    case KoCsvImportDialog::Currency: {
+        KCValue value(text);
+        value.setFormat(KCValue::fmt_Money);
+        cell.setValue(value);
+        cell.setUserInput(converter->asString(value).asString());
+        break;
+    }
+    case KoCsvImportDialog::None: {
+        // just skip the content
+        break;
+    }
+    }
+    return true;
+}
+
+void FieldWriter::adjustColumnWidths()
+{
+    for (int i = 0; i < widths.count(); ++i) {
+        if (widths[i] > defaultWidth)
+            sheet->nonDefaultColumnFormat(i + 1)->setWidth(widths[i]);
+    }
+}
+
+/**
+ * Determines the columns, that contain plain numbers, from the fields in \p sample .
+ * Their fields get parsed in advance in parallel.
+ */
+QBitArray numericColumns(QByteArray& sample, const KoCsvImportDialog* dialog,
+                         const QString& negativeSign)
+{
+    QBuffer buffer(&sample);
+    buffer.open(QIODevice::ReadOnly);
+    CSVTokenizer tokenizer(&buffer, dialog->codec(), dialog->delimiter(),
+                           dialog->textQuote(), dialog->ignoreDuplicates());
+    QVector<int> fieldCounts;
+    QVector<int> numberCounts;
+    Field field;
+    while (tokenizer.readField(field.text, field.row, field.column)) {
+        if (field.column >= fieldCounts.count()) {
+            fieldCounts.resize(field.column + 1);
+            numberCounts.resize(field.column + 1);
+        }
+        ++fieldCounts[field.column];
+        KCValueParser::readPlainNumber(field.text.trimmed(), negativeSign,
+                                       dialog->decimalSymbol(), &field.parsed);
+        if (field.parsed)
+            ++numberCounts[field.column];
+    }
+
+    // Allow a few other fields, e.g. a header row.
+    QBitArray columns(fieldCounts.count());
+    for (int column = dialog->startCol(); column < fieldCounts.count(); ++column) {
+        if (dialog->dataType(column - dialog->startCol()) != KoCsvImportDialog::Generic)
+            continue;
+        columns.setBit(column, numberCounts[column] > 0 && numberCounts[column] >= 0.9 * fieldCounts[column]);
+    }
+    return columns;
+}
+}
+
 K_PLUGIN_FACTORY(CSVImportFactory, registerPlugin<CSVFilter>();)
 K_EXPORT_PLUGIN(CSVImportFactory("kofficefilters"))
 
@@ -97,99 +337,126 @@ KoFilter::ConversionStatus CSVFilter::convert(const QByteArray& from, const QByt
     //if (!config.isNull())
     //    csv_delimiter = config[0];
 
-    QByteArray inputFile(in.readAll());
-    in.close();
+    // Only the beginning of the file is shown in the dialog.
+    QByteArray preview;
+    for (int i = 0; i < g_previewLines && !in.atEnd(); ++i)
+        preview += in.readLine();
+    const bool completePreview = in.atEnd();
 
     KoCsvImportDialog* dialog = new KoCsvImportDialog(0);
-    dialog->setData(inputFile);
+    dialog->setData(preview);
     dialog->setDecimalSymbol(ksdoc->map()->calculationSettings()->locale()->decimalSymbol());
     dialog->setThousandsSeparator(ksdoc->map()->calculationSettings()->locale()->thousandsSeparator());
     if (!m_chain->manager()->getBatchMode() && !dialog->exec())
         return KoFilter::UserCancelled;
-    inputFile.resize(0);   // Release memory (input file content)
+
+    // The user can only choose the rows of the preview. Choosing the last one
+    // of an incomplete preview means importing up to the end of the file.
+    int endRow = dialog->endRow();
+    if (!completePreview && endRow != -1) {
+        QBuffer buffer(&preview);
+        buffer.open(QIODevice::ReadOnly);
+        CSVTokenizer tokenizer(&buffer, dialog->codec(), dialog->delimiter(),
+                               dialog->textQuote(), dialog->ignoreDuplicates());
+        QString text;
+        int row, column;
+        int previewRows = 0;
+        while (tokenizer.readField(text, row, column))
+            previewRows = row;
+        if (endRow >= previewRows)
+            endRow = -1;
+    }
 
     KCElapsedTime t("Filling data into document");
 
     KCSheet *sheet = ksdoc->map()->addNewSheet();
 
-    int numRows = dialog->rows();
-    int numCols = dialog->cols();
-
-    if (numRows == 0)
-        ++numRows;
-
     // Initialize the decimal symbol and thousands separator to use for parsing.
     const QString documentDecimalSymbol = ksdoc->map()->calculationSettings()->locale()->decimalSymbol();
     const QString documentThousandsSeparator = ksdoc->map()->calculationSettings()->locale()->thousandsSeparator();
     ksdoc->map()->calculationSettings()->locale()->setDecimalSymbol(dialog->decimalSymbol());
     ksdoc->map()->calculationSettings()->locale()->setThousandsSeparator(dialog->thousandsSeparator());
 
-    int step = 100 / numRows * numCols;
     int value = 0;
 
     emit sigProgress(value);
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    const double defaultWidth = ksdoc->map()->defaultColumnFormat()->width();
-    QVector<double> widths(numCols);
-    for (int i = 0; i < numCols; ++i)
-        widths[i] = defaultWidth;
+    FieldWriter writer(sheet, dialog, endRow);
+
+    // The file can be split at the line ends and the parts can be processed in
+    // parallel, if the line ends are always recognizable in the raw data and the
+    // state of the tokenizer does not carry over a line end. This is the case for
+    // ASCII compatible encodings, single character delimiters and no sole
+    // Carriage Returns as line ends.
+    const QString negativeSign = ksdoc->map()->calculationSettings()->locale()->negativeSign();
+    const bool parallel = dialog->codec() && dialog->codec()->fromUnicode("\n") == "\n"
+                          && dialog->delimiter().length() == 1
+                          && preview.count('\r') == preview.count("\r\n");
+    const QBitArray numeric = parallel ? numericColumns(preview, dialog, negativeSign) : QBitArray();
+    preview.clear();   // Release memory (preview content)
+
+    in.seek(0);
+    const qint64 fileSize = qMax(in.size(), qint64(1));
+    if (parallel) {
+        const ChunkTokenizer tokenizer(dialog, numeric, negativeSign);
+        // idealThreadCount() is -1, if the number of cores is unknown
+        const int chunkCount = qMax(1, QThread::idealThreadCount());
+        QByteArray rest;
+        int rowOffset = 0;
+        bool finished = false;
+        while (!finished && !(in.atEnd() && rest.isEmpty())) {
+            // read one chunk per thread; each one ends at a line end
+            QList<Chunk> chunks;
+            while (chunks.count() < chunkCount && !(in.atEnd() && rest.isEmpty())) {
+                Chunk chunk;
+                chunk.data = rest + in.read(g_chunkSize);
+                const int end = in.atEnd() ? chunk.data.length() : chunk.data.lastIndexOf('\n') + 1;
+                rest = chunk.data.mid(end);
+                chunk.data.truncate(end);
+                if (!chunk.data.isEmpty())
+                    chunks.append(chunk);
+            }
 
-    KCCell cell(sheet, 1, 1);
-    QFontMetrics fm(cell.style().font());
+            // split them into fields in parallel and store these in order
+            QtConcurrent::blockingMap(chunks, tokenizer);
+            for (int i = 0; i < chunks.count() && !finished; ++i) {
+                const QVector<Field>& fields = chunks[i].fields;
+                for (int j = 0; j < fields.count(); ++j) {
+                    Field field = fields[j];
+                    field.row += rowOffset;
+                    if (!writer.write(field)) {
+                        finished = true;
+                        break;
+                    }
+                }
+                rowOffset += chunks[i].rows;
+            }
 
-    for (int row = 0; row < numRows; ++row) {
-        for (int col = 0; col < numCols; ++col) {
-            value += step;
+            value = int(98 * in.pos() / fileSize);
             emit sigProgress(value);
-            const QString text(dialog->text(row, col));
-
-            // ### FIXME: how to calculate the width of numbers (as they might not be in the right format)
-            const double len = fm.width(text);
-            if (len > widths[col])
-                widths[col] = len;
-
-            cell = KCCell(sheet, col + 1, row + 1);
-
-            switch (dialog->dataType(col)) {
-            case KoCsvImportDialog::Generic:
-            default: {
-                cell.parseUserInput(text);
-                break;
-            }
-            case KoCsvImportDialog::Text: {
-                KCValue value(text);
-                cell.setValue(value);
-                cell.setUserInput(ksdoc->map()->converter()->asString(value).asString());
-                break;
-            }
-            case KoCsvImportDialog::Date: {
-                KCValue value(text);
-                cell.setValue(ksdoc->map()->converter()->asDate(value));
-                cell.setUserInput(ksdoc->map()->converter()->asString(value).asString());
-                break;
-            }
-            case KoCsvImportDialog::Currency: {
-                KCValue value(text);
-                value.setFormat(KCValue::fmt_Money);
-                cell.setValue(value);
-                cell.setUserInput(ksdoc->map()->converter()->asString(value).asString());
-                break;
-            }
-            case KoCsvImportDialog::None: {
-                // just skip the content
+        }
+    } else {
+        // Read the whole file again, but only one chunk at a time.
+        CSVTokenizer tokenizer(&in, dialog->codec(), dialog->delimiter(),
+                               dialog->textQuote(), dialog->ignoreDuplicates());
+        Field field;
+        field.parsed = false;
+        while (tokenizer.readField(field.text, field.row, field.column)) {
+            if (!writer.write(field))
                 break;
-            }
+            const int progress = int(98 * in.pos() / fileSize);
+            if (progress != value) {
+                value = progress;
+                emit sigProgress(value);
             }
         }
     }
+    in.close();
 
     emit sigProgress(98);
 
-    for (int i = 0; i < numCols; ++i) {
-        if (widths[i] > defaultWidth)
-            sheet->nonDefaultColumnFormat(i + 1)->setWidth(widths[i]);
-    }
+    writer.adjustColumnWidths();
 
     // Restore the document's decimal symbol and thousands separator.
     ksdoc->map()->calculationSettings()->locale()->setDecimalSymbol(documentDecimalSymbol);
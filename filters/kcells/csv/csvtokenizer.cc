@@ -0,0 +1,194 @@
+/* This file is part of the KDE project
+   Copyright (C) 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "csvtokenizer.h"
+
+#include <QIODevice>
+
+// the number of characters decoded at once
+static const int g_chunkSize = 64 * 1024;
+
+CSVTokenizer::CSVTokenizer(QIODevice* device, QTextCodec* codec, const QString& delimiter,
+                           QChar textQuote, bool ignoreDuplicates)
+        : m_stream(device)
+        , m_position(0)
+        , m_finished(false)
+        , m_delimiter(delimiter)
+        , m_textQuote(textQuote)
+        , m_ignoreDuplicates(ignoreDuplicates)
+        , m_state(Start)
+        , m_row(1)
+        , m_column(1)
+        , m_delimiterIndex(0)
+        , m_lastCharDelimiter(false)
+        , m_lastCharWasCr(false)
+        , m_hasResult(false)
+        , m_resultRow(0)
+        , m_resultColumn(0)
+{
+    m_stream.setCodec(codec);
+}
+
+bool CSVTokenizer::readField(QString& field, int& row, int& column)
+{
+    m_hasResult = false;
+    while (!m_hasResult) {
+        if (m_position == m_buffer.length()) {
+            if (m_finished)
+                return false;
+            m_buffer = m_stream.read(g_chunkSize);
+            m_position = 0;
+            if (m_buffer.isEmpty()) {
+                m_finished = true;
+                if (m_field.isEmpty())
+                    return false;
+                // the last line of the data had not any line end
+                setResult(m_field);
+                m_field.clear();
+                break;
+            }
+        }
+
+        QChar x = m_buffer[m_position++];
+
+        // ### TODO: we should perhaps skip all other control characters
+        if (x == '\r') {
+            // We have a Carriage Return, assume that its role is the one of a LineFeed
+            m_lastCharWasCr = true;
+            x = '\n'; // Replace by Line Feed
+        } else if (x == '\n' && m_lastCharWasCr) {
+            // The end of line was already handled by the Carriage Return, so do nothing for this character
+            m_lastCharWasCr = false;
+            continue;
+        } else if (x == QChar(0xc)) {
+            // We have a FormFeed, skip it
+            m_lastCharWasCr = false;
+            continue;
+        } else {
+            m_lastCharWasCr = false;
+        }
+
+        const bool isDelimiter = m_delimiterIndex < m_delimiter.length() && x == m_delimiter.at(m_delimiterIndex);
+        switch (m_state) {
+        case Start:
+            if (x == m_textQuote) {
+                m_state = InQuotedField;
+            } else if (isDelimiter) {
+                handleDelimiter(x, false);
+            } else if (x == '\n') {
+                ++m_row;
+                m_column = 1;
+            } else {
+                m_field += x;
+                m_state = MaybeInNormalField;
+            }
+            break;
+        case InQuotedField:
+            if (x == m_textQuote) {
+                m_state = MaybeQuotedFieldEnd;
+            } else if (x == '\n') {
+                setResult(m_field);
+                m_field.clear();
+                ++m_row;
+                m_column = 1;
+                m_state = Start;
+            } else {
+                m_field += x;
+            }
+            break;
+        case MaybeQuotedFieldEnd:
+            if (x == m_textQuote) {
+                m_field += x;
+                m_state = InQuotedField;
+                break;
+            }
+            // fall through
+        case QuotedFieldEnd:
+            if (x == '\n') {
+                setResult(m_field);
+                m_field.clear();
+                ++m_row;
+                m_column = 1;
+                m_state = Start;
+            } else if (isDelimiter) {
+                handleDelimiter(x, true);
+                m_state = Start;
+            } else {
+                m_state = QuotedFieldEnd;
+            }
+            break;
+        case MaybeInNormalField:
+            if (x == m_textQuote) {
+                m_field.clear();
+                m_state = InQuotedField;
+                break;
+            }
+            // fall through
+        case InNormalField:
+            if (x == '\n') {
+                setResult(m_field);
+                m_field.clear();
+                ++m_row;
+                m_column = 1;
+                m_state = Start;
+            } else if (isDelimiter) {
+                handleDelimiter(x, true);
+                m_state = Start;
+            } else {
+                m_field += x;
+            }
+        }
+        if (m_delimiter.isEmpty() || x != m_delimiter.at(0))
+            m_lastCharDelimiter = false;
+    }
+
+    field = m_result;
+    row = m_resultRow;
+    column = m_resultColumn;
+    return true;
+}
+
+int CSVTokenizer::currentRow() const
+{
+    return m_row;
+}
+
+void CSVTokenizer::setResult(const QString& text)
+{
+    m_result = text;
+    m_resultRow = m_row;
+    m_resultColumn = m_column;
+    m_hasResult = true;
+}
+
+void CSVTokenizer::handleDelimiter(QChar x, bool store)
+{
+    m_field += x;
+    m_delimiterIndex++;
+    if (m_delimiterIndex == m_delimiter.length() && m_field.endsWith(m_delimiter)) {
+        if (store)
+            setResult(m_field.left(m_field.length() - m_delimiterIndex));
+        if (!m_ignoreDuplicates || !m_lastCharDelimiter)
+            m_column += m_delimiter.length();
+        m_lastCharDelimiter = true;
+        m_field.clear();
+        m_delimiterIndex = 0;
+    } else if (m_delimiterIndex >= m_delimiter.length())
+        m_delimiterIndex = 0;
+}
@@ -0,0 +1,84 @@
+/* This file is part of the KDE project
+   Copyright (C) 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef CSVTOKENIZER_H
+#define CSVTOKENIZER_H
+
+#include <QString>
+#include <QTextStream>
+
+class QIODevice;
+class QTextCodec;
+
+/**
+ * Splits CSV data into fields while reading it in chunks.
+ *
+ * It uses the same state machine as the preview of KoCsvImportDialog
+ * (see DESIGN), so the imported fields end up where the preview shows them.
+ * Only the current chunk and field are kept in memory.
+ */
+class CSVTokenizer
+{
+public:
+    CSVTokenizer(QIODevice* device, QTextCodec* codec, const QString& delimiter,
+                 QChar textQuote, bool ignoreDuplicates);
+
+    /**
+     * Reads the next non-empty field.
+     * \param field the text of the field
+     * \param row the row of the field, 1 based
+     * \param column the column of the field, 1 based
+     * \return \c false at the end of the data
+     */
+    bool readField(QString& field, int& row, int& column);
+
+    /**
+     * \return the row of the next field, 1 based
+     */
+    int currentRow() const;
+
+private:
+    void setResult(const QString& text);
+    void handleDelimiter(QChar x, bool store);
+
+    QTextStream m_stream;
+    QString m_buffer;
+    int m_position;
+    bool m_finished;
+
+    QString m_delimiter;
+    QChar m_textQuote;
+    bool m_ignoreDuplicates;
+
+    enum { Start, InQuotedField, MaybeQuotedFieldEnd, QuotedFieldEnd,
+           MaybeInNormalField, InNormalField } m_state;
+    QString m_field;
+    int m_row;
+    int m_column;
+    int m_delimiterIndex;
+    bool m_lastCharDelimiter;
+    bool m_lastCharWasCr;
+
+    bool m_hasResult;
+    QString m_result;
+    int m_resultRow;
+    int m_resultColumn;
+};
+
+#endif // CSVTOKENIZER_H
@@ -26,6 +26,9 @@
 
 #include <QHash>
 #include <QList>
+#include <QPair>
+#include <QRect>
+#include <QStringList>
 
 #include "KCCell.h"
 #include "KCRegion.h"
@@ -120,6 +123,55 @@ public:
      */
     void computeDependencies(const KCCell& cell, const KCFormula& formula);
 
+    /**
+     * The references of a single formula.
+     */
+    struct Dependencies {
+        // the providing region
+        KCRegion region;
+        // the consumed cell ranges, one for each reference
+        QList< QPair<KCSheet*, QRect> > ranges;
+        // the referenced named areas
+        QStringList namedAreas;
+    };
+
+    /**
+     * Parses \p formula and collects its references to cells, cell ranges
+     * and named areas.
+     * Leaves the data structures untouched, so that the formulas of
+     * different sheets can be processed concurrently.
+     * \return \c false , if \p formula is broken and has no dependencies
+     * \see computeDependencies
+     */
+    static bool extractDependencies(const KCCell& cell, const KCFormula& formula,
+                                    Dependencies* dependencies);
+
+    /**
+     * The references of all formulas in a sheet.
+     */
+    struct SheetDependencies {
+        const KCSheet* sheet;
+        QList< QPair<KCCell, Dependencies> > cells;
+        // the cells with broken formulas, that have no dependencies
+        QList<KCCell> brokenCells;
+    };
+
+    /**
+     * Extracts the references of all formulas in \p job 's sheet.
+     * Runs in a worker thread.
+     */
+    static void extractSheetDependencies(SheetDependencies& job);
+
+    /**
+     * Computes the reference depths of all cells with formulas at once.
+     *
+     * Sorts the cells topologically without recursion, so that the depth of
+     * a cell is known, before its consumers are visited. The cells in
+     * circular dependencies are flagged and get a depth of zero.
+     * \see computeDepth
+     */
+    void generateAllDepths();
+
     enum Direction { Forward, Backward };
     /**
      * Removes the circular dependency flag from \p region and all their dependencies.
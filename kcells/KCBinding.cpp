@@ -25,10 +25,14 @@
 
 #include <kdebug.h>
 
+#include <limits>
+
 #include "KCCellStorage.h"
 #include "KCMap.h"
+#include "KCPointStorage.h"
 #include "KCSheet.h"
 #include "KCValue.h"
+#include "KCValueStorage.h"
 
 class KCBinding::Private : public QSharedData
 {
@@ -83,6 +87,7 @@ void KCBinding::setRegion(const KCRegion& region)
 void KCBinding::update(const KCRegion& region)
 {
     QRect rect;
+    QRect changedRect;
     KCRegion changedRegion;
     const QPoint offset = d->model->region().firstRange().topLeft();
     const QRect range = d->model->region().firstRange();
@@ -94,10 +99,14 @@ void KCBinding::update(const KCRegion& region)
         rect = range & (*it)->rect();
         rect.translate(-offset.x(), -offset.y());
         if (rect.isValid()) {
-            d->model->emitDataChanged(rect);
+            changedRect |= rect;
             changedRegion.add(rect, (*it)->sheet());
         }
     }
+    // A single notification; the views re-read the changed cells in one go.
+    if (changedRect.isValid()) {
+        d->model->emitDataChanged(changedRect);
+    }
     d->model->emitChanged(changedRegion);
 }
 
@@ -230,6 +239,57 @@ QVariant KCBindingModel::data(const QModelIndex& index, int role) const
     return variant;
 }
 
+QVector<KChart::ColumnSlice> KCBindingModel::columnSlices(const QRect& rect) const
+{
+    if (m_region.isEmpty())
+        return QVector<KChart::ColumnSlice>();
+    const QPoint offset = m_region.firstRange().topLeft();
+    const QRect range = rect.translated(offset) & m_region.firstRange();
+    if (!range.isValid())
+        return QVector<KChart::ColumnSlice>();
+    return readColumns(m_region.firstSheet(), range);
+}
+
+QVector<KChart::ColumnSlice> KCBindingModel::readColumns(const KCSheet* sheet, const QRect& range)
+{
+    QVector<KChart::ColumnSlice> slices(range.width());
+    for (int i = 0; i < slices.count(); ++i) {
+        slices[i].numbers.fill(std::numeric_limits<double>::quiet_NaN(), range.height());
+        slices[i].labels.resize(range.height());
+        slices[i].dateTimes.resize(range.height());
+    }
+    // Only the non-empty cells are visited; the others keep the defaults.
+    const QVector< QPair<QPoint, KCValue> > pairs = sheet->cellStorage()->valueStorage()->dataInRect(range);
+    for (int i = 0; i < pairs.count(); ++i) {
+        const KCValue& value = pairs[i].second;
+        KChart::ColumnSlice& slice = slices[pairs[i].first.x() - range.left()];
+        const int row = pairs[i].first.y() - range.top();
+        switch (value.type()) {
+        case KCValue::Float:
+        case KCValue::Integer:
+            if (value.format() == KCValue::fmt_DateTime ||
+                    value.format() == KCValue::fmt_Date ||
+                    value.format() == KCValue::fmt_Time) {
+                slice.dateTimes.setBit(row);
+            }
+        case KCValue::Boolean:
+        case KCValue::Complex:
+        case KCValue::Array:
+            slice.numbers[row] = numToDouble(value.asFloat());
+            break;
+        case KCValue::String:
+        case KCValue::Error:
+            slice.labels[row] = value.asString();
+            break;
+        case KCValue::Empty:
+        case KCValue::CellRange:
+        default:
+            break;
+        }
+    }
+    return slices;
+}
+
 const KCRegion& KCBindingModel::region() const
 {
     return m_region;
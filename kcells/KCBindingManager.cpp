@@ -26,6 +26,7 @@
 #include "KCSheet.h"
 
 #include <QAbstractItemModel>
+#include <QMap>
 
 class KCBindingManager::Private
 {
@@ -84,13 +85,21 @@ void KCBindingManager::regionChanged(const KCRegion& region)
 {
     KCSheet* sheet;
     QList< QPair<QRectF, KCBinding> > bindings;
+    // Collect the changes per binding first, so that each one notifies its
+    // model only once, even if many separate cells changed.
+    QMap<KCBinding, KCRegion> changedBindings;
     KCRegion::ConstIterator end(region.constEnd());
     for (KCRegion::ConstIterator it = region.constBegin(); it != end; ++it) {
         sheet = (*it)->sheet();
         const KCRegion changedRegion((*it)->rect(), sheet);
         bindings = sheet->cellStorage()->bindingStorage()->intersectingPairs(changedRegion);
         for (int j = 0; j < bindings.count(); ++j)
-            bindings[j].second.update(changedRegion);
+            changedBindings[bindings[j].second].add((*it)->rect(), sheet);
+    }
+    QMap<KCBinding, KCRegion>::ConstIterator bend(changedBindings.constEnd());
+    for (QMap<KCBinding, KCRegion>::ConstIterator it = changedBindings.constBegin(); it != bend; ++it) {
+        KCBinding binding = it.key();
+        binding.update(it.value());
     }
 }
 
@@ -28,14 +28,15 @@
 #include <QAbstractTableModel>
 
 class KCBinding;
+class KCSheet;
 
 /**
  * A model for a cell range acting as data source.
  */
-class KCBindingModel : public QAbstractTableModel, public KChart::ChartModel
+class KCBindingModel : public QAbstractTableModel, public KChart::ChartModel, public KChart::ChartBulkModel
 {
     Q_OBJECT
-    Q_INTERFACES(KChart::ChartModel)
+    Q_INTERFACES(KChart::ChartModel KChart::ChartBulkModel)
 public:
     explicit KCBindingModel(KCBinding* binding, QObject *parent = 0);
 
@@ -50,6 +51,15 @@ public:
     virtual bool setCellRegion(const QString& regionName);
     virtual bool isCellRegionValid(const QString& regionName) const;
 
+    // KChart::ChartBulkModel interface
+    virtual QVector<KChart::ColumnSlice> columnSlices(const QRect& rect) const;
+
+    /**
+     * Reads the values of the cells in \p range of \p sheet column by column.
+     * The values are converted like data() does.
+     */
+    static QVector<KChart::ColumnSlice> readColumns(const KCSheet* sheet, const QRect& range);
+
     const KCRegion& region() const;
     void setRegion(const KCRegion& region);
 
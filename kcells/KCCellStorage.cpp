@@ -22,6 +22,10 @@
 #include "KCCellStorage.h"
 #include "CellStorage_p.h"
 
+// Qt
+#include <QPointer>
+#include <QRegion>
+
 // KDE
 #include <klocale.h>
 
@@ -35,6 +39,7 @@
 #include "KCDependencyManager.h"
 #include "KCFormulaStorage.h"
 #include "KCMap.h"
+#include "KCNamedAreaManager.h"
 #include "ModelSupport.h"
 #include "KCRecalcManager.h"
 #include "KCRectStorage.h"
@@ -212,6 +217,444 @@ void KCCellStorage::Private::createCommand(QUndoCommand *parent) const
 }
 
 
+class KCCellBlock::Private : public QSharedData
+{
+public:
+    QPointer<KCSheet> sheet;
+    QRect rect;
+    // the cells, that get transferred; the ones KCCopyCommand would save
+    QRegion cells;
+    // the contents of the cells with a formula or a user input
+    QVector< QPair<QPoint, KCFormula> > formulas;
+    QVector< QPair<QPoint, QString> > links;
+    QVector< QPair<QPoint, QString> > userInputs;
+    QVector< QPair<QPoint, KCValue> > values;
+    // the rect data without the default values
+    QList< QPair<QRectF, QString> > comments;
+    QList< QPair<QRectF, KCConditions> > conditions;
+    QList< QPair<QRectF, KCSharedSubStyle> > styles;
+    QList< QPair<QRectF, KCValidity> > validities;
+};
+
+/**
+ * \return \c true , if \p point1 comes before \p point2 in row-major order
+ */
+static inline bool rowMajorLessThan(const QPoint& point1, const QPoint& point2)
+{
+    return point1.y() < point2.y() || (point1.y() == point2.y() && point1.x() < point2.x());
+}
+
+/**
+ * \return the positions of \p data
+ */
+template<typename T>
+static QVector<QPoint> positions(const QVector< QPair<QPoint, T> >& data)
+{
+    QVector<QPoint> result(data.count());
+    for (int i = 0; i < data.count(); ++i)
+        result[i] = data[i].first;
+    return result;
+}
+
+/**
+ * \return the positions, that are in \p positions1 or in \p positions2 ;
+ * all in row-major order
+ */
+static QVector<QPoint> unitedPositions(const QVector<QPoint>& positions1, const QVector<QPoint>& positions2)
+{
+    QVector<QPoint> result;
+    result.reserve(positions1.count() + positions2.count());
+    int i = 0;
+    int j = 0;
+    while (i < positions1.count() || j < positions2.count()) {
+        if (j == positions2.count() || (i < positions1.count() && rowMajorLessThan(positions1[i], positions2[j])))
+            result.append(positions1[i++]);
+        else if (i == positions1.count() || rowMajorLessThan(positions2[j], positions1[i]))
+            result.append(positions2[j++]);
+        else {
+            result.append(positions1[i++]);
+            ++j;
+        }
+    }
+    return result;
+}
+
+/**
+ * \return the items of \p data located at \p positions ; all in row-major order
+ */
+template<typename T>
+static QVector< QPair<QPoint, T> > dataAt(const QVector< QPair<QPoint, T> >& data,
+                                         const QVector<QPoint>& positions)
+{
+    QVector< QPair<QPoint, T> > result;
+    int j = 0;
+    for (int i = 0; i < data.count(); ++i) {
+        while (j < positions.count() && rowMajorLessThan(positions[j], data[i].first))
+            ++j;
+        if (j < positions.count() && positions[j] == data[i].first)
+            result.append(data[i]);
+    }
+    return result;
+}
+
+/**
+ * Replaces the items of \p oldData at \p positions by the ones of \p newData .
+ * Positions without a new item get cleared. All in row-major order.
+ */
+template<typename T>
+static QVector< QPair<QPoint, T> > replacedData(const QVector< QPair<QPoint, T> >& oldData,
+                                               const QVector<QPoint>& positions,
+                                               const QVector< QPair<QPoint, T> >& newData)
+{
+    QVector< QPair<QPoint, T> > result;
+    result.reserve(oldData.count() + newData.count());
+    int j = 0; // in positions
+    int k = 0; // in newData
+    for (int i = 0; i < oldData.count(); ++i) {
+        const QPoint position = oldData[i].first;
+        while (k < newData.count() && rowMajorLessThan(newData[k].first, position))
+            result.append(newData[k++]);
+        while (j < positions.count() && rowMajorLessThan(positions[j], position))
+            ++j;
+        if (j < positions.count() && positions[j] == position)
+            continue;
+        result.append(oldData[i]);
+    }
+    while (k < newData.count())
+        result.append(newData[k++]);
+    return result;
+}
+
+/**
+ * \return the region consisting of \p positions , which are in row-major order
+ */
+static QRegion pointRegion(const QVector<QPoint>& positions)
+{
+    // one rect for each run of adjacent cells in a row; these are y-x banded
+    QVector<QRect> rects;
+    for (int i = 0; i < positions.count(); ++i) {
+        const QPoint position = positions[i];
+        if (!rects.isEmpty() && rects.last().top() == position.y() && rects.last().right() + 1 == position.x())
+            rects.last().setRight(position.x());
+        else
+            rects.append(QRect(position, position));
+    }
+    QRegion region;
+    if (!rects.isEmpty())
+        region.setRects(rects.constData(), rects.count());
+    return region;
+}
+
+/**
+ * \return the region covered by the rects of \p pairs
+ */
+template<typename T>
+static QRegion coveredRegion(const QList< QPair<QRectF, T> >& pairs)
+{
+    QRegion region;
+    for (int i = 0; i < pairs.count(); ++i)
+        region += pairs[i].first.toRect();
+    return region;
+}
+
+/**
+ * \return the pairs, that do not carry the default value
+ */
+template<typename T>
+static QList< QPair<QRectF, T> > nonDefaultPairs(const QList< QPair<QRectF, T> >& pairs)
+{
+    QList< QPair<QRectF, T> > result;
+    for (int i = 0; i < pairs.count(); ++i) {
+        if (!(pairs[i].second == T()))
+            result.append(pairs[i]);
+    }
+    return result;
+}
+
+/**
+ * Passes the data unchanged to the destination cell.
+ */
+template<typename T>
+struct CopyData {
+    typedef T result_type;
+
+    T operator()(const T& data, const QPoint&, const QPoint&) const {
+        return data;
+    }
+};
+
+/**
+ * A formula, whose relative references can be moved, like
+ * KCCell::encodeFormula() and KCCell::decodeFormula() do for a copied cell.
+ * The expression gets tokenized and its references resolved only once;
+ * moving it just adds the offset to the references.
+ */
+class MovableFormula
+{
+public:
+    MovableFormula() {}
+
+    MovableFormula(const KCFormula& formula, const KCMap* map) {
+        QString text('=');
+        const Tokens tokens = formula.tokens();
+        for (int i = 0; i < tokens.count(); ++i) {
+            const KCToken token = tokens[i];
+            if (token.type() != KCToken::KCCell && token.type() != KCToken::Range) {
+                text.append(token.text());
+                continue;
+            }
+            if (map->namedAreaManager()->contains(token.text())) {
+                text.append(token.text()); // simply keep the area name
+                continue;
+            }
+            const KCRegion region(token.text(), map);
+            KCRegion::ConstIterator end = region.constEnd();
+            for (KCRegion::ConstIterator it = region.constBegin(); it != end; ++it) {
+                if (!(*it)->isValid())
+                    continue;
+                if ((*it)->sheet())
+                    text.append((*it)->sheet()->sheetName() + '!');
+                Reference reference;
+                reference.rect = (*it)->rect();
+                reference.isPoint = (*it)->type() == KCRegion::Element::Point;
+                if (reference.isPoint) {
+                    reference.leftFixed = reference.rightFixed = (*it)->isColumnFixed();
+                    reference.topFixed = reference.bottomFixed = (*it)->isRowFixed();
+                } else {
+                    reference.leftFixed = (*it)->isLeftFixed();
+                    reference.topFixed = (*it)->isTopFixed();
+                    reference.rightFixed = (*it)->isRightFixed();
+                    reference.bottomFixed = (*it)->isBottomFixed();
+                }
+                m_texts.append(text);
+                m_references.append(reference);
+                text.clear();
+            }
+        }
+        m_texts.append(text);
+    }
+
+    /**
+     * \return the expression with the relative references moved by \p offset
+     */
+    QString expression(const QPoint& offset) const {
+        if (m_texts.isEmpty())
+            return QString();
+        QString expression;
+        for (int i = 0; i < m_references.count(); ++i) {
+            const Reference& reference = m_references[i];
+            expression.append(m_texts[i]);
+            append(expression, reference.rect.topLeft(), offset, reference.leftFixed, reference.topFixed);
+            if (!reference.isPoint) {
+                expression.append(':');
+                append(expression, reference.rect.bottomRight(), offset, reference.rightFixed, reference.bottomFixed);
+            }
+        }
+        expression.append(m_texts.last());
+        return expression;
+    }
+
+private:
+    static void append(QString& expression, const QPoint& reference, const QPoint& offset,
+                       bool columnFixed, bool rowFixed) {
+        const int col = columnFixed ? reference.x() : reference.x() + offset.x();
+        const int row = rowFixed ? reference.y() : reference.y() + offset.y();
+        if (row < 1 || col < 1 || row > KS_rowMax || col > KS_colMax) {
+            expression.append(KCValue::errorREF().errorMessage());
+            return;
+        }
+        if (columnFixed)
+            expression.append('$');
+        expression.append(KCCell::columnName(col));
+        if (rowFixed)
+            expression.append('$');
+        expression.append(QString::number(row));
+    }
+
+    struct Reference {
+        QRect rect;
+        bool isPoint;
+        bool leftFixed;
+        bool topFixed;
+        bool rightFixed;
+        bool bottomFixed;
+    };
+    // the texts before each reference and the one after the last reference
+    QStringList m_texts;
+    QVector<Reference> m_references;
+};
+
+/**
+ * Creates the formula of a destination cell out of a prepared source formula.
+ */
+class TranslateFormula
+{
+public:
+    typedef KCFormula result_type;
+
+    explicit TranslateFormula(KCSheet* sheet) : m_sheet(sheet) {}
+
+    KCFormula operator()(const MovableFormula& formula, const QPoint& position, const QPoint& offset) const {
+        KCFormula result(m_sheet, KCCell(m_sheet, position));
+        result.setExpression(formula.expression(offset));
+        return result;
+    }
+
+private:
+    KCSheet *const m_sheet;
+};
+
+/**
+ * Repeats the point data of \p source over \p destination .
+ * \param data the data in \p source in row-major order
+ * \param copy creates the data of the destination cell
+ * \return the data for \p destination in row-major order
+ */
+template<typename T, typename Copy>
+static QVector< QPair<QPoint, typename Copy::result_type> > tiledData(const QVector< QPair<QPoint, T> >& data,
+                                                                     const QRect& source, const QRect& destination,
+                                                                     const Copy& copy)
+{
+    QVector< QPair<QPoint, typename Copy::result_type> > result;
+    if (data.isEmpty())
+        return result;
+    // the index of the first item of each source row in data
+    QVector<int> rowBegins(source.height() + 1, data.count());
+    for (int i = data.count() - 1; i >= 0; --i)
+        rowBegins[data[i].first.y() - source.top()] = i;
+    for (int i = source.height() - 1; i >= 0; --i)
+        rowBegins[i] = qMin(rowBegins[i], rowBegins[i + 1]);
+
+    for (int row = destination.top(); row <= destination.bottom(); ++row) {
+        const int sourceRow = (row - destination.top()) % source.height();
+        const int dy = row - source.top() - sourceRow;
+        for (int x = destination.left(); x <= destination.right(); x += source.width()) {
+            const QPoint offset(x - source.left(), dy);
+            for (int i = rowBegins[sourceRow]; i < rowBegins[sourceRow + 1]; ++i) {
+                const QPoint position = data[i].first + offset;
+                if (position.x() > destination.right())
+                    break;
+                result.append(qMakePair(position, copy(data[i].second, position, offset)));
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Repeats the rect data of \p source over \p destination , but only within
+ * \p cells , which has to be inside \p destination .
+ * Rects spanning the whole width or height of \p source get stretched over
+ * the whole width or height of \p destination instead of being repeated.
+ * The order of \p pairs is kept.
+ */
+template<typename T>
+static QList< QPair<QRect, T> > tiledRects(const QList< QPair<QRectF, T> >& pairs,
+                                          const QRect& source, const QRect& destination,
+                                          const QRegion& cells)
+{
+    QList< QPair<QRect, T> > result;
+    for (int i = 0; i < pairs.count(); ++i) {
+        const QRect rect = pairs[i].first.toRect() & source;
+        if (rect.isEmpty())
+            continue;
+        const bool wholeWidth = rect.left() == source.left() && rect.right() == source.right();
+        const bool wholeHeight = rect.top() == source.top() && rect.bottom() == source.bottom();
+        for (int y = destination.top(); y <= destination.bottom(); y += source.height()) {
+            for (int x = destination.left(); x <= destination.right(); x += source.width()) {
+                QRect tile = rect.translated(x - source.left(), y - source.top());
+                if (wholeWidth) {
+                    tile.setLeft(destination.left());
+                    tile.setRight(destination.right());
+                }
+                if (wholeHeight) {
+                    tile.setTop(destination.top());
+                    tile.setBottom(destination.bottom());
+                }
+                foreach (const QRect& rect, (cells & tile).rects())
+                    result.append(qMakePair(rect, pairs[i].second));
+                if (wholeWidth)
+                    break;
+            }
+            if (wholeHeight)
+                break;
+        }
+    }
+    return result;
+}
+
+/**
+ * \return the undo data for replacing \p oldData by \p newData : the old data
+ * and default data for the positions, that were empty before
+ */
+template<typename T>
+static QVector< QPair<QPoint, T> > undoPairs(const QVector< QPair<QPoint, T> >& oldData,
+                                            const QVector< QPair<QPoint, T> >& newData)
+{
+    QVector< QPair<QPoint, T> > result = oldData;
+    int i = 0;
+    for (int j = 0; j < newData.count(); ++j) {
+        const QPoint position = newData[j].first;
+        // both are in row-major order
+        while (i < oldData.count() && (oldData[i].first.y() < position.y() ||
+                                       (oldData[i].first.y() == position.y() && oldData[i].first.x() < position.x())))
+            ++i;
+        if (i == oldData.count() || oldData[i].first != position)
+            result.append(qMakePair(position, T()));
+    }
+    return result;
+}
+
+
+/**
+ * Repeats \p region of \p source over \p destination .
+ */
+static QRegion tiledRegion(const QRegion& region, const QRect& source, const QRect& destination)
+{
+    // Processing the bands of each row of tiles one after the other keeps
+    // the tiled rects y-x banded.
+    const QVector<QRect> rects = region.rects();
+    QVector<QRect> tiles;
+    for (int y = destination.top(); y <= destination.bottom(); y += source.height()) {
+        for (int begin = 0, end = 0; begin < rects.count(); begin = end) {
+            while (end < rects.count() && rects[end].top() == rects[begin].top())
+                ++end;
+            for (int x = destination.left(); x <= destination.right(); x += source.width()) {
+                for (int i = begin; i < end; ++i) {
+                    const QRect tile = rects[i].translated(x - source.left(), y - source.top()) & destination;
+                    if (tile.isEmpty())
+                        continue;
+                    // join the rects of adjacent tiles
+                    if (!tiles.isEmpty() && tiles.last().top() == tile.top() &&
+                            tiles.last().bottom() == tile.bottom() && tiles.last().right() + 1 == tile.left())
+                        tiles.last().setRight(tile.right());
+                    else
+                        tiles.append(tile);
+                }
+            }
+        }
+    }
+    QRegion result;
+    if (!tiles.isEmpty())
+        result.setRects(tiles.constData(), tiles.count());
+    return result;
+}
+
+/**
+ * Replaces the data of \p storage at \p positions , which are inside \p rect ,
+ * by \p data . The data at other positions in \p rect is kept.
+ * \return the undo data
+ */
+template<typename T>
+static QVector< QPair<QPoint, T> > replaceData(KCPointStorage<T>* storage, const QRect& rect,
+                                              const QVector<QPoint>& positions,
+                                              const QVector< QPair<QPoint, T> >& data)
+{
+    const QVector< QPair<QPoint, T> > oldData = storage->dataInRect(rect);
+    storage->setDataInRect(rect, replacedData(oldData, positions, data));
+    return undoPairs(dataAt(oldData, positions), data);
+}
+
 KCCellStorage::KCCellStorage(KCSheet* sheet)
         : QObject(sheet)
         , d(new Private(sheet))
@@ -1405,6 +1848,165 @@ KCCellStorage KCCellStorage::subStorage(const KCRegion& region) const
     return subStorage;
 }
 
+KCCellBlock KCCellStorage::block(const QRect& rect) const
+{
+    KCCellBlock block;
+    const KCRegion region(rect, d->sheet);
+    // Merged cells and matrices would get split up by the repetition.
+    typedef QPair<QRectF, bool> RectBoolPair;
+    foreach (const RectBoolPair& pair, d->fusionStorage->intersectingPairs(region)) {
+        if (pair.second)
+            return block;
+    }
+    foreach (const RectBoolPair& pair, d->matrixStorage->intersectingPairs(region)) {
+        if (pair.second)
+            return block;
+    }
+    KCCellBlock::Private *const data = block.d.data();
+    data->sheet = d->sheet;
+    data->rect = rect;
+    // Like KCCell::save(), take the contents of the cells with a formula or a
+    // user input only and drop the rich text, that pasting the text clears.
+    data->formulas = d->formulaStorage->dataInRect(rect);
+    data->userInputs = d->userInputStorage->dataInRect(rect);
+    const QVector<QPoint> contents = unitedPositions(positions(data->formulas), positions(data->userInputs));
+    const QVector< QPair<QPoint, KCValue> > values = d->valueStorage->dataInRect(rect);
+    data->values = dataAt(values, contents);
+    data->links = dataAt(d->linkStorage->dataInRect(rect), positions(data->userInputs));
+    data->comments = nonDefaultPairs(d->commentStorage->undoData(region));
+    data->conditions = nonDefaultPairs(d->conditionsStorage->undoData(region));
+    // skip the default style for the whole rect
+    data->styles = d->styleStorage->undoData(region).mid(1);
+    data->validities = nonDefaultPairs(d->validityStorage->undoData(region));
+    // The cells KCCopyCommand::saveAsXml() visits and does not skip as empty.
+    const QRegion annotated = coveredRegion(data->comments) + coveredRegion(data->conditions)
+                              + coveredRegion(data->validities);
+    data->cells = (coveredRegion(data->styles) + pointRegion(contents)
+                   + (pointRegion(positions(values)) & annotated)) & rect;
+    return block;
+}
+
+void KCCellStorage::pasteBlock(const KCCellBlock& block, const QRect& destination, Visiting visiting)
+{
+    if (block.isNull() || destination.isEmpty())
+        return;
+    const KCCellBlock::Private *const data = block.d.constData();
+    const QRect source = data->rect;
+    const KCRegion region(destination, d->sheet);
+    // Like pasting the cells one by one, only the cells of the block get
+    // written and of those only the ones with contents lose their old contents.
+    const QRegion cells = tiledRegion(data->cells, source, destination);
+    const QVector< QPair<QPoint, QString> > userInputs
+    = tiledData(data->userInputs, source, destination, CopyData<QString>());
+    const QVector<QPoint> contents
+    = unitedPositions(positions(tiledData(data->formulas, source, destination, CopyData<KCFormula>())),
+                      positions(userInputs));
+
+    if (visiting & Values) {
+        // release the matrices, whose master cells get overridden
+        typedef QPair<QRectF, bool> RectBoolPair;
+        foreach (const RectBoolPair& pair, d->matrixStorage->intersectingPairs(region)) {
+            const QPoint master = pair.first.toRect().topLeft();
+            if (pair.second && qBinaryFind(contents.begin(), contents.end(), master, rowMajorLessThan) != contents.end())
+                unlockCells(master.x(), master.y());
+        }
+
+        const QVector< QPair<QPoint, KCValue> > values
+        = tiledData(data->values, source, destination, CopyData<KCValue>());
+        const QVector< QPair<QPoint, KCValue> > undoValues
+        = replaceData(d->valueStorage, destination, contents, values);
+        const QVector< QPair<QPoint, QString> > undoUserInputs
+        = replaceData(d->userInputStorage, destination, contents, userInputs);
+        const QVector< QPair<QPoint, QSharedPointer<QTextDocument> > > undoRichTexts
+        = replaceData(d->richTextStorage, destination, contents,
+                      QVector< QPair<QPoint, QSharedPointer<QTextDocument> > >());
+        // recording undo?
+        if (d->undoData) {
+            d->undoData->values     << undoValues;
+            d->undoData->userInputs << undoUserInputs;
+            d->undoData->richTexts  << undoRichTexts;
+        }
+    }
+    if (visiting & Formulas) {
+        // Prepare each source formula once for all of its destinations.
+        const KCMap *const map = d->sheet->map();
+        QVector< QPair<QPoint, MovableFormula> > movableFormulas(data->formulas.count());
+        for (int i = 0; i < data->formulas.count(); ++i)
+            movableFormulas[i] = qMakePair(data->formulas[i].first, MovableFormula(data->formulas[i].second, map));
+        const QVector< QPair<QPoint, KCFormula> > formulas
+        = tiledData(movableFormulas, source, destination, TranslateFormula(d->sheet));
+        const QVector< QPair<QPoint, KCFormula> > undoFormulas
+        = replaceData(d->formulaStorage, destination, contents, formulas);
+        // recording undo?
+        if (d->undoData)
+            d->undoData->formulas << undoFormulas;
+    }
+    if (visiting & Links) {
+        const QVector< QPair<QPoint, QString> > links
+        = tiledData(data->links, source, destination, CopyData<QString>());
+        const QVector< QPair<QPoint, QString> > undoLinks
+        = replaceData(d->linkStorage, destination, positions(links), links);
+        // recording undo?
+        if (d->undoData)
+            d->undoData->links << undoLinks;
+    }
+    if (visiting & Comments) {
+        // recording undo?
+        if (d->undoData)
+            d->undoData->comments << d->commentStorage->undoData(region);
+        typedef QPair<QRect, QString> RectStringPair;
+        foreach (const RectStringPair& pair, tiledRects(data->comments, source, destination, cells))
+            d->commentStorage->insert(KCRegion(pair.first, d->sheet), pair.second);
+    }
+    if (visiting & Styles) {
+        // recording undo?
+        if (d->undoData)
+            d->undoData->styles << d->styleStorage->undoData(region);
+        typedef QPair<QRect, KCSharedSubStyle> RectStylePair;
+        foreach (const RectStylePair& pair, tiledRects(data->styles, source, destination, cells))
+            d->styleStorage->insert(pair.first, pair.second);
+    }
+    // The pasted cells lose their old conditions and validities.
+    if (visiting & ConditionStyles) {
+        // recording undo?
+        if (d->undoData)
+            d->undoData->conditions << d->conditionsStorage->undoData(region);
+        foreach (const QRect& rect, cells.rects())
+            d->conditionsStorage->insert(KCRegion(rect, d->sheet), KCConditions());
+        typedef QPair<QRect, KCConditions> RectConditionsPair;
+        foreach (const RectConditionsPair& pair, tiledRects(data->conditions, source, destination, cells))
+            d->conditionsStorage->insert(KCRegion(pair.first, d->sheet), pair.second);
+    }
+    if (visiting & Validities) {
+        // recording undo?
+        if (d->undoData)
+            d->undoData->validities << d->validityStorage->undoData(region);
+        foreach (const QRect& rect, cells.rects())
+            d->validityStorage->insert(KCRegion(rect, d->sheet), KCValidity());
+        typedef QPair<QRect, KCValidity> RectValidityPair;
+        foreach (const RectValidityPair& pair, tiledRects(data->validities, source, destination, cells))
+            d->validityStorage->insert(KCRegion(pair.first, d->sheet), pair.second);
+    }
+
+    if (d->sheet->map()->isLoading())
+        return;
+    // One damage for the whole destination instead of one per cell.
+    KCCellDamage::Changes changes = KCCellDamage::Appearance | KCCellDamage::KCBinding;
+    if (visiting & Formulas)
+        changes |= KCCellDamage::KCFormula | KCCellDamage::KCValue;
+    else if (!d->sheet->map()->recalcManager()->isActive())
+        changes |= KCCellDamage::KCValue;
+    d->sheet->map()->addDamage(new KCCellDamage(d->sheet, region, changes));
+    for (int row = destination.top(); row <= destination.bottom(); ++row) {
+        // Also trigger a relayouting of the first non-empty cell to the left
+        int prevCol;
+        const KCValue value = d->valueStorage->prevInRow(destination.left(), row, &prevCol);
+        if (!value.isEmpty())
+            d->sheet->map()->addDamage(new KCCellDamage(KCCell(d->sheet, prevCol, row), KCCellDamage::Appearance));
+        d->rowRepeatStorage->setRowRepeat(row, 1);
+    }
+}
+
 const KCBindingStorage* KCCellStorage::bindingStorage() const
 {
     return d->bindingStorage;
@@ -1503,3 +2105,38 @@ void KCCellStorage::setRowsRepeated(int row, int count)
 }
 
 #include "KCCellStorage.moc"
+
+KCCellBlock::KCCellBlock()
+        : d(new Private)
+{
+}
+
+KCCellBlock::KCCellBlock(const KCCellBlock& other)
+        : d(other.d)
+{
+}
+
+KCCellBlock::~KCCellBlock()
+{
+}
+
+KCCellBlock& KCCellBlock::operator=(const KCCellBlock& other)
+{
+    d = other.d;
+    return *this;
+}
+
+bool KCCellBlock::isNull() const
+{
+    return d->sheet.isNull();
+}
+
+KCSheet* KCCellBlock::sheet() const
+{
+    return d->sheet;
+}
+
+QRect KCCellBlock::rect() const
+{
+    return d->rect;
+}
@@ -20,8 +20,10 @@
 #ifndef KC_CELL_STORAGE
 #define KC_CELL_STORAGE
 
+#include <QMetaType>
 #include <QPair>
 #include <QRect>
+#include <QSharedDataPointer>
 #include <QTextDocument>
 
 #include "KCCell.h"
@@ -37,6 +39,7 @@ class QUndoCommand;
 class KCBinding;
 class KCBindingStorage;
 class KCCell;
+class KCCellBlock;
 class CommentStorage;
 class KCConditions;
 class KCConditionsStorage;
@@ -369,6 +372,31 @@ public:
      */
     KCCellStorage subStorage(const KCRegion& region) const;
 
+    /**
+     * Takes the cell data in \p rect for transferring it with pasteBlock().
+     * Like copying the cells as XML, only the cells with contents, a style
+     * or a non-empty value with a comment, conditions or a validity are taken.
+     * \return the cell data or a null block, if \p rect contains merged
+     * cells or cells locked by a matrix
+     */
+    KCCellBlock block(const QRect& rect) const;
+
+    /**
+     * Pastes the cell data of \p block into \p destination with the same
+     * result as pasting the cells of the block one by one: only the cells
+     * taken by block() get written, of those only the ones with contents
+     * lose their old contents and styles get merged into the existing ones.
+     * The block is repeated, if \p destination is larger. The relative
+     * references of the formulas get moved like the ones of copied cells.
+     *
+     * Unlike setting the data cell by cell, each sub-storage is filled in
+     * a single pass, each formula gets parsed once and only one damage is
+     * emitted for \p destination .
+     *
+     * \param visiting the kinds of data to transfer
+     */
+    void pasteBlock(const KCCellBlock& block, const QRect& destination, Visiting visiting = VisitAll);
+
     const KCBindingStorage* bindingStorage() const;
     const CommentStorage* commentStorage() const;
     const KCConditionsStorage* conditionsStorage() const;
@@ -412,6 +440,53 @@ private:
     Private * const d;
 };
 
+/**
+ * \ingroup Storage
+ * The cell data of a rectangular block, taken from a KCCellStorage.
+ * Transfers the data to other cells without the detour over the single
+ * cells, e.g. on pasting or auto-filling. Implicitly shared.
+ *
+ * \see KCCellStorage::block()
+ * \see KCCellStorage::pasteBlock()
+ */
+class KCELLS_EXPORT KCCellBlock
+{
+public:
+    /**
+     * Constructor.
+     * Creates a null block.
+     */
+    KCCellBlock();
+
+    KCCellBlock(const KCCellBlock& other);
+    ~KCCellBlock();
+
+    KCCellBlock& operator=(const KCCellBlock& other);
+
+    /**
+     * \return \c true , if the block holds no data, e.g. because it was not
+     * taken from a storage or its sheet got removed meanwhile
+     */
+    bool isNull() const;
+
+    /**
+     * \return the sheet the data was taken from
+     */
+    KCSheet* sheet() const;
+
+    /**
+     * \return the cell range the data was taken from
+     */
+    QRect rect() const;
+
+private:
+    friend class KCCellStorage;
+    class Private;
+    QSharedDataPointer<Private> d;
+};
+
+Q_DECLARE_METATYPE(KCCellBlock)
+
 class UserInputStorage : public KCPointStorage<QString>
 {
 public:
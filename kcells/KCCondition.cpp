@@ -37,6 +37,11 @@
 #include "KCValueConverter.h"
 #include "KCValueParser.h"
 
+#include <QHash>
+#include <QPair>
+#include <QRect>
+#include <QStringList>
+
 #include <KOdfGenericStyles.h>
 
 #include <KXmlWriter.h>
@@ -74,11 +79,137 @@ bool KCConditional::operator==(const KCConditional &other) const
 //
 /////////////////////////////////////////////////////////////////////////////
 
+/**
+ * A formula of a conditional style, prepared for evaluating it for many cells.
+ * The formula is split at its references once. For each cell only the references,
+ * moved relative to the base cell, are put back in.
+ */
+class ConditionalFormula
+{
+public:
+    struct Reference {
+        bool isPoint;
+        QRect rect; // absolute for the fixed sides, relative to the base cell for the others
+        bool topFixed, bottomFixed, leftFixed, rightFixed;
+    };
+
+    ConditionalFormula() : sheet(0), damageCount(-1), relative(false) {}
+
+    void prepare(KCSheet *sheet, const QString &formula, const QString &baseCellAddress);
+    QString expression(const KCCell &cell) const;
+
+    KCSheet *sheet;
+    int damageCount; // KCMap::damageCount() when prepared
+    bool relative;
+    QStringList texts; // the text before each reference and after the last one
+    QList<Reference> references;
+    QHash<KCCell, bool> results;
+};
+
+void ConditionalFormula::prepare(KCSheet *sheet, const QString &formula, const QString &baseCellAddress)
+{
+    KCMap* const map = sheet->map();
+    this->sheet = sheet;
+    damageCount = map->damageCount();
+    texts.clear();
+    references.clear();
+    results.clear();
+
+    KCFormula f(sheet);
+    f.setExpression('=' + formula);
+    KCRegion r(baseCellAddress, map, sheet);
+    relative = r.isValid() && r.isSingular();
+    if (!relative) {
+        texts.append('=' + formula);
+        return;
+    }
+    QPoint basePoint = static_cast<KCRegion::Point*>(*r.constBegin())->pos();
+    QString text('=');
+    const Tokens tokens = f.tokens();
+    for (int t = 0; t < tokens.count(); ++t) {
+        const KCToken token = tokens[t];
+        if (token.type() != KCToken::KCCell && token.type() != KCToken::Range) {
+            text.append(token.text());
+            continue;
+        }
+        if (map->namedAreaManager()->contains(token.text())) {
+            text.append(token.text());
+            continue;
+        }
+        const KCRegion region(token.text(), map, sheet);
+        if (!region.isValid() || !region.isContiguous()) {
+            text.append(token.text());
+            continue;
+        }
+        if (region.firstSheet() != r.firstSheet()) {
+            text.append(token.text());
+            continue;
+        }
+        Reference reference;
+        KCRegion::Element* element = *region.constBegin();
+        if (element->type() == KCRegion::Element::Point) {
+            KCRegion::Point* point = static_cast<KCRegion::Point*>(element);
+            reference.isPoint = true;
+            reference.rect = QRect(point->pos(), point->pos());
+            reference.topFixed = reference.bottomFixed = point->isRowFixed();
+            reference.leftFixed = reference.rightFixed = point->isColumnFixed();
+        } else {
+            KCRegion::Range* range = static_cast<KCRegion::Range*>(element);
+            reference.isPoint = false;
+            reference.rect = range->rect();
+            reference.topFixed = range->isTopFixed();
+            reference.bottomFixed = range->isBottomFixed();
+            reference.leftFixed = range->isLeftFixed();
+            reference.rightFixed = range->isRightFixed();
+        }
+        if (!reference.topFixed)
+            reference.rect.setTop(reference.rect.top() - basePoint.y());
+        if (!reference.bottomFixed)
+            reference.rect.setBottom(reference.rect.bottom() - basePoint.y());
+        if (!reference.leftFixed)
+            reference.rect.setLeft(reference.rect.left() - basePoint.x());
+        if (!reference.rightFixed)
+            reference.rect.setRight(reference.rect.right() - basePoint.x());
+        texts.append(text);
+        references.append(reference);
+        text.clear();
+    }
+    texts.append(text);
+}
+
+QString ConditionalFormula::expression(const KCCell &cell) const
+{
+    if (!relative)
+        return texts.first();
+    QString expression;
+    for (int i = 0; i < references.count(); ++i) {
+        const Reference &reference = references[i];
+        QRect rect = reference.rect;
+        if (!reference.topFixed)
+            rect.setTop(cell.row() + rect.top());
+        if (!reference.bottomFixed)
+            rect.setBottom(cell.row() + rect.bottom());
+        if (!reference.leftFixed)
+            rect.setLeft(cell.column() + rect.left());
+        if (!reference.rightFixed)
+            rect.setRight(cell.column() + rect.right());
+        expression.append(texts[i]);
+        if (reference.isPoint)
+            expression.append(KCRegion(rect.topLeft(), cell.sheet()).name());
+        else
+            expression.append(KCRegion(rect, cell.sheet()).name());
+    }
+    expression.append(texts.last());
+    return expression;
+}
+
 class KCConditions::Private : public QSharedData
 {
 public:
     QLinkedList<KCConditional> conditionList;
     KCStyle defaultStyle;
+    // the prepared formulas and their results, by formula and base cell address
+    mutable QHash<QPair<QString, QString>, ConditionalFormula> formulas;
 };
 
 KCConditions::KCConditions()
@@ -180,7 +311,6 @@ bool KCConditions::currentCondition(const KCCell& cell, KCConditional & conditio
             }
             break;
         case KCConditional::IsTrueFormula:
-            // TODO: do some caching
             if (isTrueFormula(cell, condition.value1.asString(), condition.baseCellAddress)) {
                 return true;
             }
@@ -196,71 +326,23 @@ bool KCConditions::isTrueFormula(const KCCell &cell, const QString &formula, con
 {
     KCMap* const map = cell.sheet()->map();
     KCValueCalc *const calc = map->calc();
-    KCFormula f(cell.sheet(), cell);
-    f.setExpression('=' + formula);
-    KCRegion r(baseCellAddress, map, cell.sheet());
-    if (r.isValid() && r.isSingular()) {
-        QPoint basePoint = static_cast<KCRegion::Point*>(*r.constBegin())->pos();
-        QString newFormula('=');
-        const Tokens tokens = f.tokens();
-        for (int t = 0; t < tokens.count(); ++t) {
-            const KCToken token = tokens[t];
-            if (token.type() == KCToken::KCCell || token.type() == KCToken::Range) {
-                if (map->namedAreaManager()->contains(token.text())) {
-                    newFormula.append(token.text());
-                    continue;
-                }
-                const KCRegion region(token.text(), map, cell.sheet());
-                if (!region.isValid() || !region.isContiguous()) {
-                    newFormula.append(token.text());
-                    continue;
-                }
-                if (region.firstSheet() != r.firstSheet()) {
-                    newFormula.append(token.text());
-                    continue;
-                }
-                KCRegion::Element* element = *region.constBegin();
-                if (element->type() == KCRegion::Element::Point) {
-                    KCRegion::Point* point = static_cast<KCRegion::Point*>(element);
-                    QPoint pos = point->pos();
-                    if (!point->isRowFixed()) {
-                        int delta = pos.y() - basePoint.y();
-                        pos.setY(cell.row() + delta);
-                    }
-                    if (!point->isColumnFixed()) {
-                        int delta = pos.x() - basePoint.x();
-                        pos.setX(cell.column() + delta);
-                    }
-                    newFormula.append(KCRegion(pos, cell.sheet()).name());
-                } else {
-                    KCRegion::Range* range = static_cast<KCRegion::Range*>(element);
-                    QRect r = range->rect();
-                    if (!range->isTopFixed()) {
-                        int delta = r.top() - basePoint.y();
-                        r.setTop(cell.row() + delta);
-                    }
-                    if (!range->isBottomFixed()) {
-                        int delta = r.bottom() - basePoint.y();
-                        r.setBottom(cell.row() + delta);
-                    }
-                    if (!range->isLeftFixed()) {
-                        int delta = r.left() - basePoint.x();
-                        r.setLeft(cell.column() + delta);
-                    }
-                    if (!range->isRightFixed()) {
-                        int delta = r.right() - basePoint.x();
-                        r.setRight(cell.column() + delta);
-                    }
-                    newFormula.append(KCRegion(r, cell.sheet()).name());
-                }
-            } else {
-                newFormula.append(token.text());
-            }
-        }
-        f.setExpression(newFormula);
+    ConditionalFormula &prepared = d->formulas[qMakePair(formula, baseCellAddress)];
+    // any change in the document may change the result or the meaning of the references
+    if (prepared.sheet != cell.sheet() || prepared.damageCount != map->damageCount())
+        prepared.prepare(cell.sheet(), formula, baseCellAddress);
+    const bool useCache = !map->isLoading();
+    if (useCache) {
+        QHash<KCCell, bool>::const_iterator it = prepared.results.constFind(cell);
+        if (it != prepared.results.constEnd())
+            return it.value();
     }
+    KCFormula f(cell.sheet(), cell);
+    f.setExpression(prepared.expression(cell));
     KCValue val = f.eval();
-    return calc->conv()->asBoolean(val).asBoolean();
+    const bool result = calc->conv()->asBoolean(val).asBoolean();
+    if (useCache)
+        prepared.results.insert(cell, result);
+    return result;
 }
 
 QLinkedList<KCConditional> KCConditions::conditionList() const
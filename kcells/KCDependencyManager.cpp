@@ -25,6 +25,9 @@
 
 #include <QHash>
 #include <QList>
+#include <QRegion>
+#include <QtConcurrentMap>
+#include <QVector>
 
 #include "KCCell.h"
 #include "KCCellStorage.h"
@@ -192,20 +195,48 @@ void KCDependencyManager::updateAllDependencies(const KCMap* map)
     d->namedAreaConsumers.clear();
     d->depths.clear();
 
-    KCCell cell;
+    // Extract the references of each sheet's formulas concurrently.
+    // Compiling a formula may create an error value, so do it beforehand.
+    KCValue::createErrorValues();
+    QList<Private::SheetDependencies> jobs;
     foreach(const KCSheet* sheet, map->sheetList()) {
-        for (int c = 0; c < sheet->formulaStorage()->count(); ++c) {
-            cell = KCCell(sheet, sheet->formulaStorage()->col(c), sheet->formulaStorage()->row(c));
-
-            d->generateDependencies(cell, sheet->formulaStorage()->data(c));
-            if (!d->depths.contains(cell)) {
-                int depth = d->computeDepth(cell);
-                d->depths.insert(cell , depth);
-            }
-            if (!sheet->formulaStorage()->data(c).isValid())
+        Private::SheetDependencies job;
+        job.sheet = sheet;
+        jobs.append(job);
+    }
+    if (jobs.count() > 1)
+        QtConcurrent::blockingMap(jobs, &Private::extractSheetDependencies);
+    else if (!jobs.isEmpty())
+        Private::extractSheetDependencies(jobs[0]);
+
+    // Store them and bulk load the consumer trees.
+    typedef QPair<KCSheet*, QRect> Range;
+    typedef QPair<KCCell, Private::Dependencies> CellDependencies;
+    QHash<KCSheet*, QList<QPair<QRegion, KCCell> > > consumerData;
+    foreach(const Private::SheetDependencies& job, jobs) {
+        foreach(const CellDependencies& cellDependencies, job.cells) {
+            const KCCell& cell = cellDependencies.first;
+            const Private::Dependencies& dependencies = cellDependencies.second;
+            foreach(const QString& name, dependencies.namedAreas)
+                d->namedAreaConsumers[name].append(cell);
+            foreach(const Range& range, dependencies.ranges)
+                consumerData[range.first].append(qMakePair(QRegion(range.second), cell));
+            d->providers.insert(cell, dependencies.region);
+        }
+        foreach(KCCell cell, job.brokenCells) {
+            d->depths.insert(cell, 0);
+            if (!cell.formula().isValid())
                 cell.setValue(KCValue::errorPARSE());
         }
     }
+    QHash<KCSheet*, QList<QPair<QRegion, KCCell> > >::ConstIterator end(consumerData.constEnd());
+    for (QHash<KCSheet*, QList<QPair<QRegion, KCCell> > >::ConstIterator it(consumerData.constBegin()); it != end; ++it) {
+        KCRTree<KCCell>* const tree = new KCRTree<KCCell>();
+        tree->load(it.value());
+        d->consumers.insert(it.key(), tree);
+    }
+
+    d->generateAllDepths();
 }
 
 QHash<KCCell, int> KCDependencyManager::depths() const
@@ -529,20 +560,45 @@ int KCDependencyManager::Private::computeDepth(KCCell cell) const
 }
 
 void KCDependencyManager::Private::computeDependencies(const KCCell& cell, const KCFormula& formula)
+{
+    Dependencies dependencies;
+    if (!extractDependencies(cell, formula, &dependencies))
+        return;
+
+    // add cell as consumer of the named areas
+    foreach(const QString& name, dependencies.namedAreas)
+        namedAreaConsumers[name].append(cell);
+
+    typedef QPair<KCSheet*, QRect> Range;
+    foreach(const Range& range, dependencies.ranges) {
+        // create consumer tree, if not existing yet
+        if (!consumers.contains(range.first)) consumers.insert(range.first, new KCRTree<KCCell>());
+        // add cell as consumer of the range
+        consumers[range.first]->insert(range.second, cell);
+    }
+
+    // store the providing region
+    // NOTE Stefan: Also store cells without dependencies to avoid an
+    //              iteration over all cells in a map/sheet on recalculation.
+    // empty region will be created automatically, if necessary
+    providers[cell].add(dependencies.region);
+}
+
+bool KCDependencyManager::Private::extractDependencies(const KCCell& cell, const KCFormula& formula,
+                                                       Dependencies* dependencies)
 {
     // Broken formula -> meaningless dependencies
     if (!formula.isValid())
-        return;
+        return false;
 
     const Tokens tokens = formula.tokens();
 
     //return empty list if the tokens aren't valid
     if (!tokens.valid())
-        return;
+        return false;
 
     KCSheet* sheet = cell.sheet();
     int inAreasCall = 0;
-    KCRegion providingRegion;
     for (int i = 0; i < tokens.count(); i++) {
         const KCToken token = tokens[i];
 
@@ -560,8 +616,7 @@ void KCDependencyManager::Private::computeDependencies(const KCCell& cell, const
                 // check for named area
                 const bool isNamedArea = sheet->map()->namedAreaManager()->contains(token.text());
                 if (isNamedArea) {
-                    // add cell as consumer of the named area
-                    namedAreaConsumers[token.text()].append(cell);
+                    dependencies->namedAreas.append(token.text());
                 }
 
                 // check if valid cell/range
@@ -580,24 +635,163 @@ void KCDependencyManager::Private::computeDependencies(const KCCell& cell, const
                         }
                     }
                     // add it to the providers
-                    providingRegion.add(region);
+                    dependencies->region.add(region);
+                    dependencies->ranges.append(qMakePair(region.firstSheet(), region.firstRange()));
+                }
+            }
+        }
+    }
+    return true;
+}
 
-                    KCSheet* sheet = region.firstSheet();
+void KCDependencyManager::Private::extractSheetDependencies(SheetDependencies& job)
+{
+    const KCFormulaStorage* const storage = job.sheet->formulaStorage();
+    for (int c = 0; c < storage->count(); ++c) {
+        const KCCell cell(job.sheet, storage->col(c), storage->row(c));
+        const KCFormula formula = storage->data(c);
+        Dependencies dependencies;
+        if (extractDependencies(cell, formula, &dependencies))
+            job.cells.append(qMakePair(cell, dependencies));
+        else
+            job.brokenCells.append(cell);
+    }
+}
+
+namespace
+{
+/**
+ * Propagates the depths of the resolved cells in \p queue from
+ * \p resolved on to their consumers. Appends the consumers to \p queue ,
+ * as soon as all their providers are resolved.
+ * Consumers with a negative number of \p pending providers are
+ * flagged as circular and keep their depth.
+ */
+void resolveDepths(const QVector<QVector<int> >& consumingCells, QVector<int>& pending,
+                   QVector<int>& depths, QVector<int>& queue, int& resolved)
+{
+    while (resolved < queue.count()) {
+        const int provider = queue[resolved++];
+        const QVector<int>& consumers = consumingCells[provider];
+        for (int c = 0; c < consumers.count(); ++c) {
+            const int consumer = consumers[c];
+            if (pending[consumer] < 0)
+                continue;
+            depths[consumer] = qMax(depths[consumer], depths[provider] + 1);
+            if (--pending[consumer] == 0)
+                queue.append(consumer);
+        }
+    }
+}
+}
+
+void KCDependencyManager::Private::generateAllDepths()
+{
+    // Number the cells with formulas; the graph works on these indices.
+    const QList<KCCell> cells = providers.keys();
+    QHash<KCCell, int> indices;
+    indices.reserve(cells.count());
+    for (int i = 0; i < cells.count(); ++i)
+        indices.insert(cells[i], i);
+
+    // the consuming cells of each cell and the number of unresolved providers
+    QVector<QVector<int> > consumingCells(cells.count());
+    QVector<int> pending(cells.count(), 0);
+    QVector<int> cellDepths(cells.count(), 0);
+    QVector<int> queue;
+    queue.reserve(cells.count());
+
+    for (int i = 0; i < cells.count(); ++i) {
+        // Cells flagged as circular before are not descended into.
+        if (cells[i].value() == KCValue::errorCIRCLE()) {
+            queue.append(i);
+            continue;
+        }
+        const KCRegion region = providers.value(cells[i]);
+        KCRegion::ConstIterator end(region.constEnd());
+        for (KCRegion::ConstIterator it(region.constBegin()); it != end; ++it) {
+            // A reference covers a cell without further references, unless
+            // all of the range is filled with formulas. Either way, the
+            // depth is one at least.
+            cellDepths[i] = 1;
+            KCSheet* const sheet = (*it)->sheet();
+            const QVector< QPair<QPoint, KCFormula> > formulas = sheet->formulaStorage()->dataInRect((*it)->rect());
+            for (int f = 0; f < formulas.count(); ++f) {
+                const int provider = indices.value(KCCell(sheet, formulas[f].first), -1);
+                if (provider == -1)
+                    continue;
+                consumingCells[provider].append(i);
+                ++pending[i];
+            }
+        }
+        if (pending[i] == 0)
+            queue.append(i);
+    }
 
-                    // create consumer tree, if not existing yet
-                    if (!consumers.contains(sheet)) consumers.insert(sheet, new KCRTree<KCCell>());
-                    // add cell as consumer of the range
-                    consumers[sheet]->insert(region.firstRange(), cell);
+    // Kahn's algorithm: a cell is resolved, once all its providers are.
+    int resolved = 0;
+    resolveDepths(consumingCells, pending, cellDepths, queue, resolved);
+    if (resolved < cells.count()) {
+        // The remaining cells are part of or depend on circular references.
+        // Find the strongly connected components among them (Tarjan's
+        // algorithm without recursion), flag the circular ones and treat
+        // them like cells without references to resolve the rest.
+        QVector<int> index(cells.count(), -1);
+        QVector<int> lowLink(cells.count(), 0);
+        QVector<bool> onStack(cells.count(), false);
+        QVector<int> stack;
+        QVector<QPair<int, int> > path; // the visited cell and its next consumer
+        int counter = 0;
+        for (int start = 0; start < cells.count(); ++start) {
+            if (pending[start] <= 0 || index[start] != -1)
+                continue;
+            index[start] = lowLink[start] = counter++;
+            stack.append(start);
+            onStack[start] = true;
+            path.append(qMakePair(start, 0));
+            while (!path.isEmpty()) {
+                const int cell = path.last().first;
+                if (path.last().second < consumingCells[cell].count()) {
+                    const int consumer = consumingCells[cell][path.last().second++];
+                    if (pending[consumer] <= 0)
+                        continue;
+                    if (index[consumer] == -1) {
+                        index[consumer] = lowLink[consumer] = counter++;
+                        stack.append(consumer);
+                        onStack[consumer] = true;
+                        path.append(qMakePair(consumer, 0));
+                    } else if (onStack[consumer])
+                        lowLink[cell] = qMin(lowLink[cell], index[consumer]);
+                    continue;
                 }
+                path.pop_back();
+                if (!path.isEmpty())
+                    lowLink[path.last().first] = qMin(lowLink[path.last().first], lowLink[cell]);
+                if (lowLink[cell] != index[cell])
+                    continue;
+                const int first = stack.lastIndexOf(cell);
+                const bool circular = first < stack.count() - 1 || consumingCells[cell].contains(cell);
+                for (int i = first; i < stack.count(); ++i) {
+                    onStack[stack[i]] = false;
+                    if (!circular)
+                        continue;
+                    kDebug(36002) << "Circular dependency at" << cells[stack[i]].fullName();
+                    KCCell(cells[stack[i]]).setValue(KCValue::errorCIRCLE());
+                    cellDepths[stack[i]] = 0;
+                    queue.append(stack[i]);
+                }
+                stack.resize(first);
             }
         }
+        // Mark the circular cells as resolved only now, not to cut the
+        // components apart while searching them.
+        for (int i = resolved; i < queue.count(); ++i)
+            pending[queue[i]] = -1;
+        resolveDepths(consumingCells, pending, cellDepths, queue, resolved);
     }
 
-    // store the providing region
-    // NOTE Stefan: Also store cells without dependencies to avoid an
-    //              iteration over all cells in a map/sheet on recalculation.
-    // empty region will be created automatically, if necessary
-    providers[cell].add(providingRegion);
+    for (int i = 0; i < cells.count(); ++i)
+        depths.insert(cells[i], cellDepths[i]);
 }
 
 void KCDependencyManager::Private::removeCircularDependencyFlags(const KCRegion& region, Direction direction)
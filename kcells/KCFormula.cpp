@@ -1341,6 +1341,32 @@ KCValue KCFormula::eval(CellIndirection cellIndirections) const
     return evalRecursive(cellIndirections, values);
 }
 
+// evaluate with hypothetical values
+KCValue KCFormula::eval(const QHash<KCCell, KCValue>& values, const QSet<KCCell>& cone) const
+{
+    QHash<KCCell, KCValue> cellValues(values);
+    return evalRecursive(CellIndirection(), cellValues, &cone);
+}
+
+KCValue KCFormula::cellValue(const KCCell& cell, CellIndirection cellIndirections,
+                             QHash<KCCell, KCValue>& values, const QSet<KCCell>* cone) const
+{
+    if (values.contains(cell))
+        return values.value(cell);
+    // not affected by the hypothetical values
+    if (cone && !cone->contains(cell))
+        return cell.value();
+
+    KCValue value;
+    values[cell] = KCValue::errorCIRCLE();
+    if (cell.isFormula())
+        value = cell.formula().evalRecursive(cellIndirections, values, cone);
+    else
+        value = cell.value();
+    values[cell] = value;
+    return value;
+}
+
 // We need to unroll arrays. Do use the same logic to unroll like OpenOffice.org and Excel are using.
 KCValue KCFormula::Private::valueOrElement(FuncExtra &fe, const stackEntry& entry) const
 {
@@ -1387,7 +1413,8 @@ KCValue numericOrError(const KCValueConverter* converter, const KCValue &v)
     return KCValue::errorVALUE();
 }
 
-KCValue KCFormula::evalRecursive(CellIndirection cellIndirections, QHash<KCCell, KCValue>& values) const
+KCValue KCFormula::evalRecursive(CellIndirection cellIndirections, QHash<KCCell, KCValue>& values,
+                                 const QSet<KCCell>* cone) const
 {
     QStack<stackEntry> stack;
     stackEntry entry;
@@ -1403,6 +1430,7 @@ KCValue KCFormula::evalRecursive(CellIndirection cellIndirections, QHash<KCCell,
     QSharedPointer<KCFunction> function;
     FuncExtra fe;
     fe.mycol = fe.myrow = 0;
+    fe.whatIf = cone != 0;
     if (!d->cell.isNull()) {
         fe.mycol = d->cell.column();
         fe.myrow = d->cell.row();
@@ -1632,21 +1660,12 @@ KCValue KCFormula::evalRecursive(CellIndirection cellIndirections, QHash<KCCell,
                 val1 = KCValue::errorREF();
             } else if (region.isSingular()) {
                 const QPoint position = region.firstRange().topLeft();
-                if (cellIndirections.isEmpty())
+                if (cellIndirections.isEmpty() && !cone)
                     val1 = KCCell(region.firstSheet(), position).value();
                 else {
                     KCCell cell(region.firstSheet(), position);
                     cell = cellIndirections.value(cell, cell);
-                    if (values.contains(cell))
-                        val1 = values.value(cell);
-                    else {
-                        values[cell] = KCValue::errorCIRCLE();
-                        if (cell.isFormula())
-                            val1 = cell.formula().evalRecursive(cellIndirections, values);
-                        else
-                            val1 = cell.value();
-                        values[cell] = val1;
-                    }
+                    val1 = cellValue(cell, cellIndirections, values, cone);
                 }
                 // store the reference, so we can use it within functions
                 entry.col1 = entry.col2 = position.x();
@@ -1670,6 +1689,17 @@ KCValue KCFormula::evalRecursive(CellIndirection cellIndirections, QHash<KCCell,
             const KCRegion region(c, map, d->sheet);
             if (region.isValid()) {
                 val1 = region.firstSheet()->cellStorage()->valueRegion(region);
+                if (cone) {
+                    // replace the values affected by the hypothetical ones
+                    const QRect range = region.firstRange();
+                    foreach(const KCCell& cell, *cone) {
+                        if (cell.sheet() == region.firstSheet() && range.contains(cell.cellPosition())) {
+                            const QPoint offset = cell.cellPosition() - range.topLeft();
+                            val1.setElement(offset.x(), offset.y(),
+                                            cellValue(cell, cellIndirections, values, cone));
+                        }
+                    }
+                }
                 // store the reference, so we can use it within functions
                 entry.col1 = region.firstRange().left();
                 entry.row1 = region.firstRange().top();
@@ -21,6 +21,7 @@
 #define KC_FORMULA
 
 #include <QHash>
+#include <QSet>
 #include <QSharedDataPointer>
 #include <QString>
 #include <QTextStream>
@@ -379,6 +380,15 @@ public:
      */
     KCValue eval(CellIndirection cellIndirections = CellIndirection()) const;
 
+    /**
+     * Evaluates the formula as if the cells in \p values had got these values.
+     * \p cone has to contain these cells and all cells depending on them.
+     * Only the formulas of the cells in \p cone are evaluated again; all
+     * other cells keep their stored values. No cell is altered.
+     * \see KCWhatIfEvaluator
+     */
+    KCValue eval(const QHash<KCCell, KCValue>& values, const QSet<KCCell>& cone) const;
+
     /**
      * Given an expression, this function separates it into tokens.
      * If the expression contains error (e.g. unknown operator, string no terminated)
@@ -410,8 +420,17 @@ protected:
     /**
      * helper function for recursive evaluations; makes sure one cell
      * is not evaluated more than once resulting in infinite loops
+     * \param cone the cells to evaluate again in a what-if evaluation
+     */
+    KCValue evalRecursive(CellIndirection cellIndirections, QHash<KCCell, KCValue>& values,
+                          const QSet<KCCell>* cone = 0) const;
+
+    /**
+     * helper function for recursive evaluations; returns the value of
+     * \p cell , which is evaluated again, if necessary
      */
-    KCValue evalRecursive(CellIndirection cellIndirections, QHash<KCCell, KCValue>& values) const;
+    KCValue cellValue(const KCCell& cell, CellIndirection cellIndirections,
+                      QHash<KCCell, KCValue>& values, const QSet<KCCell>* cone) const;
 
 private:
     class Private;
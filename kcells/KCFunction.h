@@ -56,6 +56,9 @@ struct FuncExtra {
     QVector<KCRegion> regions;
     KCSheet *sheet;
     int myrow, mycol;
+    // set, if cells are evaluated with hypothetical values; the caches
+    // of the stored values must not be used then
+    bool whatIf;
 };
 
 typedef KCValue(*FunctionPtr)(valVector, KCValueCalc *, FuncExtra *);
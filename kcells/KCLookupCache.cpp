@@ -0,0 +1,519 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// Local
+#include "KCLookupCache.h"
+
+#include <QCache>
+#include <QHash>
+#include <QPair>
+#include <QRect>
+#include <QSet>
+#include <QVector>
+
+#include <qalgorithms.h>
+
+#include <float.h>
+#include <limits.h>
+
+#include "Damages.h"
+#include "KCMap.h"
+#include "KCRegion.h"
+#include "KCValue.h"
+#include "KCValueCalc.h"
+#include "KCValueConverter.h"
+
+// the maximum number of indexed cells
+static const int g_maxCost = 4 * 1024 * 1024;
+// the maximum number of ranges remembered as requested once
+static const int g_maxRequested = 1024;
+// integers beyond this cannot be compared as floating point numbers
+static const qint64 g_maxExactInteger = Q_INT64_C(1) << 53;
+
+namespace
+{
+struct Key {
+    const KCSheet* sheet;
+    QRect range;
+
+    bool operator==(const Key& other) const {
+        return sheet == other.sheet && range == other.range;
+    }
+};
+
+uint qHash(const Key& key)
+{
+    return ::qHash(key.sheet) ^ (uint(key.range.left()) << 16) ^ uint(key.range.top())
+           ^ (uint(key.range.width()) << 24) ^ (uint(key.range.height()) << 8);
+}
+
+typedef QPair<KCNumber, int> NumberEntry;
+typedef QPair<QString, int> StringEntry;
+
+/**
+ * The index of a single row or column.
+ */
+struct Index {
+    Index() : special(false) {
+        stringsBuilt[0] = stringsBuilt[1] = false;
+    }
+
+    // Contains values, that compare with the keys in peculiar ways,
+    // e.g. errors by their message, or integers beyond the double precision.
+    bool special;
+    // the numbers sorted by value and position
+    QVector<NumberEntry> numbers;
+    // the strings, case insensitive ([0]) and case sensitive ([1]); built on demand
+    bool stringsBuilt[2];
+    QHash<QString, int> strings[2];
+    QVector<StringEntry> sortedStrings[2];
+};
+
+/**
+ * The index of the criteria functions; contains all non-empty cells of a range
+ * converted as for the numeric and for the string conditions.
+ */
+struct CriteriaIndex {
+    CriteriaIndex() : stringsBuilt(false) {}
+
+    QVector<NumberEntry> numbers;
+    bool stringsBuilt;
+    QVector<StringEntry> strings;
+};
+
+/**
+ * Appends the positions of the entries from \p begin to \p end to \p positions .
+ * \return the number of entries
+ */
+template<typename Iterator>
+int appendPositions(Iterator begin, Iterator end, QVector<int>* positions)
+{
+    if (positions) {
+        for (Iterator it = begin; it != end; ++it)
+            positions->append(it->second);
+    }
+    return end - begin;
+}
+
+/**
+ * Searches the entries matching the comparison \p comp with \p value .
+ * The equality of numbers is handled by the caller.
+ * \return the number of matching entries
+ */
+template<typename T>
+int matchEntries(const QVector<QPair<T, int> >& entries, Comp comp, const T& value, QVector<int>* positions)
+{
+    typedef typename QVector<QPair<T, int> >::ConstIterator Iterator;
+    const Iterator begin = entries.constBegin();
+    const Iterator end = entries.constEnd();
+    const Iterator lower = qLowerBound(begin, end, qMakePair(value, INT_MIN));
+    const Iterator upper = qUpperBound(lower, end, qMakePair(value, INT_MAX));
+    switch (comp) {
+    case IsEqual:
+        return appendPositions(lower, upper, positions);
+    case IsLess:
+        return appendPositions(begin, lower, positions);
+    case IsGreater:
+        return appendPositions(upper, end, positions);
+    case LessEqual:
+        return appendPositions(begin, upper, positions);
+    case GreaterEqual:
+        return appendPositions(lower, end, positions);
+    case NotEqual:
+        return appendPositions(begin, lower, positions) + appendPositions(upper, end, positions);
+    }
+    return 0;
+}
+
+/**
+ * \return \c true , if \p region and \p rect have got cells in common
+ */
+bool intersects(const KCRegion& region, const QRect& rect)
+{
+    KCRegion::ConstIterator end(region.constEnd());
+    for (KCRegion::ConstIterator it(region.constBegin()); it != end; ++it) {
+        if ((*it)->rect().intersects(rect))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * \return the value at \p position of the row or column in \p values
+ */
+inline KCValue element(const KCValue& values, bool vertical, int position)
+{
+    return vertical ? values.element(0, position) : values.element(position, 0);
+}
+}
+
+class KCLookupCache::Private
+{
+public:
+    /**
+     * \return the index of \p range or zero, if it cannot be indexed
+     */
+    Index* index(const KCSheet* sheet, const QRect& range, const KCValue& values);
+
+    /**
+     * Builds the string part of \p index for the case sensitivity \p cs .
+     */
+    void buildStrings(Index* index, const QRect& range, const KCValue& values, bool cs);
+
+    /**
+     * Removes the data of the cells in \p region on \p sheet .
+     * If \p region is zero, the data of the whole sheet is removed.
+     */
+    void remove(const KCSheet* sheet, const KCRegion* region);
+
+    const KCMap* map;
+    QCache<Key, Index> indexes;
+    QCache<Key, QVector<double> > sortedNumbers;
+    QCache<Key, CriteriaIndex> criteria;
+    // the ranges, whose numbers or criteria were requested once, but are not indexed yet
+    QSet<Key> requested;
+
+    /**
+     * \return \c true , if \p key was requested before; remembers it otherwise
+     */
+    bool requestedBefore(const Key& key);
+};
+
+Index* KCLookupCache::Private::index(const KCSheet* sheet, const QRect& range, const KCValue& values)
+{
+    // The damages, that keep the indexes up to date, are not created while loading.
+    if (map->isLoading() || !sheet || range.isEmpty())
+        return 0;
+    const bool vertical = range.width() == 1;
+    if (!vertical && range.height() != 1)
+        return 0;
+    const int count = vertical ? range.height() : range.width();
+    if ((vertical ? values.rows() : values.columns()) < uint(count))
+        return 0;
+
+    Key key;
+    key.sheet = sheet;
+    key.range = range;
+    Index* index = indexes.object(key);
+    if (index)
+        return index;
+
+    index = new Index();
+    for (int i = 0; i < count; ++i) {
+        const KCValue value = element(values, vertical, i);
+        switch (value.type()) {
+        case KCValue::Empty:
+        case KCValue::Boolean:
+        case KCValue::String:
+            // never equal to numbers; strings are indexed on demand
+            break;
+        case KCValue::Integer:
+            if (qAbs(value.asInteger()) > g_maxExactInteger)
+                index->special = true;
+            // fall through
+        case KCValue::Float:
+            index->numbers.append(qMakePair(value.asFloat(), i));
+            break;
+        default:
+            index->special = true;
+            break;
+        }
+    }
+    qSort(index->numbers);
+    indexes.insert(key, index, count);
+    return indexes.object(key);
+}
+
+void KCLookupCache::Private::buildStrings(Index* index, const QRect& range, const KCValue& values, bool cs)
+{
+    const bool vertical = range.width() == 1;
+    const int count = vertical ? range.height() : range.width();
+    QHash<QString, int>& strings = index->strings[cs];
+    QVector<StringEntry>& sortedStrings = index->sortedStrings[cs];
+    for (int i = 0; i < count; ++i) {
+        const KCValue value = element(values, vertical, i);
+        if (!value.isString())
+            continue;
+        const QString string = cs ? value.asString() : value.asString().toLower();
+        // An empty string is never lower than the key or greater than another string.
+        if (string.isEmpty())
+            continue;
+        if (!strings.contains(string))
+            strings.insert(string, i);
+        sortedStrings.append(qMakePair(string, i));
+    }
+    qSort(sortedStrings);
+    index->stringsBuilt[cs] = true;
+}
+
+void KCLookupCache::Private::remove(const KCSheet* sheet, const KCRegion* region)
+{
+    foreach(const Key& key, indexes.keys()) {
+        if (key.sheet == sheet && (!region || intersects(*region, key.range)))
+            indexes.remove(key);
+    }
+    foreach(const Key& key, sortedNumbers.keys()) {
+        if (key.sheet == sheet && (!region || intersects(*region, key.range)))
+            sortedNumbers.remove(key);
+    }
+    foreach(const Key& key, criteria.keys()) {
+        if (key.sheet == sheet && (!region || intersects(*region, key.range)))
+            criteria.remove(key);
+    }
+    QSet<Key>::Iterator it = requested.begin();
+    while (it != requested.end()) {
+        if (it->sheet == sheet && (!region || intersects(*region, it->range)))
+            it = requested.erase(it);
+        else
+            ++it;
+    }
+}
+
+bool KCLookupCache::Private::requestedBefore(const Key& key)
+{
+    if (requested.contains(key))
+        return true;
+    if (requested.count() >= g_maxRequested)
+        requested.clear();
+    requested.insert(key);
+    return false;
+}
+
+KCLookupCache::KCLookupCache(const KCMap* map)
+        : d(new Private)
+{
+    d->map = map;
+    d->indexes.setMaxCost(g_maxCost);
+    d->sortedNumbers.setMaxCost(g_maxCost);
+    d->criteria.setMaxCost(g_maxCost);
+}
+
+KCLookupCache::~KCLookupCache()
+{
+    delete d;
+}
+
+int KCLookupCache::exactMatch(const KCSheet* sheet, const QRect& range, const KCValue& values,
+                              const KCValue& key, bool caseSensitive, bool* ok)
+{
+    *ok = false;
+    Index* const index = d->index(sheet, range, values);
+    if (!index || index->special)
+        return -1;
+
+    if (key.isString()) {
+        const QString string = caseSensitive ? key.asString() : key.asString().toLower();
+        // an empty string equals empty cells, which are not indexed
+        if (string.isEmpty())
+            return -1;
+        if (!index->stringsBuilt[caseSensitive])
+            d->buildStrings(index, range, values, caseSensitive);
+        *ok = true;
+        return index->strings[caseSensitive].value(string, -1);
+    }
+
+    if (key.isInteger() || key.isFloat()) {
+        if (key.isInteger() && qAbs(key.asInteger()) > g_maxExactInteger)
+            return -1;
+        // The equal numbers are consecutive, as they only differ by DBL_EPSILON.
+        const KCNumber number = key.asFloat();
+        const QVector<NumberEntry>& numbers = index->numbers;
+        int low = 0;
+        int high = numbers.count();
+        while (low < high) {
+            const int middle = (low + high) / 2;
+            if (KCValue::compare(number, numbers[middle].first) > 0)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        int position = -1;
+        for (int i = low; i < numbers.count() && KCValue::compare(number, numbers[i].first) == 0; ++i) {
+            if (position == -1 || numbers[i].second < position)
+                position = numbers[i].second;
+        }
+        *ok = true;
+        return position;
+    }
+    // booleans, empty values, etc. are compared in too many ways
+    return -1;
+}
+
+int KCLookupCache::lowerMatch(const KCSheet* sheet, const QRect& range, const KCValue& values,
+                              const KCValue& key, bool caseSensitive, bool* ok)
+{
+    *ok = false;
+    // Only string keys; the linear search handles the others.
+    if (!key.isString() || key.asString().isEmpty())
+        return -1;
+    Index* const index = d->index(sheet, range, values);
+    if (!index || index->special)
+        return -1;
+    if (!index->stringsBuilt[caseSensitive])
+        d->buildStrings(index, range, values, caseSensitive);
+
+    const QString string = caseSensitive ? key.asString() : key.asString().toLower();
+    const QVector<StringEntry>& sortedStrings = index->sortedStrings[caseSensitive];
+    QVector<StringEntry>::ConstIterator it;
+    it = qLowerBound(sortedStrings.constBegin(), sortedStrings.constEnd(), qMakePair(string, -1));
+    *ok = true;
+    if (it == sortedStrings.constBegin())
+        return -1;
+    // the first position of the greatest lower string
+    const QString lower = (it - 1)->first;
+    it = qLowerBound(sortedStrings.constBegin(), it, qMakePair(lower, -1));
+    return it->second;
+}
+
+bool KCLookupCache::sortedNumbers(const KCSheet* sheet, const QRect& range,
+                                  QVector<double>* numbers, bool* sort)
+{
+    *sort = false;
+    if (d->map->isLoading() || !sheet || range.isEmpty())
+        return false;
+    Key key;
+    key.sheet = sheet;
+    key.range = range;
+    const QVector<double>* sorted = d->sortedNumbers.object(key);
+    if (sorted) {
+        *numbers = *sorted;
+        return true;
+    }
+    *sort = d->requestedBefore(key);
+    return false;
+}
+
+void KCLookupCache::setSortedNumbers(const KCSheet* sheet, const QRect& range,
+                                     const QVector<double>& numbers)
+{
+    if (d->map->isLoading() || !sheet || range.isEmpty())
+        return;
+    Key key;
+    key.sheet = sheet;
+    key.range = range;
+    d->requested.remove(key);
+    d->sortedNumbers.insert(key, new QVector<double>(numbers), numbers.count() + 1);
+}
+
+int KCLookupCache::criteriaMatches(const KCSheet* sheet, const QRect& range, const KCValue& values,
+                                   const Condition& cond, KCValueCalc* calc, QVector<int>* positions)
+{
+    if (d->map->isLoading() || !sheet || range.isEmpty() || !values.isArray())
+        return -1;
+    const int columns = range.width();
+    if (int(values.columns()) != columns || int(values.rows()) != range.height())
+        return -1;
+    Key key;
+    key.sheet = sheet;
+    key.range = range;
+    CriteriaIndex* index = d->criteria.object(key);
+    if (!index) {
+        if (!d->requestedBefore(key))
+            return -1;
+        index = new CriteriaIndex();
+        for (int row = 0; row < range.height(); ++row) {
+            for (int col = 0; col < columns; ++col) {
+                const KCValue value = values.element(col, row);
+                if (value.isEmpty())
+                    continue;
+                if (value.isArray()) {
+                    delete index;
+                    return -1;
+                }
+                index->numbers.append(qMakePair(calc->conv()->toFloat(value), row * columns + col));
+            }
+        }
+        qSort(index->numbers);
+        d->requested.remove(key);
+        d->criteria.insert(key, index, index->numbers.count() + 1);
+        index = d->criteria.object(key);
+    }
+
+    int count = 0;
+    if (cond.type == String) {
+        if (!index->stringsBuilt) {
+            for (int i = 0; i < index->numbers.count(); ++i) {
+                const int position = index->numbers[i].second;
+                const KCValue value = values.element(position % columns, position / columns);
+                index->strings.append(qMakePair(calc->conv()->asString(value).asString(), position));
+            }
+            qSort(index->strings);
+            index->stringsBuilt = true;
+        }
+        count = matchEntries(index->strings, cond.comp, cond.stringValue, positions);
+    } else if (cond.comp == IsEqual) {
+        // The approximate equality depends on the magnitude of the cell's number.
+        const KCNumber tolerance = 4 * qAbs(cond.value) * DBL_EPSILON;
+        QVector<NumberEntry>::ConstIterator it, end;
+        it = qLowerBound(index->numbers.constBegin(), index->numbers.constEnd(),
+                         qMakePair(KCNumber(cond.value - tolerance), INT_MIN));
+        end = qUpperBound(it, index->numbers.constEnd(),
+                          qMakePair(KCNumber(cond.value + tolerance), INT_MAX));
+        for (; it != end; ++it) {
+            if (calc->approxEqual(KCValue(it->first), KCValue(cond.value))) {
+                if (positions)
+                    positions->append(it->second);
+                ++count;
+            }
+        }
+    } else
+        count = matchEntries(index->numbers, cond.comp, cond.value, positions);
+
+    if (positions)
+        qSort(*positions);
+    return count;
+}
+
+void KCLookupCache::handleDamage(const KCDamage* damage)
+{
+    if (d->indexes.isEmpty() && d->sortedNumbers.isEmpty() && d->criteria.isEmpty() && d->requested.isEmpty())
+        return;
+
+    if (damage->type() == KCDamage::DamagedCell) {
+        const KCCellDamage* cellDamage = static_cast<const KCCellDamage*>(damage);
+        // appearance changes only do not alter any value
+        if (!(cellDamage->changes() & ~KCCellDamage::Changes(KCCellDamage::Appearance)))
+            return;
+        d->remove(cellDamage->sheet(), &cellDamage->region());
+    } else if (damage->type() == KCDamage::DamagedSheet) {
+        const KCSheetDamage* sheetDamage = static_cast<const KCSheetDamage*>(damage);
+        const KCSheetDamage::Changes changes = KCSheetDamage::ContentChanged |
+                                               KCSheetDamage::ColumnsChanged |
+                                               KCSheetDamage::RowsChanged;
+        if (sheetDamage->changes() & changes)
+            removeSheet(sheetDamage->sheet());
+    } else if (damage->type() == KCDamage::DamagedWorkbook) {
+        clear();
+    }
+}
+
+void KCLookupCache::clear()
+{
+    d->indexes.clear();
+    d->sortedNumbers.clear();
+    d->criteria.clear();
+    d->requested.clear();
+}
+
+void KCLookupCache::removeSheet(KCSheet *sheet)
+{
+    d->remove(sheet, 0);
+}
+
+#include "KCLookupCache.moc"
@@ -0,0 +1,154 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KC_LOOKUP_CACHE
+#define KC_LOOKUP_CACHE
+
+#include <QObject>
+#include <QVector>
+
+#include "kcells_export.h"
+
+class QRect;
+struct Condition;
+class KCDamage;
+class KCMap;
+class KCSheet;
+class KCValue;
+class KCValueCalc;
+
+/**
+ * \class KCLookupCache
+ * \brief Indexes of cell ranges searched by the lookup functions.
+ * \ingroup KCValue
+ *
+ * VLOOKUP, HLOOKUP and MATCH search the same table over and over again, if
+ * many formulas refer to it. The first search in a single row or column
+ * builds an index, that is shared by all later searches in the same cells:
+ * a hash of the strings for exact matches and sorted numbers and strings
+ * for the matches of the nearest lower value.
+ *
+ * The results are the same as the ones of the linear searches with
+ * KCValueCalc::naturalEqual() and KCValueCalc::naturalLower(). If the index
+ * cannot guarantee that for a key or the cell contents, the lookup reports
+ * it and the caller searches linearly.
+ *
+ * It also keeps the sorted numbers of cell ranges for the order statistics,
+ * e.g. MEDIAN, PERCENTILE or LARGE, and the sorted cell contents for the
+ * criteria of SUMIF and COUNTIF, if several of them use the same cells.
+ *
+ * An index is dropped as soon as a damage touches its cells, i.e. also
+ * while a recalculation is in progress.
+ */
+class KCELLS_EXPORT KCLookupCache : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * Creates the lookup cache of \p map .
+     */
+    explicit KCLookupCache(const KCMap* map);
+
+    /**
+     * Destructor.
+     */
+    ~KCLookupCache();
+
+    /**
+     * Searches the first cell equal to \p key .
+     *
+     * \param sheet the sheet of the searched cells
+     * \param range the searched cells; a single row or column
+     * \param values the values of \p range as array; in the first column,
+     * if \p range is a column, or in the first row otherwise
+     * \param key the value to search
+     * \param caseSensitive whether strings are compared case sensitive
+     * \param ok set to \c false , if the index cannot be used
+     * \return the zero-based position of the cell in \p range or -1, if there is none
+     */
+    int exactMatch(const KCSheet* sheet, const QRect& range, const KCValue& values,
+                   const KCValue& key, bool caseSensitive, bool* ok);
+
+    /**
+     * Searches the first of the greatest cells lower than \p key .
+     * Has the same parameters as exactMatch().
+     * \return the zero-based position of the cell in \p range or -1, if there is none
+     */
+    int lowerMatch(const KCSheet* sheet, const QRect& range, const KCValue& values,
+                   const KCValue& key, bool caseSensitive, bool* ok);
+
+    /**
+     * Retrieves the numbers of the cells in \p range sorted in ascending order.
+     *
+     * A single order statistic is cheaper to select without sorting. So the
+     * sorted numbers are only worth to be kept from the second request for
+     * the same cells on.
+     *
+     * \param numbers the sorted numbers, if available
+     * \param sort set to \c true , if the numbers were requested before without
+     * being available; the caller should sort them and store them with setSortedNumbers()
+     * \return \c true , if the sorted numbers are available
+     */
+    bool sortedNumbers(const KCSheet* sheet, const QRect& range, QVector<double>* numbers, bool* sort);
+
+    /**
+     * Keeps the sorted \p numbers of the cells in \p range .
+     * \see sortedNumbers()
+     */
+    void setSortedNumbers(const KCSheet* sheet, const QRect& range, const QVector<double>& numbers);
+
+    /**
+     * Searches the cells matching \p cond like KCValueCalc::matches() does.
+     *
+     * Like the sorted numbers, the index of the cells is only built from the
+     * second request for the same cells on.
+     *
+     * \param values the values of \p range as array
+     * \param positions the positions of the matching cells in \p values in
+     * row-major order, sorted ascending; may be zero, if only their number is needed
+     * \return the number of matching cells or -1, if the index is not available
+     */
+    int criteriaMatches(const KCSheet* sheet, const QRect& range, const KCValue& values,
+                        const Condition& cond, KCValueCalc* calc, QVector<int>* positions);
+
+    /**
+     * Drops the indexes and sorted numbers affected by \p damage .
+     * Called by KCMap for each added damage.
+     */
+    void handleDamage(const KCDamage* damage);
+
+    /**
+     * Drops all indexes and sorted numbers.
+     */
+    void clear();
+
+public Q_SLOTS:
+    /**
+     * Called after a sheet was removed.
+     */
+    void removeSheet(KCSheet *sheet);
+
+private:
+    Q_DISABLE_COPY(KCLookupCache)
+
+    class Private;
+    Private * const d;
+};
+
+#endif // KC_LOOKUP_CACHE
@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include <QHash>
 #include <QTimer>
 
 #include <kcodecs.h>
@@ -54,6 +55,7 @@
 #include "KCDocBase.h"
 #include "KCLoadingInfo.h"
 #include "KCLocalization.h"
+#include "KCLookupCache.h"
 #include "KCNamedAreaManager.h"
 #include "KCOdfLoadingContext.h"
 #include "KCOdfSavingContext.h"
@@ -93,7 +95,10 @@ public:
 
     KCBindingManager* bindingManager;
     DatabaseManager* databaseManager;
+    // the binding changes kept back until the recalculation finished
+    KCRegion pendingBindingRegion;
     KCDependencyManager* dependencyManager;
+    KCLookupCache* lookupCache;
     KCNamedAreaManager* namedAreaManager;
     KCRecalcManager* recalcManager;
     KCStyleManager* styleManager;
@@ -111,6 +116,8 @@ public:
     KCRowFormat* defaultRowFormat;
 
     QList<KCDamage*> damages;
+    int damageCount;
+    int damageBatches;
     bool isLoading;
 
     int syntaxVersion;
@@ -134,6 +141,7 @@ KCMap::KCMap(KCDocBase* doc, int syntaxVersion)
     d->bindingManager = new KCBindingManager(this);
     d->databaseManager = new DatabaseManager(this);
     d->dependencyManager = new KCDependencyManager(this);
+    d->lookupCache = new KCLookupCache(this);
     d->namedAreaManager = new KCNamedAreaManager(this);
     d->recalcManager = new KCRecalcManager(this);
     d->styleManager = new KCStyleManager();
@@ -155,6 +163,8 @@ KCMap::KCMap(KCDocBase* doc, int syntaxVersion)
     d->defaultColumnFormat->setWidth((font.pointSizeF() + 4) * 5);
 
     d->isLoading = false;
+    d->damageCount = 0;
+    d->damageBatches = 0;
 
     // default document properties
     d->syntaxVersion = syntaxVersion;
@@ -167,6 +177,8 @@ KCMap::KCMap(KCDocBase* doc, int syntaxVersion)
             d->dependencyManager, SLOT(removeSheet(KCSheet*)));
     connect(this, SIGNAL(sheetRemoved(KCSheet*)),
             d->recalcManager, SLOT(removeSheet(KCSheet*)));
+    connect(this, SIGNAL(sheetRemoved(KCSheet*)),
+            d->lookupCache, SLOT(removeSheet(KCSheet*)));
     connect(this, SIGNAL(sheetRevived(KCSheet*)),
             d->dependencyManager, SLOT(addSheet(KCSheet*)));
     connect(this, SIGNAL(sheetRevived(KCSheet*)),
@@ -193,6 +205,7 @@ KCMap::~KCMap()
     delete d->bindingManager;
     delete d->databaseManager;
     delete d->dependencyManager;
+    delete d->lookupCache;
     delete d->namedAreaManager;
     delete d->recalcManager;
     delete d->styleManager;
@@ -259,6 +272,11 @@ KCDependencyManager* KCMap::dependencyManager() const
     return d->dependencyManager;
 }
 
+KCLookupCache* KCMap::lookupCache() const
+{
+    return d->lookupCache;
+}
+
 KCNamedAreaManager* KCMap::namedAreaManager() const
 {
     return d->namedAreaManager;
@@ -874,16 +892,90 @@ void KCMap::addDamage(KCDamage* damage)
 #endif
 
     d->damages.append(damage);
+    if (damage->type() != KCDamage::DamagedSelection)
+        ++d->damageCount;
+    // The lookup indexes have to be up to date even within a recalculation.
+    d->lookupCache->handleDamage(damage);
 
     if (d->damages.count() == 1) {
         QTimer::singleShot(0, this, SLOT(flushDamages()));
     }
 }
 
+int KCMap::damageCount() const
+{
+    return d->damageCount;
+}
+
+void KCMap::beginDamageBatch()
+{
+    ++d->damageBatches;
+}
+
+void KCMap::endDamageBatch()
+{
+    Q_ASSERT(d->damageBatches > 0);
+    if (--d->damageBatches == 0 && !d->damages.isEmpty()) {
+        QTimer::singleShot(0, this, SLOT(flushDamages()));
+    }
+}
+
+/**
+ * Merges the cell damages of the same sheet and with the same changes into
+ * one damage of the united regions. Only cell damages, that are not separated
+ * by other kinds of damages, are merged; the order of the others is kept.
+ * The merged damages are deleted.
+ */
+static QList<KCDamage*> coalesceDamages(const QList<KCDamage*>& damages)
+{
+    typedef QPair<KCSheet*, int> Key;
+    QList<KCDamage*> result;
+    // the cell damages since the last damage of another kind
+    QList<Key> keys;
+    QHash<Key, QList<KCCellDamage*> > cellDamages;
+    for (int i = 0; i <= damages.count(); ++i) {
+        if (i < damages.count() && damages[i]->type() == KCDamage::DamagedCell) {
+            KCCellDamage* const damage = static_cast<KCCellDamage*>(damages[i]);
+            const Key key(damage->sheet(), damage->changes());
+            if (!cellDamages.contains(key)) {
+                keys.append(key);
+            }
+            cellDamages[key].append(damage);
+            continue;
+        }
+        for (int k = 0; k < keys.count(); ++k) {
+            const QList<KCCellDamage*> merged = cellDamages.value(keys[k]);
+            if (merged.count() == 1) {
+                result.append(merged.first());
+                continue;
+            }
+            QVector<const KCRegion*> regions;
+            regions.reserve(merged.count());
+            for (int j = 0; j < merged.count(); ++j) {
+                regions.append(&merged[j]->region());
+            }
+            KCSheet* const sheet = keys[k].first;
+            const KCRegion region = KCRegion::united(regions, sheet);
+            result.append(new KCCellDamage(sheet, region, merged.first()->changes()));
+            qDeleteAll(merged);
+        }
+        keys.clear();
+        cellDamages.clear();
+        if (i < damages.count()) {
+            result.append(damages[i]);
+        }
+    }
+    return result;
+}
+
 void KCMap::flushDamages()
 {
+    // Keep the damages back until the batch is finished.
+    if (d->damageBatches > 0) {
+        return;
+    }
     // Copy the damages to process. This allows new damages while processing.
-    QList<KCDamage*> damages = d->damages;
+    QList<KCDamage*> damages = coalesceDamages(d->damages);
     d->damages.clear();
     emit damagesFlushed(damages);
     qDeleteAll(damages);
@@ -977,11 +1069,24 @@ void KCMap::handleDamages(const QList<KCDamage*>& damages)
     if (workbookChanges.testFlag(KCWorkbookDamage::KCValue)) {
         d->recalcManager->recalcMap();
         d->bindingManager->updateAllBindings();
+        d->databaseManager->updateAllDataPilots();
+    }
+    // Update the bindings and the data pilot tables once per recalculation.
+    // The recalculation started above queued the damages of the recalculated
+    // cells for the next flush; the bindings are updated with those together.
+    d->pendingBindingRegion.add(bindingChangedRegion);
+    if (d->pendingBindingRegion.isEmpty()) {
+        return;
     }
-    // Update the bindings
-    if (!bindingChangedRegion.isEmpty()) {
-        d->bindingManager->regionChanged(bindingChangedRegion);
+    for (int i = 0; i < d->damages.count(); ++i) {
+        if (d->damages[i]->type() == KCDamage::DamagedCell) {
+            return;
+        }
     }
+    const KCRegion changedRegion = d->pendingBindingRegion;
+    d->pendingBindingRegion.clear();
+    d->bindingManager->regionChanged(changedRegion);
+    d->databaseManager->regionChanged(changedRegion);
 }
 
 void KCMap::addCommand(QUndoCommand *command)
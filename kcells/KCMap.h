@@ -56,6 +56,7 @@ class KCColumnFormat;
 class KCDamage;
 class DatabaseManager;
 class KCDependencyManager;
+class KCLookupCache;
 class KCDocBase;
 class KCLoadingInfo;
 class KCNamedAreaManager;
@@ -121,6 +122,11 @@ public:
      */
     KCDependencyManager* dependencyManager() const;
 
+    /**
+     * \return a pointer to the lookup cache
+     */
+    KCLookupCache* lookupCache() const;
+
     /**
      * \return a pointer to the named area manager
      */
@@ -344,6 +350,29 @@ public:
      */
     void addDamage(KCDamage* damage);
 
+    /**
+     * \ingroup Damages
+     * \return a number that changes every time a damage other than a selection damage is added
+     * Caches of results that depend on the cell contents use it to know when they are outdated.
+     */
+    int damageCount() const;
+
+    /**
+     * \ingroup Damages
+     * Starts a batch of changes, e.g. the ones of a command touching many cells.
+     * The added damages are kept back until the batch ends. Then, the cell
+     * damages are merged and flushed at once, so that the dependencies, the
+     * recalculation and the repainting are processed once for the whole batch.
+     * Batches may be nested; each call has to be matched by endDamageBatch().
+     */
+    void beginDamageBatch();
+
+    /**
+     * \ingroup Damages
+     * Ends a batch of changes started by beginDamageBatch().
+     */
+    void endDamageBatch();
+
     /**
      * Return a pointer to the resource manager associated with the
      * document. The resource manager contains
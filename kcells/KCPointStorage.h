@@ -846,6 +846,89 @@ public:
         return subStorage;
     }
 
+    /**
+     * Retrieves the non-default data in \p rect in one pass over its rows.
+     * Unlike subStorage(), it does not build a new storage, which makes it
+     * the cheaper choice for reading large cell ranges at once.
+     * \return the positions and data in \p rect in row-major order
+     */
+    QVector< QPair<QPoint, T> > dataInRect(const QRect& rect) const {
+        QVector< QPair<QPoint, T> > result;
+        const int bottom = qMin(rect.bottom(), m_rows.count());
+        for (int row = rect.top(); row <= bottom; ++row) {
+            const QVector<int>::const_iterator cstart(m_cols.begin() + m_rows.value(row - 1));
+            const QVector<int>::const_iterator cend((row < m_rows.count()) ? (m_cols.begin() + m_rows.value(row)) : m_cols.end());
+            QVector<int>::const_iterator cit = qLowerBound(cstart, cend, rect.left());
+            for (; cit != cend && *cit <= rect.right(); ++cit)
+                result.append(qMakePair(QPoint(*cit, row), m_data.value(cit - m_cols.begin())));
+        }
+        return result;
+    }
+
+    /**
+     * Replaces the data in \p rect by \p data in a single pass over the storage.
+     * Inserting many items one by one costs a shift of the following row offsets
+     * for each of them; this is the cheaper choice for filling large cell ranges.
+     * \param data the positions and data in row-major order; all positions
+     * have to be within \p rect
+     * \return the replaced data in row-major order
+     */
+    QVector< QPair<QPoint, T> > setDataInRect(const QRect& rect, const QVector< QPair<QPoint, T> >& data) {
+        Q_ASSERT(1 <= rect.left() && rect.right() <= KS_colMax);
+        Q_ASSERT(1 <= rect.top() && rect.bottom() <= KS_rowMax);
+        QVector< QPair<QPoint, T> > oldData;
+        // nothing to replace and nothing to insert?
+        if (data.isEmpty() && rect.top() > m_rows.count())
+            return oldData;
+
+        const int rowCount = qMax(m_rows.count(), data.isEmpty() ? 0 : data.last().first.y());
+        QVector<int> rows;
+        QVector<int> cols;
+        QVector<T> values;
+        rows.reserve(rowCount);
+        cols.reserve(m_cols.count() + data.count());
+        values.reserve(m_data.count() + data.count());
+
+        int index = 0; // the next item in data
+        for (int row = 1; row <= rowCount; ++row) {
+            rows.append(cols.count());
+            const int begin = (row <= m_rows.count()) ? m_rows.value(row - 1) : m_data.count();
+            const int end = (row < m_rows.count()) ? m_rows.value(row) : m_data.count();
+            // rows outside rect are taken as they are
+            if (row < rect.top() || row > rect.bottom()) {
+                cols += m_cols.mid(begin, end - begin);
+                values += m_data.mid(begin, end - begin);
+                continue;
+            }
+            int i = begin;
+            for (; i < end && m_cols.value(i) < rect.left(); ++i) {
+                cols.append(m_cols.value(i));
+                values.append(m_data.value(i));
+            }
+            for (; i < end && m_cols.value(i) <= rect.right(); ++i)
+                oldData.append(qMakePair(QPoint(m_cols.value(i), row), m_data.value(i)));
+            for (; index < data.count() && data[index].first.y() == row; ++index) {
+                Q_ASSERT(rect.contains(data[index].first));
+                cols.append(data[index].first.x());
+#ifdef KCELLS_POINT_STORAGE_HASH
+                values.append(*m_usedData.insert(data[index].second));
+#else
+                values.append(data[index].second);
+#endif
+            }
+            for (; i < end; ++i) {
+                cols.append(m_cols.value(i));
+                values.append(m_data.value(i));
+            }
+        }
+        Q_ASSERT(index == data.count());
+        m_rows = rows;
+        m_cols = cols;
+        m_data = values;
+        squeezeRows();
+        return oldData;
+    }
+
     /**
      * Equality operator.
      */
@@ -20,10 +20,14 @@
 // Local
 #include "KCRegion.h"
 
-#include <QRegExp>
+#include <QAtomicPointer>
+#include <QCache>
+#include <QMap>
+#include <QMutex>
 #include <QStringList>
 
 #include <kdebug.h>
+#include <kglobal.h>
 
 #include "KCCell.h"
 #include "kcells_limits.h"
@@ -33,18 +37,235 @@
 #include "Util.h"
 
 
+/**
+ * The cells of a region as disjoint ranges per sheet.
+ * The ranges of a sheet form bands: ranges with the same top row also have
+ * the same bottom row, the bands do not overlap and are sorted from top to
+ * bottom. Within a band, the ranges are sorted from left to right.
+ */
+typedef QMap<KCSheet*, QVector<QRect> > CompactRanges;
+
 class KCRegion::Private : public QSharedData
 {
 public:
     Private()
             : map(0),
-            cells(QList<Element*>()) {
+            cells(QList<Element*>()),
+            compact(0) {
+    }
+    Private(const Private& other)
+            : QSharedData(other),
+            map(other.map),
+            cells(other.cells),
+            compact(0) {
+    }
+    ~Private() {
+        delete static_cast<const CompactRanges*>(compact);
+    }
+
+    /**
+     * \return the compacted ranges; built on the first call after a change
+     */
+    const CompactRanges& compactRanges() const;
+
+    /**
+     * Drops the compacted ranges. Has to be called on each change.
+     */
+    void changed() const {
+        delete static_cast<const CompactRanges*>(compact);
+        compact = 0;
     }
 
     const KCMap* map;
     mutable QList<Element*> cells;
+    // Built on demand; atomic, because concurrent readers may build it.
+    mutable QAtomicPointer<const CompactRanges> compact;
 };
 
+static bool lessTop(const QRect& rect1, const QRect& rect2)
+{
+    return rect1.top() < rect2.top();
+}
+
+static bool lessBottom(const QRect& rect1, const QRect& rect2)
+{
+    return rect1.bottom() < rect2.bottom();
+}
+
+static bool lessLeft(const QRect& rect1, const QRect& rect2)
+{
+    return rect1.left() < rect2.left();
+}
+
+/**
+ * Turns possibly overlapping \p rects into bands of disjoint ranges.
+ * The rows are swept from top to bottom. Whenever a range starts or ends,
+ * the column intervals of the ranges covering the rows up to the next such
+ * event are merged into a new band, unless they equal the ones of the band
+ * above, which is then extended.
+ */
+static QVector<QRect> compactRects(QVector<QRect> rects)
+{
+    QVector<QRect> result;
+    if (rects.isEmpty()) {
+        return result;
+    }
+    QVector<int> rows;
+    rows.reserve(2 * rects.count());
+    for (int i = 0; i < rects.count(); ++i) {
+        rows.append(rects[i].top());
+        rows.append(rects[i].bottom() + 1);
+    }
+    qSort(rows);
+    qStableSort(rects.begin(), rects.end(), lessTop);
+
+    QVector<QRect> active;
+    QVector<QPair<int, int> > intervals;
+    QVector<QPair<int, int> > lastIntervals;
+    int lastBandStart = 0;
+    int lastBottom = -1;
+    int next = 0;
+    for (int r = 0; r < rows.count() - 1; ++r) {
+        const int top = rows[r];
+        const int bottom = rows[r + 1] - 1;
+        if (bottom < top) {
+            continue; // duplicate row
+        }
+        // Update the ranges covering the rows of the band.
+        for (int i = active.count() - 1; i >= 0; --i) {
+            if (active[i].bottom() < top) {
+                active.remove(i);
+            }
+        }
+        for (; next < rects.count() && rects[next].top() == top; ++next) {
+            active.append(rects[next]);
+        }
+        // Merge the column intervals.
+        intervals.clear();
+        qSort(active.begin(), active.end(), lessLeft);
+        for (int i = 0; i < active.count(); ++i) {
+            if (!intervals.isEmpty() && active[i].left() <= intervals.last().second + 1) {
+                intervals.last().second = qMax(intervals.last().second, active[i].right());
+            } else {
+                intervals.append(qMakePair(active[i].left(), active[i].right()));
+            }
+        }
+        if (intervals.isEmpty()) {
+            lastIntervals.clear();
+            continue;
+        }
+        if (lastBottom == top - 1 && intervals == lastIntervals) {
+            // Extend the band above.
+            for (int i = lastBandStart; i < result.count(); ++i) {
+                result[i].setBottom(bottom);
+            }
+        } else {
+            lastBandStart = result.count();
+            for (int i = 0; i < intervals.count(); ++i) {
+                result.append(QRect(QPoint(intervals[i].first, top), QPoint(intervals[i].second, bottom)));
+            }
+            lastIntervals = intervals;
+        }
+        lastBottom = bottom;
+    }
+    return result;
+}
+
+/**
+ * \return the band of \p rects , that covers \p row , as index range [\p begin , \p end )
+ */
+static bool findBand(const QVector<QRect>& rects, int row, int* begin, int* end)
+{
+    const QRect key(QPoint(1, row), QPoint(1, row));
+    // The bands do not overlap. So, the bottom rows are sorted, too.
+    const QVector<QRect>::ConstIterator it = qLowerBound(rects.constBegin(), rects.constEnd(), key, lessBottom);
+    if (it == rects.constEnd() || it->top() > row) {
+        return false;
+    }
+    *begin = it - rects.constBegin();
+    *end = qUpperBound(it, rects.constEnd(), *it, lessTop) - rects.constBegin();
+    return true;
+}
+
+static bool bandsContain(const QVector<QRect>& rects, const QPoint& point)
+{
+    int begin;
+    int end;
+    if (!findBand(rects, point.y(), &begin, &end)) {
+        return false;
+    }
+    const QRect key(point, point);
+    // the last range starting left of the point
+    QVector<QRect>::ConstIterator it = qUpperBound(rects.constBegin() + begin, rects.constBegin() + end, key, lessLeft);
+    if (it == rects.constBegin() + begin) {
+        return false;
+    }
+    return (--it)->right() >= point.x();
+}
+
+/**
+ * Appends the intersections of the bands \p rects1 and \p rects2 to \p result .
+ */
+static void intersectBands(const QVector<QRect>& rects1, const QVector<QRect>& rects2, QVector<QRect>* result)
+{
+    for (int i = 0; i < rects2.count(); ++i) {
+        const QRect& rect = rects2[i];
+        QVector<QRect>::ConstIterator it = qLowerBound(rects1.constBegin(), rects1.constEnd(),
+                                                       QRect(QPoint(1, rect.top()), QPoint(1, rect.top())), lessBottom);
+        for (; it != rects1.constEnd() && it->top() <= rect.bottom(); ++it) {
+            const QRect intersection = *it & rect;
+            if (intersection.isValid()) {
+                result->append(intersection);
+            }
+        }
+    }
+}
+
+/**
+ * The cell references parsed before. The same references are parsed again
+ * and again, e.g. while loading the formulas of a filled column.
+ */
+class PointCache
+{
+public:
+    PointCache() : points(16384) {}
+    QMutex mutex;
+    QCache<QString, KCRegion::Point> points;
+};
+K_GLOBAL_STATIC(PointCache, s_pointCache)
+
+static KCRegion::Point parsedPoint(const QString& string)
+{
+    QMutexLocker locker(&s_pointCache->mutex);
+    if (const KCRegion::Point* point = s_pointCache->points.object(string)) {
+        return *point;
+    }
+    KCRegion::Point* point = new KCRegion::Point(string);
+    s_pointCache->points.insert(string, point);
+    return *point;
+}
+
+const CompactRanges& KCRegion::Private::compactRanges() const
+{
+    const CompactRanges* ranges = compact;
+    if (ranges) {
+        return *ranges;
+    }
+    CompactRanges* newRanges = new CompactRanges();
+    for (int i = 0; i < cells.count(); ++i) {
+        (*newRanges)[cells[i]->sheet()].append(cells[i]->rect());
+    }
+    CompactRanges::Iterator end(newRanges->end());
+    for (CompactRanges::Iterator it(newRanges->begin()); it != end; ++it) {
+        it.value() = compactRects(it.value());
+    }
+    // Another reader may have been faster.
+    if (!compact.testAndSetOrdered(0, newRanges)) {
+        delete newRanges;
+    }
+    return *static_cast<const CompactRanges*>(compact);
+}
+
 
 /***************************************************************************
   class KCRegion
@@ -106,8 +327,8 @@ KCRegion::KCRegion(const QString& string, const KCMap* map, KCSheet* fallbackShe
             if (!lastSheet)
                 lastSheet = fallbackSheet;
 
-            Point ul(sUL);
-            Point lr(sLR);
+            const Point ul = parsedPoint(sUL);
+            const Point lr = parsedPoint(sLR);
 
             if (ul.isValid() && lr.isValid()) {
                 Range* range = createRange(ul, lr);
@@ -130,7 +351,7 @@ KCRegion::KCRegion(const QString& string, const KCMap* map, KCSheet* fallbackShe
                 return;
             if (!sheet)
                 sheet = fallbackSheet;
-            Point* point = createPoint(sRegion);
+            Point* point = createPoint(parsedPoint(sRegion));
             if(sheet) point->setSheet(sheet);
             d->cells.append(point);
         }
@@ -306,6 +527,7 @@ void KCRegion::sub(const QPoint& point, KCSheet* sheet)
         if (element->rect() == QRect(point, point)) {
             delete element;
             d->cells.removeAll(element);
+            d->changed();
             break;
         }
     }
@@ -324,6 +546,7 @@ void KCRegion::sub(const QRect& range, KCSheet* sheet)
         if (element->rect() == normalizedRange) {
             delete element;
             d->cells.removeAll(element);
+            d->changed();
             break;
         }
     }
@@ -346,23 +569,66 @@ void KCRegion::sub(const KCRegion& region)
 KCRegion KCRegion::intersected(const KCRegion& region) const
 {
     KCRegion result;
-    ConstIterator end(region.constEnd());
-    for (ConstIterator it = region.constBegin(); it != end; ++it) {
-        Element *element = *it;
-        if (element->type() == Element::Point) {
-            Point* point = static_cast<Point*>(element);
-            if(contains(point->pos(), element->sheet()))
-                result.add(point->pos(), element->sheet());
+    if (isEmpty() || region.isEmpty()) {
+        return result;
+    }
+    const CompactRanges& ranges = d->compactRanges();
+    const CompactRanges& otherRanges = region.d->compactRanges();
+    CompactRanges::ConstIterator end(otherRanges.constEnd());
+    for (CompactRanges::ConstIterator it(otherRanges.constBegin()); it != end; ++it) {
+        QVector<QRect> rects;
+        if (it.key()) {
+            intersectBands(ranges.value(it.key()), it.value(), &rects);
         } else {
-            QRect rect = element->rect();
-            for(int c = rect.top(); c <= rect.bottom(); ++c) {
-                for(int r = rect.left(); r <= rect.right(); ++r) {
-                    QPoint p(r,c);
-                    if(contains(p, element->sheet()))
-                        result.add(p, element->sheet());
-                }
+            // no sheet; matches all sheets
+            CompactRanges::ConstIterator end2(ranges.constEnd());
+            for (CompactRanges::ConstIterator it2(ranges.constBegin()); it2 != end2; ++it2) {
+                intersectBands(it2.value(), it.value(), &rects);
             }
         }
+        rects = compactRects(rects);
+        for (int i = 0; i < rects.count(); ++i) {
+            result.insert(result.d->cells.count(), rects[i], it.key(), true);
+        }
+    }
+    return result;
+}
+
+KCRegion KCRegion::compacted() const
+{
+    KCRegion result;
+    result.d->map = d->map;
+    if (isEmpty()) {
+        return result;
+    }
+    const CompactRanges& ranges = d->compactRanges();
+    CompactRanges::ConstIterator end(ranges.constEnd());
+    for (CompactRanges::ConstIterator it(ranges.constBegin()); it != end; ++it) {
+        const QVector<QRect>& rects = it.value();
+        for (int i = 0; i < rects.count(); ++i) {
+            result.insert(result.d->cells.count(), rects[i], it.key(), true);
+        }
+    }
+    return result;
+}
+
+// static
+KCRegion KCRegion::united(const QVector<const KCRegion*>& regions, KCSheet* sheet)
+{
+    CompactRanges ranges;
+    for (int i = 0; i < regions.count(); ++i) {
+        ConstIterator end(regions[i]->d->cells.constEnd());
+        for (ConstIterator it(regions[i]->d->cells.constBegin()); it != end; ++it) {
+            ranges[(*it)->sheet() ? (*it)->sheet() : sheet].append((*it)->rect());
+        }
+    }
+    KCRegion result;
+    CompactRanges::ConstIterator end(ranges.constEnd());
+    for (CompactRanges::ConstIterator it(ranges.constBegin()); it != end; ++it) {
+        const QVector<QRect> rects = compactRects(it.value());
+        for (int i = 0; i < rects.count(); ++i) {
+            result.insert(result.d->cells.count(), rects[i], it.key(), true);
+        }
     }
     return result;
 }
@@ -398,6 +664,7 @@ KCRegion::Element* KCRegion::eor(const QPoint& point, KCSheet* sheet)
             continue;
         }
         containsPoint = true;
+        d->changed();
         int x = point.x();
         int y = point.y();
         QRect fullRange = d->cells[index]->rect();
@@ -450,7 +717,9 @@ KCRegion::Element* KCRegion::insert(int pos, const QPoint& point, KCSheet* sheet
         return 0;
     }
     // Keep boundaries.
-    pos = qBound(0, pos, cells().count());
+    pos = qBound(0, pos, d->cells.count());
+
+    d->changed();
 
     bool containsPoint = false;
 //   bool adjacentPoint = false;
@@ -498,13 +767,15 @@ KCRegion::Element* KCRegion::insert(int pos, const QPoint& point, KCSheet* sheet
 KCRegion::Element* KCRegion::insert(int pos, const QRect& range, KCSheet* sheet, bool multi)
 {
     // Keep boundaries.
-    pos = qBound(0, pos, cells().count());
+    pos = qBound(0, pos, d->cells.count());
 
     const QRect normalizedRange = normalized(range);
     if (normalizedRange.size() == QSize(1, 1)) {
         return insert(pos, normalizedRange.topLeft(), sheet);
     }
 
+    d->changed();
+
     if (multi) {
         Range* rrange = createRange(normalizedRange);
         rrange->setSheet(sheet);
@@ -527,7 +798,7 @@ KCRegion::Element* KCRegion::insert(int pos, const QRect& range, KCSheet* sheet,
     }
     if (!containsRange) {
         // Keep boundaries.
-        pos = qBound(0, pos, cells().count());
+        pos = qBound(0, pos, d->cells.count());
 
         Range* rrange = createRange(normalizedRange);
         rrange->setSheet(sheet);
@@ -652,13 +923,24 @@ bool KCRegion::contains(const QPoint& point, KCSheet* sheet) const
     if (d->cells.isEmpty()) {
         return false;
     }
-    ConstIterator endOfList(d->cells.constEnd());
-    for (ConstIterator it = d->cells.constBegin(); it != endOfList; ++it) {
-        Element *element = *it;
-        if (element->contains(point)) {
-            if (sheet && element->sheet() != sheet) {
-                return false;
+    // Not worth to be compacted.
+    if (d->cells.count() <= 8 && !d->compact) {
+        ConstIterator endOfList(d->cells.constEnd());
+        for (ConstIterator it = d->cells.constBegin(); it != endOfList; ++it) {
+            Element *element = *it;
+            if (element->contains(point) && (!sheet || element->sheet() == sheet)) {
+                return true;
             }
+        }
+        return false;
+    }
+    const CompactRanges& ranges = d->compactRanges();
+    if (sheet) {
+        return bandsContain(ranges.value(sheet), point);
+    }
+    CompactRanges::ConstIterator end(ranges.constEnd());
+    for (CompactRanges::ConstIterator it(ranges.constBegin()); it != end; ++it) {
+        if (bandsContain(it.value(), point)) {
             return true;
         }
     }
@@ -674,6 +956,7 @@ void KCRegion::clear()
 {
     qDeleteAll(d->cells);
     d->cells.clear();
+    d->changed();
 }
 
 QRect KCRegion::firstRange() const
@@ -710,8 +993,8 @@ QRect KCRegion::boundingRect() const
     int right  = 1;
     int top    = KS_rowMax;
     int bottom = 1;
-    KCRegion::ConstIterator endOfList = cells().constEnd();
-    for (KCRegion::ConstIterator it = cells().constBegin(); it != endOfList; ++it) {
+    KCRegion::ConstIterator endOfList = d->cells.constEnd();
+    for (KCRegion::ConstIterator it = d->cells.constBegin(); it != endOfList; ++it) {
         QRect range = (*it)->rect();
         if (range.left() < left) {
             left = range.left();
@@ -907,6 +1190,8 @@ QString KCRegion::saveOdf() const
 
 QList<KCRegion::Element*>& KCRegion::cells() const
 {
+    // The caller may change the elements.
+    d->changed();
     return d->cells;
 }
 
@@ -1055,7 +1340,12 @@ KCRegion::Point::Point(const QString& string)
     //default is error
     int x = -1;
     //search for the first character != text
-    int result = string.indexOf(QRegExp("[^A-Za-z]+"), p);
+    int result = p;
+    while (result < (int)length && ((string[result] >= 'A' && string[result] <= 'Z') ||
+                                     (string[result] >= 'a' && string[result] <= 'z')))
+        ++result;
+    if (result == (int)length)
+        result = -1;
 
     //get the column number for the character between actual position and the first non text charakter
     if (result != -1)
@@ -26,6 +26,7 @@
 #include <QSet>
 #include <QSharedDataPointer>
 #include <QString>
+#include <QVector>
 
 #include <kdebug.h>
 
@@ -212,8 +213,10 @@ public:
     QSet<int> rowsAffected() const;
 
     /**
+     * Uses the compacted ranges, that are kept until the region changes.
+     * Hence, repeated lookups in the same region take logarithmic time.
      * @param point the point's location
-     * @param sheet the sheet the point belongs to
+     * @param sheet the sheet the point belongs to; any sheet, if zero
      * @return @c true, if the region contains the point @p point
      */
     bool contains(const QPoint& point, KCSheet* sheet = 0) const;
@@ -266,9 +269,30 @@ public:
     /**
      * Intersects the region @p region and this region and
      * returns the result of the intersection as a new KCRegion.
+     * The result consists of compacted ranges; see compacted().
+     * An element of @p region without a sheet intersects the cells of all sheets.
      */
     KCRegion intersected(const KCRegion& region) const;
 
+    /**
+     * Returns a region covering the same cells with as few ranges as possible:
+     * disjoint ranges, grouped by sheet and sorted by rows, then by columns.
+     * Ranges sharing the same rows are merged, if adjacent, and so are the
+     * ones sharing the same columns. Takes O(n log n) time for n elements
+     * in the usual cases.
+     * The absolute reference markers are not kept.
+     */
+    KCRegion compacted() const;
+
+    /**
+     * Unites the regions @p regions in one go and returns the compacted
+     * result; see compacted(). Unlike adding them one after another, this
+     * does not search the whole result for each added element.
+     * @param regions the regions to unite
+     * @param sheet the fallback sheet used, if an element has no sheet set
+     */
+    static KCRegion united(const QVector<const KCRegion*>& regions, KCSheet* sheet = 0);
+
     /**
      * Intersects this region with the row @p row and returns
      * the result of the intersection as a new KCRegion.
@@ -94,6 +94,8 @@
 #include "KCValueConverter.h"
 #include "KCValueStorage.h"
 
+#include "database/DatabaseManager.h"
+
 
 template<typename T> class IntervalMap
 {
@@ -742,6 +744,7 @@ void KCSheet::insertShiftRight(const QRect& rect)
                                      rect.right() - rect.left() + 1);
         }
     }
+    map()->databaseManager()->insertCells(this, rect, Qt::Horizontal);
 }
 
 void KCSheet::insertShiftDown(const QRect& rect)
@@ -753,6 +756,7 @@ void KCSheet::insertShiftDown(const QRect& rect)
                                      rect.bottom() - rect.top() + 1);
         }
     }
+    map()->databaseManager()->insertCells(this, rect, Qt::Vertical);
 }
 
 void KCSheet::removeShiftUp(const QRect& rect)
@@ -764,6 +768,7 @@ void KCSheet::removeShiftUp(const QRect& rect)
                                      rect.bottom() - rect.top() + 1);
         }
     }
+    map()->databaseManager()->removeCells(this, rect, Qt::Vertical);
 }
 
 void KCSheet::removeShiftLeft(const QRect& rect)
@@ -775,6 +780,7 @@ void KCSheet::removeShiftLeft(const QRect& rect)
                                      rect.right() - rect.left() + 1);
         }
     }
+    map()->databaseManager()->removeCells(this, rect, Qt::Horizontal);
 }
 
 void KCSheet::insertColumns(int col, int number)
@@ -793,6 +799,7 @@ void KCSheet::insertColumns(int col, int number)
                                  KCSheet::ColumnInsert, sheetName(),
                                  number);
     }
+    map()->databaseManager()->insertCells(this, QRect(col, 1, number, KS_rowMax), Qt::Horizontal);
     //update print settings
     d->print->insertColumn(col, number);
 }
@@ -813,6 +820,7 @@ void KCSheet::insertRows(int row, int number)
                                  KCSheet::RowInsert, sheetName(),
                                  number);
     }
+    map()->databaseManager()->insertCells(this, QRect(1, row, KS_colMax, number), Qt::Vertical);
     //update print settings
     d->print->insertRow(row, number);
 }
@@ -833,6 +841,7 @@ void KCSheet::removeColumns(int col, int number)
                                  KCSheet::ColumnRemove, sheetName(),
                                  number);
     }
+    map()->databaseManager()->removeCells(this, QRect(col, 1, number, KS_rowMax), Qt::Horizontal);
     //update print settings
     d->print->removeColumn(col, number);
 }
@@ -854,6 +863,7 @@ void KCSheet::removeRows(int row, int number)
                                  number);
     }
 
+    map()->databaseManager()->removeCells(this, QRect(1, row, KS_colMax, number), Qt::Vertical);
     //update print settings
     d->print->removeRow(row, number);
 }
@@ -21,6 +21,7 @@
 
 // KCells
 #include "KCBinding.h"
+#include "KCBindingModel.h"
 #include "KCCell.h"
 #include "KCCellStorage.h"
 #include "KCCondition.h"
@@ -82,7 +83,27 @@ QVariant KCSheetModel::data(const QModelIndex& index, int role) const
         }
     }
     // NOTE Model indices start from 0, while KCells column/row indices start from 1.
-    const KCCell cell = KCCell(d->sheet, index.column() + 1, index.row() + 1).masterCell();
+    const int column = index.column() + 1;
+    const int row = index.row() + 1;
+    KCCellStorage *const storage = d->sheet->cellStorage();
+    // The raw cell data does not need the master cell and its style.
+    switch (role) {
+    case UserInputRole:
+        return storage->userInput(column, row);
+    case FormulaRole: {
+        QVariant data;
+        data.setValue(storage->formula(column, row));
+        return data;
+    }
+    case ValueRole: {
+        QVariant data;
+        data.setValue(storage->value(column, row));
+        return data;
+    }
+    case LinkRole:
+        return storage->link(column, row);
+    }
+    const KCCell cell = KCCell(d->sheet, column, row).masterCell();
     const KCStyle style = cell.effectiveStyle();
     if (role == Qt::DisplayRole) {
         // Display a formula if warranted.  If not, simply display the value.
@@ -118,25 +139,6 @@ QVariant KCSheetModel::data(const QModelIndex& index, int role) const
     } else if (role == Qt::ForegroundRole) {
         return style.fontColor();
     }
-    const int column = index.column() + 1;
-    const int row = index.row() + 1;
-    KCCellStorage *const storage = d->sheet->cellStorage();
-    switch (role) {
-    case UserInputRole:
-        return storage->userInput(column, row);
-    case FormulaRole: {
-        QVariant data;
-        data.setValue(storage->formula(column, row));
-        return data;
-    }
-    case ValueRole: {
-        QVariant data;
-        data.setValue(storage->value(column, row));
-        return data;
-    }
-    case LinkRole:
-        return storage->link(column, row);
-    }
     return QVariant();
 }
 
@@ -290,6 +292,16 @@ bool KCSheetModel::setData(const QModelIndex &topLeft, const QModelIndex &bottom
     return setData(QItemSelectionRange(topLeft, bottomRight), value, role);
 }
 
+QVector<KChart::ColumnSlice> KCSheetModel::columnSlices(const QRect& rect) const
+{
+    // NOTE Model indices start from 0, while KCells column/row indices start from 1.
+    const QRect range = rect.translated(1, 1) & QRect(1, 1, KS_colMax, KS_rowMax);
+    if (!range.isValid()) {
+        return QVector<KChart::ColumnSlice>();
+    }
+    return KCBindingModel::readColumns(d->sheet, range);
+}
+
 KCSheet* KCSheetModel::sheet() const
 {
     return d->sheet;
@@ -22,6 +22,8 @@
 
 #include <QAbstractTableModel>
 
+#include "interfaces/KChartModel.h"
+
 #include "kcells_export.h"
 
 class QItemSelectionRange;
@@ -32,7 +34,7 @@ class KCSheet;
  * A model for a sheet.
  * \ingroup Model
  */
-class KCELLS_EXPORT KCSheetModel : public QAbstractTableModel
+class KCELLS_EXPORT KCSheetModel : public QAbstractTableModel, public KChart::ChartBulkModel
 {
 public:
     explicit KCSheetModel(KCSheet* sheet);
@@ -51,6 +53,9 @@ public:
     bool setData(const QModelIndex &topLeft, const QModelIndex &bottomRight,
                  const QVariant &value, int role = Qt::EditRole);
 
+    // KChart::ChartBulkModel interface
+    virtual QVector<KChart::ColumnSlice> columnSlices(const QRect& rect) const;
+
 protected:
     KCSheet* sheet() const;
 
@@ -21,9 +21,9 @@
 // Local
 #include "KCStyleStorage.h"
 
-#include <QCache>
 #include <QRegion>
 #include <QTimer>
+#include <QVector>
 
 #include "Global.h"
 #include "KCMap.h"
@@ -34,10 +34,38 @@
 #include "KCRectStorage.h"
 
 static const int g_maximumCachedStyles = 10000;
+// how many columns left and right of a looked up cell are checked for the same substyles
+static const int g_cachedRunRadius = 64;
+
+static uint qHash(const QList<KCSharedSubStyle>& subStyles)
+{
+    uint hash = 0;
+    for (int i = 0; i < subStyles.count(); ++i)
+        hash = hash * 31 + qHash(subStyles[i].data());
+    return hash;
+}
 
 class KDE_NO_EXPORT KCStyleStorage::Private
 {
 public:
+    Private() : cachedRunCount(0) {}
+
+    /**
+     * A range of columns in a row, which all have the same composed style.
+     */
+    struct StyleRun {
+        int left;
+        int right;
+        int styleId; // the index in composedStyles
+    };
+
+    /// \return the index of the cached run in \p runs containing \p column , or -1
+    static int runIndex(const QVector<StyleRun>& runs, int column);
+    /// caches \p styleId for the columns from \p left to \p right in \p row
+    void insertRun(int row, int left, int right, int styleId);
+    /// removes the cached runs in \p rect
+    void removeRuns(const QRect& rect);
+
     KCMap* map;
     KCRTree<KCSharedSubStyle> tree;
     QMap<int, bool> usedColumns; // FIXME Stefan: Use QList and qUpperBound() for insertion.
@@ -45,16 +73,103 @@ public:
     QRegion usedArea;
     QHash<KCStyle::Key, QList<KCSharedSubStyle> > subStyles;
     QMap<int, QPair<QRectF, KCSharedSubStyle> > possibleGarbage;
-    QCache<QPoint, KCStyle> cache;
-    QRegion cachedArea;
+    // each distinct list of substyles is composed only once and gets an id
+    QVector<KCStyle> composedStyles;
+    QHash<QList<KCSharedSubStyle>, int> styleIds;
+    // the ids of the cached styles, as runs of columns for each row
+    QMap<int, QVector<StyleRun> > cachedRuns;
+    int cachedRunCount;
 };
 
+int KCStyleStorage::Private::runIndex(const QVector<StyleRun>& runs, int column)
+{
+    int low = 0;
+    int high = runs.count();
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (runs[middle].right < column)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low < runs.count() && runs[low].left <= column)
+        return low;
+    return -1;
+}
+
+void KCStyleStorage::Private::insertRun(int row, int left, int right, int styleId)
+{
+    QVector<StyleRun>& runs = cachedRuns[row];
+    // find the first run after the new one
+    int index = 0;
+    while (index < runs.count() && runs[index].right < left)
+        ++index;
+    // do not overlap the neighbours
+    if (index > 0)
+        left = qMax(left, runs[index - 1].right + 1);
+    if (index < runs.count())
+        right = qMin(right, runs[index].left - 1);
+    if (left > right)
+        return;
+    // merge with the neighbours, if they have the same style
+    if (index > 0 && runs[index - 1].styleId == styleId && runs[index - 1].right + 1 == left) {
+        runs[index - 1].right = right;
+        if (index < runs.count() && runs[index].styleId == styleId && runs[index].left == right + 1) {
+            runs[index - 1].right = runs[index].right;
+            runs.remove(index);
+            --cachedRunCount;
+        }
+        return;
+    }
+    if (index < runs.count() && runs[index].styleId == styleId && runs[index].left == right + 1) {
+        runs[index].left = left;
+        return;
+    }
+    StyleRun run;
+    run.left = left;
+    run.right = right;
+    run.styleId = styleId;
+    runs.insert(index, run);
+    ++cachedRunCount;
+}
+
+void KCStyleStorage::Private::removeRuns(const QRect& rect)
+{
+    QMap<int, QVector<StyleRun> >::iterator it = cachedRuns.lowerBound(rect.top());
+    while (it != cachedRuns.end() && it.key() <= rect.bottom()) {
+        QVector<StyleRun> runs;
+        foreach (const StyleRun& run, it.value()) {
+            if (run.right < rect.left() || run.left > rect.right()) {
+                runs.append(run);
+                continue;
+            }
+            // keep the parts outside of rect
+            if (run.left < rect.left()) {
+                StyleRun part = run;
+                part.right = rect.left() - 1;
+                runs.append(part);
+            }
+            if (run.right > rect.right()) {
+                StyleRun part = run;
+                part.left = rect.right() + 1;
+                runs.append(part);
+            }
+        }
+        cachedRunCount += runs.count() - it.value().count();
+        if (runs.isEmpty())
+            it = cachedRuns.erase(it);
+        else {
+            it.value() = runs;
+            ++it;
+        }
+    }
+}
+
 KCStyleStorage::KCStyleStorage(KCMap* map)
         : QObject(map)
         , d(new Private)
 {
     d->map = map;
-    d->cache.setMaxCost(g_maximumCachedStyles);
 }
 
 KCStyleStorage::KCStyleStorage(const KCStyleStorage& other)
@@ -80,22 +195,55 @@ KCStyle KCStyleStorage::contains(const QPoint& point) const
     if (!d->usedArea.contains(point) && !d->usedColumns.contains(point.x()) && !d->usedRows.contains(point.y()))
         return *styleManager()->defaultStyle();
     // first, lookup point in the cache
-    if (d->cache.contains(point)) {
-//         kDebug(36006) <<"KCStyleStorage: Using cached style for" << cellName;
-        return *d->cache.object(point);
+    QMap<int, QVector<Private::StyleRun> >::const_iterator row = d->cachedRuns.constFind(point.y());
+    if (row != d->cachedRuns.constEnd()) {
+        const int index = Private::runIndex(row.value(), point.x());
+        if (index != -1) {
+//             kDebug(36006) <<"KCStyleStorage: Using cached style for" << cellName;
+            return d->composedStyles[row.value()[index].styleId];
+        }
     }
     // not found, lookup in the tree
     QList<KCSharedSubStyle> subStyles = d->tree.contains(point);
 
-    if (subStyles.isEmpty())
-        return *styleManager()->defaultStyle();
-    KCStyle* style = new KCStyle();
-    (*style) = composeStyle(subStyles);
+    // compose each distinct list of substyles only once
+    int styleId;
+    QHash<QList<KCSharedSubStyle>, int>::const_iterator it = d->styleIds.constFind(subStyles);
+    if (it != d->styleIds.constEnd())
+        styleId = it.value();
+    else {
+        if (d->composedStyles.count() >= g_maximumCachedStyles)
+            const_cast<KCStyleStorage*>(this)->invalidateCache();
+        styleId = d->composedStyles.count();
+        d->composedStyles.append(composeStyle(subStyles));
+        d->styleIds.insert(subStyles, styleId);
+    }
+
+    // The neighbouring columns have the same substyles up to the nearest rectangle border.
+    const int x = point.x();
+    int left = qMax(1, x - g_cachedRunRadius);
+    int right = qMin(KS_colMax, x + g_cachedRunRadius);
+    const QRect rowRect(left, point.y(), right - left + 1, 1);
+    const QList< QPair<QRectF, KCSharedSubStyle> > pairs = d->tree.intersectingPairs(rowRect).values();
+    for (int i = 0; i < pairs.count(); ++i) {
+        const QRect rect = pairs[i].first.toRect();
+        if (rect.right() < x)
+            left = qMax(left, rect.right() + 1);
+        else if (rect.left() > x)
+            right = qMin(right, rect.left() - 1);
+        else {
+            left = qMax(left, rect.left());
+            right = qMin(right, rect.right());
+        }
+    }
 
     // insert style into the cache
-    d->cache.insert(point, style);
-    d->cachedArea += QRect(point, point);
-    return *style;
+    if (d->cachedRunCount >= g_maximumCachedStyles) {
+        d->cachedRuns.clear();
+        d->cachedRunCount = 0;
+    }
+    d->insertRun(point.y(), left, right, styleId);
+    return d->composedStyles[styleId];
 }
 
 KCStyle KCStyleStorage::contains(const QRect& rect) const
@@ -277,8 +425,7 @@ void KCStyleStorage::load(const QList<QPair<QRegion, KCStyle> >& styles)
     d->usedArea = QRegion();
     d->usedColumns.clear();
     d->usedRows.clear();
-    d->cachedArea = QRegion();
-    d->cache.clear();
+    invalidateCache();
     typedef QPair<QRegion, KCStyle> StyleRegion;
     foreach (const StyleRegion& styleArea, styles) {
         const QRegion& reg = styleArea.first;
@@ -538,8 +685,10 @@ QList< QPair<QRectF, KCSharedSubStyle> > KCStyleStorage::removeShiftUp(const QRe
 
 void KCStyleStorage::invalidateCache()
 {
-    d->cache.clear();
-    d->cachedArea = QRegion();
+    d->cachedRuns.clear();
+    d->cachedRunCount = 0;
+    d->composedStyles.clear();
+    d->styleIds.clear();
 }
 
 void KCStyleStorage::garbageCollection()
@@ -690,16 +839,8 @@ void KCStyleStorage::regionChanged(const QRect& rect)
 void KCStyleStorage::invalidateCache(const QRect& rect)
 {
 //     kDebug(36006) <<"KCStyleStorage: Invalidating" << rect;
-    const QRegion region = d->cachedArea.intersected(rect);
-    d->cachedArea = d->cachedArea.subtracted(rect);
-    foreach(const QRect& rect, region.rects()) {
-        for (int col = rect.left(); col <= rect.right(); ++col) {
-            for (int row = rect.top(); row <= rect.bottom(); ++row) {
-//                 kDebug(36006) <<"KCStyleStorage: Removing cached style for" << KCCell::name( col, row );
-                d->cache.remove(QPoint(col, row));     // also deletes it
-            }
-        }
-    }
+    // The composed styles stay valid; they only depend on the substyles.
+    d->removeRuns(rect);
 }
 
 KCStyle KCStyleStorage::composeStyle(const QList<KCSharedSubStyle>& subStyles) const
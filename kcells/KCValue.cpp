@@ -674,6 +674,20 @@ const KCValue& KCValue::errorVALUE()
     return ks_error_value;
 }
 
+void KCValue::createErrorValues()
+{
+    errorCIRCLE();
+    errorDEPEND();
+    errorDIV0();
+    errorNA();
+    errorNAME();
+    errorNUM();
+    errorNULL();
+    errorPARSE();
+    errorREF();
+    errorVALUE();
+}
+
 int KCValue::compare(KCNumber v1, KCNumber v2)
 {
     KCNumber v3 = v1 - v2;
@@ -455,6 +455,14 @@ public:
      */
     static const KCValue& errorVALUE();
 
+    /**
+     * Creates all error values.
+     *
+     * They are created on their first use otherwise, which must not happen
+     * concurrently. Call this before evaluating formulas in several threads.
+     */
+    static void createErrorValues();
+
     /**
      * Returns true if it is OK to compare this value with v.
      * If this function returns false, then return value of compare is undefined.
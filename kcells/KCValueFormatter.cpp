@@ -215,10 +215,11 @@ QString KCValueFormatter::removeTrailingZeros(const QString& str, const QString&
         return str;
 
     int start = 0;
-    int cslen = m_converter->settings()->locale()->currencySymbol().length();
+    const QString currencySymbol = settings()->locale()->currencySymbol();
+    const int cslen = currencySymbol.length();
     if (str.indexOf('%') != -1)
         start = 2;
-    else if (str.indexOf(m_converter->settings()->locale()->currencySymbol()) ==
+    else if (str.indexOf(currencySymbol) ==
              ((int)(str.length() - cslen)))
         start = cslen + 1;
     else if ((start = str.indexOf('E')) != -1)
@@ -242,24 +243,45 @@ QString KCValueFormatter::removeTrailingZeros(const QString& str, const QString&
     return result;
 }
 
+const KCValueFormatter::NumberFormat& KCValueFormatter::numberFormat(const QString& formatString)
+{
+    QHash<QString, NumberFormat>::const_iterator it = m_numberFormats.constFind(formatString);
+    if (it != m_numberFormats.constEnd())
+        return it.value();
+
+    // split the formatstring into prefix, number format and postfix
+    static const QString numberChars = QLatin1String("0#.,E+");
+    int begin = 0;
+    while (begin < formatString.length() && !numberChars.contains(formatString[begin]))
+        ++begin;
+    int end = begin;
+    while (end < formatString.length() && numberChars.contains(formatString[end]))
+        ++end;
+
+    NumberFormat format;
+    format.prefix = formatString.left(begin);
+    format.postfix = formatString.mid(end);
+    format.hasDigits = end > begin;
+    const int decimalPoint = formatString.indexOf(QLatin1Char('.'), begin);
+    format.decimals = (decimalPoint != -1 && decimalPoint < end) ? end - decimalPoint - 1 : -1;
+    return *m_numberFormats.insert(formatString, format);
+}
+
 QString KCValueFormatter::createNumberFormat(KCNumber value, int precision,
         KCFormat::Type fmt, KCStyle::FloatFormat floatFormat, const QString& currencySymbol, const QString& _formatString)
 {
+    const KLocale* const locale = settings()->locale();
     QString prefix, postfix;
-    QString formatString(_formatString);
-
-    // try to split formatstring into prefix, formatstring and postfix.
-    if (!formatString.isEmpty() ) {
-        QRegExp re( QLatin1String( "^([^0#.,E+]*)([0#.,E+]*)(.*)$" ) );
-        if( re.exactMatch( formatString ) ) {
-            prefix = re.cap( 1 );
-            formatString = re.cap( 2 );
-            postfix = re.cap( 3 );
-        }
-        if (formatString.isEmpty()) {
+
+    // use the prefix, the postfix and the precision of the compiled formatstring
+    if (!_formatString.isEmpty() ) {
+        const NumberFormat& format = numberFormat(_formatString);
+        prefix = format.prefix;
+        postfix = format.postfix;
+        if (!format.hasDigits) {
             return prefix + postfix;
-        } else if (formatString.contains(QLatin1Char('.'))) {
-            precision = formatString.length() - formatString.indexOf(QLatin1Char('.')) - 1;
+        } else if (format.decimals != -1) {
+            precision = format.decimals;
         } else if (precision != -1){
             precision = 0;
         }
@@ -309,18 +331,18 @@ QString KCValueFormatter::createNumberFormat(KCNumber value, int precision,
     double val = numToDouble(value);
     switch (fmt) {
     case KCFormat::KCNumber:
-        localizedNumber = m_converter->settings()->locale()->formatNumber(val, p);
+        localizedNumber = locale->formatNumber(val, p);
         break;
     case KCFormat::Percentage:
-        localizedNumber = m_converter->settings()->locale()->formatNumber(val, p);
+        localizedNumber = locale->formatNumber(val, p);
         if(!postfix.endsWith('%')) // percent formattings needs to end with a "%"-sign
             postfix += '%';
         break;
     case KCFormat::Money:
-        localizedNumber = m_converter->settings()->locale()->formatMoney(val, currencySymbol.isEmpty() ? m_converter->settings()->locale()->currencySymbol() : currencySymbol, p);
+        localizedNumber = locale->formatMoney(val, currencySymbol.isEmpty() ? locale->currencySymbol() : currencySymbol, p);
         break;
     case KCFormat::Scientific: {
-        const QString decimalSymbol = m_converter->settings()->locale()->decimalSymbol();
+        const QString decimalSymbol = locale->decimalSymbol();
         localizedNumber = QString::number(val, 'E', p);
         if ((pos = localizedNumber.indexOf('.')) != -1)
             localizedNumber = localizedNumber.replace(pos, 1, decimalSymbol);
@@ -335,13 +357,13 @@ QString KCValueFormatter::createNumberFormat(KCNumber value, int precision,
 
     //prepend positive sign if needed
     if ((floatFormat == KCStyle::AlwaysSigned) && value >= 0)
-        if (m_converter->settings()->locale()->positiveSign().isEmpty())
+        if (locale->positiveSign().isEmpty())
             localizedNumber = '+' + localizedNumber;
 
     // Remove trailing zeros and the decimal point if necessary
     // unless the number has no decimal point
     if (precision == -1) {
-        QString decimalSymbol = m_converter->settings()->locale()->decimalSymbol();
+        QString decimalSymbol = locale->decimalSymbol();
         if (decimalSymbol.isNull())
             decimalSymbol = '.';
 
@@ -477,12 +499,13 @@ QString KCValueFormatter::timeFormat(const QDateTime &_dt, KCFormat::Type fmtTyp
         return _dt.toString( formatString );
     }
 
+    const KLocale* const locale = settings()->locale();
     const QDateTime dt(_dt.toUTC());
     QString result;
     if (fmtType == KCFormat::Time)
-        result = m_converter->settings()->locale()->formatTime(dt.time(), false);
+        result = locale->formatTime(dt.time(), false);
     else if (fmtType == KCFormat::SecondeTime)
-        result = m_converter->settings()->locale()->formatTime(dt.time(), true);
+        result = locale->formatTime(dt.time(), true);
     else {
         const int d = settings()->referenceDate().daysTo(dt.date());
         int h, m, s;
@@ -551,8 +574,8 @@ QString KCValueFormatter::timeFormat(const QDateTime &_dt, KCFormat::Type fmtTyp
 QString KCValueFormatter::dateTimeFormat(const QDateTime &_dt, KCFormat::Type fmtType, const QString& formatString )
 {
     if( !formatString.isEmpty() ) {
-        if (formatString.contains("X")) {               // if we have the special extra-short month in the format string
-            int monthPos = formatString.indexOf("X");
+        const int monthPos = formatString.indexOf(QLatin1Char('X'));
+        if (monthPos != -1) {                           // if we have the special extra-short month in the format string
             QString before = formatString.left(monthPos);                               // get string before and after the extra-short month sign
             QString after = formatString.right(formatString.size() - monthPos - 1);
             QString monthShort = _dt.toString("MMM").left(1);                           // format the month as extra-short (only 1st letter)
@@ -576,22 +599,24 @@ QString KCValueFormatter::dateFormat(const QDate &date, KCFormat::Type fmtType,
         return date.toString( formatString );
     }
 
+    const KLocale* const locale = settings()->locale();
+    const KCalendarSystem* const calendar = locale->calendar();
     QString tmp;
     if (fmtType == KCFormat::ShortDate) {
-        tmp = m_converter->settings()->locale()->formatDate(date, KLocale::ShortDate);
+        tmp = locale->formatDate(date, KLocale::ShortDate);
     } else if (fmtType == KCFormat::TextDate) {
-        tmp = m_converter->settings()->locale()->formatDate(date, KLocale::LongDate);
+        tmp = locale->formatDate(date, KLocale::LongDate);
     } else if (fmtType == KCFormat::Date1) { /*18-Feb-99 */
         tmp = QString().sprintf("%02d", date.day());
-        tmp += '-' + m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat) + '-';
+        tmp += '-' + calendar->monthString(date, KCalendarSystem::ShortFormat) + '-';
         tmp += QString::number(date.year()).right(2);
     } else if (fmtType == KCFormat::Date2) { /*18-Feb-1999 */
         tmp = QString().sprintf("%02d", date.day());
-        tmp += '-' + m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat) + '-';
+        tmp += '-' + calendar->monthString(date, KCalendarSystem::ShortFormat) + '-';
         tmp += QString::number(date.year());
     } else if (fmtType == KCFormat::Date3) { /*18-Feb */
         tmp = QString().sprintf("%02d", date.day());
-        tmp += '-' + m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat);
+        tmp += '-' + calendar->monthString(date, KCalendarSystem::ShortFormat);
     } else if (fmtType == KCFormat::Date4) { /*18-05 */
         tmp = QString().sprintf("%02d", date.day());
         tmp += '-' + QString().sprintf("%02d", date.month());
@@ -604,34 +629,34 @@ QString KCValueFormatter::dateFormat(const QDate &date, KCFormat::Type fmtType,
         tmp += '/' + QString().sprintf("%02d", date.month()) + '/';
         tmp += QString::number(date.year());
     } else if (fmtType == KCFormat::Date7) { /*Feb-99 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat) + '-';
+        tmp = calendar->monthString(date, KCalendarSystem::ShortFormat) + '-';
         tmp += QString::number(date.year()).right(2);
     } else if (fmtType == KCFormat::Date8) { /*February-99 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::LongFormat) + '-';
+        tmp = calendar->monthString(date, KCalendarSystem::LongFormat) + '-';
         tmp += QString::number(date.year()).right(2);
     } else if (fmtType == KCFormat::Date9) { /*February-1999 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::LongFormat) + '-';
+        tmp = calendar->monthString(date, KCalendarSystem::LongFormat) + '-';
         tmp += QString::number(date.year());
     } else if (fmtType == KCFormat::Date10) { /*F-99 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::LongFormat).at(0) + '-';
+        tmp = calendar->monthString(date, KCalendarSystem::LongFormat).at(0) + '-';
         tmp += QString::number(date.year()).right(2);
     } else if (fmtType == KCFormat::Date11) { /*18/Feb */
         tmp = QString().sprintf("%02d", date.day()) + '/';
-        tmp += m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat);
+        tmp += calendar->monthString(date, KCalendarSystem::ShortFormat);
     } else if (fmtType == KCFormat::Date12) { /*18/02 */
         tmp = QString().sprintf("%02d", date.day()) + '/';
         tmp += QString().sprintf("%02d", date.month());
     } else if (fmtType == KCFormat::Date13) { /*18/Feb/1999 */
         tmp = QString().sprintf("%02d", date.day());
-        tmp += '/' + m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat) + '/';
+        tmp += '/' + calendar->monthString(date, KCalendarSystem::ShortFormat) + '/';
         tmp += QString::number(date.year());
     } else if (fmtType == KCFormat::Date14) { /*2000/Feb/18 */
         tmp = QString::number(date.year());
-        tmp += '/' + m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat) + '/';
+        tmp += '/' + calendar->monthString(date, KCalendarSystem::ShortFormat) + '/';
         tmp += QString().sprintf("%02d", date.day());
     } else if (fmtType == KCFormat::Date15) { /*2000-Feb-18 */
         tmp = QString::number(date.year());
-        tmp += '-' + m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat) + '-';
+        tmp += '-' + calendar->monthString(date, KCalendarSystem::ShortFormat) + '-';
         tmp += QString().sprintf("%02d", date.day());
     } else if (fmtType == KCFormat::Date16) { /*2000-02-18 */
         tmp = QString::number(date.year());
@@ -639,7 +664,7 @@ QString KCValueFormatter::dateFormat(const QDate &date, KCFormat::Type fmtType,
         tmp += QString().sprintf("%02d", date.day());
     } else if (fmtType == KCFormat::Date17) { /*2 february 2000 */
         tmp = QString().sprintf("%d", date.day());
-        tmp += ' ' + m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::LongFormat) + ' ';
+        tmp += ' ' + calendar->monthString(date, KCalendarSystem::LongFormat) + ' ';
         tmp += QString::number(date.year());
     } else if (fmtType == KCFormat::Date18) { /*02/18/1999 */
         tmp = QString().sprintf("%02d", date.month());
@@ -650,15 +675,15 @@ QString KCValueFormatter::dateFormat(const QDate &date, KCFormat::Type fmtType,
         tmp += '/' + QString().sprintf("%02d", date.day());
         tmp += '/' + QString::number(date.year()).right(2);
     } else if (fmtType == KCFormat::Date20) { /*Feb/18/99 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat);
+        tmp = calendar->monthString(date, KCalendarSystem::ShortFormat);
         tmp += '/' + QString().sprintf("%02d", date.day());
         tmp += '/' + QString::number(date.year()).right(2);
     } else if (fmtType == KCFormat::Date21) { /*Feb/18/1999 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat);
+        tmp = calendar->monthString(date, KCalendarSystem::ShortFormat);
         tmp += '/' + QString().sprintf("%02d", date.day());
         tmp += '/' + QString::number(date.year());
     } else if (fmtType == KCFormat::Date22) { /*Feb-1999 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat) + '-';
+        tmp = calendar->monthString(date, KCalendarSystem::ShortFormat) + '-';
         tmp += QString::number(date.year());
     } else if (fmtType == KCFormat::Date23) { /*1999 */
         tmp = QString::number(date.year());
@@ -670,19 +695,19 @@ QString KCValueFormatter::dateFormat(const QDate &date, KCFormat::Type fmtType,
         tmp += '/' + QString().sprintf("%02d", date.day());
     } else if (fmtType == KCFormat::Date26) { /*2000/Feb/18 */
         tmp = QString::number(date.year());
-        tmp += '/' + m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat);
+        tmp += '/' + calendar->monthString(date, KCalendarSystem::ShortFormat);
         tmp += '/' + QString().sprintf("%02d", date.day());
     } else if (fmtType == KCFormat::Date27) { /*Feb/99 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat) + '/';
+        tmp = calendar->monthString(date, KCalendarSystem::ShortFormat) + '/';
         tmp += QString::number(date.year()).right(2);
     } else if (fmtType == KCFormat::Date28) { /*Feb/1999 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::ShortFormat) + '/';
+        tmp = calendar->monthString(date, KCalendarSystem::ShortFormat) + '/';
         tmp += QString::number(date.year());
     } else if (fmtType == KCFormat::Date29) { /*February/99 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::LongFormat) + '/';
+        tmp = calendar->monthString(date, KCalendarSystem::LongFormat) + '/';
         tmp += QString::number(date.year()).right(2);
     } else if (fmtType == KCFormat::Date30) { /*February/1999 */
-        tmp = m_converter->settings()->locale()->calendar()->monthString(date, KCalendarSystem::LongFormat) + '/';
+        tmp = calendar->monthString(date, KCalendarSystem::LongFormat) + '/';
         tmp += QString::number(date.year());
     } else if (fmtType == KCFormat::Date31) { /*18-02 */
         tmp = QString().sprintf("%02d", date.day()) + '-';
@@ -697,7 +722,7 @@ QString KCValueFormatter::dateFormat(const QDate &date, KCFormat::Type fmtType,
         QLocale l(QLocale::English);
         tmp = l.toString(date, fmtType == KCFormat::Date34 ? "ddd d MMM yy" : "dddd d MMM yyyy");
     } else { /*fallback... */
-        tmp = m_converter->settings()->locale()->formatDate(date, KLocale::ShortDate);
+        tmp = locale->formatDate(date, KLocale::ShortDate);
     }
 
     // Missing compared with gnumeric:
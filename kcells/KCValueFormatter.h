@@ -22,6 +22,7 @@
 #define KC_VALUE_FORMATTER
 
 #include <QDateTime>
+#include <QHash>
 
 #include "Global.h"
 #include "KCNumber.h"
@@ -130,7 +131,25 @@ protected:
     QString removeTrailingZeros(const QString& string, const QString& decimalSymbol);
 
 private:
+    /**
+     * A number format string split into the text preceding and following
+     * the number and the properties of the number itself.
+     */
+    struct NumberFormat {
+        QString prefix;
+        QString postfix;
+        bool hasDigits; // whether a number is shown at all
+        int decimals;   // the number of decimals or -1, if there's no decimal point
+    };
+
+    /**
+     * Looks up the split \p formatString . If it is used the first time,
+     * it gets split and remembered.
+     */
+    const NumberFormat& numberFormat(const QString& formatString);
+
     const KCValueConverter* m_converter;
+    QHash<QString, NumberFormat> m_numberFormats;
 };
 
 #endif  //KC_VALUE_FORMATTER
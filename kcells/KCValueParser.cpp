@@ -55,6 +55,12 @@ KCValue KCValueParser::parse(const QString& str) const
     QString strStripped = str.trimmed();
     // Try parsing as various datatypes, to find the type of the string
 
+    // Shortcut for plain numbers, e.g. imported or pasted data
+    val = readPlainNumber(strStripped, m_settings->locale()->negativeSign(),
+                          m_settings->locale()->decimalSymbol(), &ok);
+    if (ok)
+        return val;
+
     // First as number
     val = tryParseNumber(strStripped, &ok);
 
@@ -68,6 +74,14 @@ KCValue KCValueParser::parse(const QString& str) const
     if (ok)
         return val;
 
+    // Money, dates and times contain at least one digit.
+    const QChar* data = strStripped.constData();
+    const QChar* const end = data + strStripped.length();
+    while (data != end && !data->isDigit())
+        ++data;
+    if (data == end)
+        return KCValue(str);
+
     // Test for money number
     KCNumber money = m_settings->locale()->readMoney(strStripped, &ok);
     if (ok) {
@@ -189,6 +203,53 @@ KCValue KCValueParser::readNumber(const QString& _str, bool *ok) const
     return isInt ? KCValue(tot.toLongLong(ok)) : KCValue(tot.toDouble(ok));
 }
 
+KCValue KCValueParser::readPlainNumber(const QString& str, const QString& negativeSign,
+                                       const QString& decimalSymbol, bool* ok)
+{
+    *ok = false;
+    if (decimalSymbol.length() != 1)
+        return KCValue();
+
+    const bool neg = !negativeSign.isEmpty() && str.startsWith(negativeSign);
+    const int start = neg ? negativeSign.length() : 0;
+    const int length = str.length();
+    const QChar* const data = str.constData();
+    qint64 integer = 0;
+    int digits = 0;
+    int decimalPos = -1;
+    for (int i = start; i < length; ++i) {
+        const ushort ch = data[i].unicode();
+        if (ch >= '0' && ch <= '9') {
+            if (decimalPos == -1) {
+                // log10(2^63) ~= 18
+                if (++digits > 18)
+                    return KCValue();
+                integer = 10 * integer + (ch - '0');
+            }
+        } else if (data[i] == decimalSymbol[0] && decimalPos == -1)
+            decimalPos = i;
+        else
+            return KCValue(); // thousands separators, exponents, text, ...
+    }
+
+    if (decimalPos == -1) {
+        if (digits == 0)
+            return KCValue();
+        *ok = true;
+        return KCValue(neg ? -integer : integer);
+    }
+    // digits are required on both sides of the decimal symbol
+    if (decimalPos == start || decimalPos == length - 1)
+        return KCValue();
+    QString number;
+    number.reserve(length - start + 1);
+    if (neg)
+        number += '-';
+    number += str.mid(start);
+    number[decimalPos - start + (neg ? 1 : 0)] = '.';
+    return KCValue(number.toDouble(ok));
+}
+
 KCNumber KCValueParser::readImaginary(const QString& str, bool* ok) const
 {
     if (str.isEmpty()) {
@@ -84,6 +84,16 @@ public:
      */
     KCValue tryParseTime(const QString& str, bool *ok = 0) const;
 
+    /**
+     * Reads numbers consisting only of digits, a leading \p negativeSign and
+     * one \p decimalSymbol in one pass. If \p str contains anything else,
+     * \p ok is set to \c false .
+     * It does not access the settings and may be used from other threads,
+     * e.g. by filters converting imported data in parallel.
+     */
+    static KCValue readPlainNumber(const QString& str, const QString& negativeSign,
+                                   const QString& decimalSymbol, bool* ok);
+
 protected:
     /**
      * Converts \p str to a date/time value.
@@ -0,0 +1,136 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// Local
+#include "KCWhatIfEvaluator.h"
+
+#include <QHash>
+#include <QSet>
+#include <QtConcurrentMap>
+
+#include "KCCell.h"
+#include "KCDependencyManager.h"
+#include "KCFormula.h"
+#include "KCMap.h"
+#include "KCRegion.h"
+#include "KCSheet.h"
+#include "KCValue.h"
+
+namespace
+{
+struct Trial {
+    const QVector<KCValue>* values;
+    KCValue result;
+};
+
+/**
+ * Evaluates a trial in a worker thread.
+ */
+class TrialEvaluator
+{
+public:
+    typedef void result_type;
+
+    explicit TrialEvaluator(const KCWhatIfEvaluator* evaluator) : m_evaluator(evaluator) {}
+
+    void operator()(Trial& trial) const {
+        trial.result = m_evaluator->evaluate(*trial.values);
+    }
+
+private:
+    const KCWhatIfEvaluator* m_evaluator;
+};
+}
+
+class KCWhatIfEvaluator::Private
+{
+public:
+    KCFormula formula;
+    QList<KCCell> inputs;
+    // the input cells and all cells depending on them
+    QSet<KCCell> cone;
+};
+
+KCWhatIfEvaluator::KCWhatIfEvaluator(const KCFormula& formula, const QList<KCCell>& inputs)
+        : d(new Private)
+{
+    d->formula = formula;
+    d->inputs = inputs;
+
+    // Compile the formulas now, as that alters them.
+    d->formula.isValid();
+    KCValue::createErrorValues();
+
+    const KCSheet* const sheet = formula.sheet();
+    if (!sheet)
+        return;
+    const KCDependencyManager* const manager = sheet->map()->dependencyManager();
+    QList<KCCell> pending = inputs;
+    while (!pending.isEmpty()) {
+        const KCCell cell = pending.takeLast();
+        if (d->cone.contains(cell))
+            continue;
+        d->cone.insert(cell);
+        if (cell.isFormula())
+            cell.formula().isValid();
+
+        const KCRegion consumers = manager->consumingRegion(cell);
+        KCRegion::ConstIterator end(consumers.constEnd());
+        for (KCRegion::ConstIterator it(consumers.constBegin()); it != end; ++it) {
+            const QRect range = (*it)->rect();
+            for (int row = range.top(); row <= range.bottom(); ++row) {
+                for (int col = range.left(); col <= range.right(); ++col) {
+                    const KCCell consumer((*it)->sheet(), col, row);
+                    if (!d->cone.contains(consumer))
+                        pending.append(consumer);
+                }
+            }
+        }
+    }
+}
+
+KCWhatIfEvaluator::~KCWhatIfEvaluator()
+{
+    delete d;
+}
+
+KCValue KCWhatIfEvaluator::evaluate(const QVector<KCValue>& values) const
+{
+    QHash<KCCell, KCValue> cellValues;
+    for (int i = 0; i < d->inputs.count() && i < values.count(); ++i)
+        cellValues.insert(d->inputs[i], values[i]);
+    return d->formula.eval(cellValues, d->cone);
+}
+
+QVector<KCValue> KCWhatIfEvaluator::evaluate(const QList<QVector<KCValue> >& trials) const
+{
+    QVector<Trial> jobs(trials.count());
+    for (int i = 0; i < trials.count(); ++i)
+        jobs[i].values = &trials[i];
+
+    if (jobs.count() > 1)
+        QtConcurrent::blockingMap(jobs, TrialEvaluator(this));
+    else if (jobs.count() == 1)
+        jobs[0].result = evaluate(*jobs[0].values);
+
+    QVector<KCValue> results(jobs.count());
+    for (int i = 0; i < jobs.count(); ++i)
+        results[i] = jobs[i].result;
+    return results;
+}
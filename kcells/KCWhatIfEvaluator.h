@@ -0,0 +1,83 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KC_WHAT_IF_EVALUATOR
+#define KC_WHAT_IF_EVALUATOR
+
+#include <QList>
+#include <QVector>
+
+#include "kcells_export.h"
+
+class KCCell;
+class KCFormula;
+class KCValue;
+
+/**
+ * \class KCWhatIfEvaluator
+ * \brief Evaluates a formula for hypothetical values of some cells.
+ * \ingroup KCValue
+ *
+ * The goal seeking and the solver try many values for their input cells.
+ * Instead of writing each trial value into the cell, which alters the
+ * document and triggers the recalculation of all consumers, the formula
+ * is evaluated with the trial values in place of the stored ones.
+ *
+ * On construction, the cells depending directly or indirectly on the
+ * input cells are collected. Only their formulas are evaluated again for
+ * each trial; all other cells contribute their stored values.
+ *
+ * The evaluations do not alter any shared state, so independent trials
+ * are evaluated in parallel. The document must not be modified while an
+ * evaluator is in use.
+ */
+class KCELLS_EXPORT KCWhatIfEvaluator
+{
+public:
+    /**
+     * Prepares the evaluation of \p formula for hypothetical values of
+     * the cells in \p inputs .
+     */
+    KCWhatIfEvaluator(const KCFormula& formula, const QList<KCCell>& inputs);
+
+    /**
+     * Destructor.
+     */
+    ~KCWhatIfEvaluator();
+
+    /**
+     * Evaluates the formula as if the input cells had got \p values ;
+     * in the order of the inputs given on construction.
+     */
+    KCValue evaluate(const QVector<KCValue>& values) const;
+
+    /**
+     * Evaluates the formula for each of the \p trials in parallel.
+     * \return the results in the order of \p trials
+     */
+    QVector<KCValue> evaluate(const QList<QVector<KCValue> >& trials) const;
+
+private:
+    Q_DISABLE_COPY(KCWhatIfEvaluator)
+
+    class Private;
+    Private * const d;
+};
+
+#endif // KC_WHAT_IF_EVALUATOR
@@ -235,12 +235,14 @@ void KCRowFormat::setHidden(bool _hide, bool repaint)
     if (_hide != d->hide) { // only if we change the status
         if (_hide) {
             // Lower maximum size by height of row
-            d->sheet->adjustDocumentHeight(- height());
+            if (!d->filtered)
+                d->sheet->adjustDocumentHeight(- height());
             d->hide = _hide; //hide must be set after we requested the height
         } else {
             // Rise maximum size by height of row
             d->hide = _hide; //unhide must be set before we request the height
-            d->sheet->adjustDocumentHeight(height());
+            if (!d->filtered)
+                d->sheet->adjustDocumentHeight(height());
         }
     }
 }
@@ -252,6 +254,11 @@ bool KCRowFormat::isHidden() const
 
 void KCRowFormat::setFiltered(bool filtered)
 {
+    if (filtered == d->filtered)
+        return;
+    // A filtered row is not shown, just like a hidden one.
+    if (d->sheet && !d->hide)
+        d->sheet->adjustDocumentHeight(filtered ? -height() : height());
     d->filtered = filtered;
 }
 
@@ -484,12 +491,14 @@ void KCColumnFormat::setHidden(bool _hide)
     if (_hide != d->hide) { // only if we change the status
         if (_hide) {
             // Lower maximum size by width of column
-            d->sheet->adjustDocumentWidth(- width());
+            if (!d->filtered)
+                d->sheet->adjustDocumentWidth(- width());
             d->hide = _hide; //hide must be set after we requested the width
         } else {
             // Rise maximum size by width of column
             d->hide = _hide; //unhide must be set before we request the width
-            d->sheet->adjustDocumentWidth(width());
+            if (!d->filtered)
+                d->sheet->adjustDocumentWidth(width());
         }
     }
 }
@@ -501,6 +510,11 @@ bool KCColumnFormat::isHidden() const
 
 void KCColumnFormat::setFiltered(bool filtered)
 {
+    if (filtered == d->filtered)
+        return;
+    // A filtered column is not shown, just like a hidden one.
+    if (d->sheet && !d->hide)
+        d->sheet->adjustDocumentWidth(filtered ? -width() : width());
     d->filtered = filtered;
 }
 
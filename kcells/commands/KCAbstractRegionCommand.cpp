@@ -97,6 +97,8 @@ void KCAbstractRegionCommand::redo()
     }
 
     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+    // Process the damages of all manipulated cells at once.
+    m_sheet->map()->beginDamageBatch();
     // FIXME Stefan: Does every derived command damage the visual cache? No!
     m_sheet->map()->addDamage(new KCCellDamage(m_sheet, *this, KCCellDamage::Appearance));
 
@@ -113,6 +115,7 @@ void KCAbstractRegionCommand::redo()
         kWarning() << "KCAbstractRegionCommand::redo(): postprocessing was not successful!";
     }
 
+    m_sheet->map()->endDamageBatch();
     QApplication::restoreOverrideCursor();
 
     m_firstrun = false;
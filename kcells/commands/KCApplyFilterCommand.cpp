@@ -49,15 +49,20 @@ void KCApplyFilterCommand::redo()
     const QRect range = database.range().lastRange();
     const int start = database.orientation() == Qt::Vertical ? range.top() : range.left();
     const int end = database.orientation() == Qt::Vertical ? range.bottom() : range.right();
+    // evaluate all columns/rows at once, this fetches the values of each field only once
+    const QBitArray fulfilled = database.filter().evaluate(database, start + 1, end);
     for (int i = start + 1; i <= end; ++i) {
-        const bool isFiltered = !database.filter().evaluate(database, i);
+        const bool isFiltered = !fulfilled.testBit(i - start - 1);
 //         kDebug() <<"Filtering column/row" << i <<"?" << isFiltered;
+        // only touch the formats that change; this avoids creating a format for each unfiltered one
         if (database.orientation() == Qt::Vertical) {
             m_undoData[i] = sheet->rowFormat(i)->isFiltered();
-            sheet->nonDefaultRowFormat(i)->setFiltered(isFiltered);
+            if (m_undoData[i] != isFiltered)
+                sheet->nonDefaultRowFormat(i)->setFiltered(isFiltered);
         } else { // database.orientation() == Qt::Horizontal
             m_undoData[i] = sheet->columnFormat(i)->isFiltered();
-            sheet->nonDefaultColumnFormat(i)->setFiltered(isFiltered);
+            if (m_undoData[i] != isFiltered)
+                sheet->nonDefaultColumnFormat(i)->setFiltered(isFiltered);
         }
     }
     if (database.orientation() == Qt::Vertical)
@@ -80,10 +85,13 @@ void KCApplyFilterCommand::undo()
     const int start = database.orientation() == Qt::Vertical ? range.top() : range.left();
     const int end = database.orientation() == Qt::Vertical ? range.bottom() : range.right();
     for (int i = start + 1; i <= end; ++i) {
-        if (database.orientation() == Qt::Vertical)
-            sheet->nonDefaultRowFormat(i)->setFiltered(m_undoData[i]);
-        else // database.orientation() == Qt::Horizontal
-            sheet->nonDefaultColumnFormat(i)->setFiltered(m_undoData[i]);
+        if (database.orientation() == Qt::Vertical) {
+            if (sheet->rowFormat(i)->isFiltered() != m_undoData[i])
+                sheet->nonDefaultRowFormat(i)->setFiltered(m_undoData[i]);
+        } else { // database.orientation() == Qt::Horizontal
+            if (sheet->columnFormat(i)->isFiltered() != m_undoData[i])
+                sheet->nonDefaultColumnFormat(i)->setFiltered(m_undoData[i]);
+        }
     }
     if (database.orientation() == Qt::Vertical)
         sheet->map()->addDamage(new KCSheetDamage(sheet, KCSheetDamage::RowsChanged));
@@ -30,6 +30,8 @@
 
 #include "KCAutoFillCommand.h"
 
+#include "KCCellStorage.h"
+#include "KCFormulaStorage.h"
 #include "KCLocalization.h"
 #include "KCMap.h"
 #include "KCSheet.h"
@@ -711,7 +713,10 @@ bool KCAutoFillCommand::mainProcessing()
 
     // Fill from left to right
     if (m_sourceRange.left() == m_targetRange.left() && m_sourceRange.right() < m_targetRange.right()) {
-        for (int y = m_sourceRange.top(); y <= m_sourceRange.bottom(); y++) {
+        const QRect destination(QPoint(m_sourceRange.right() + 1, m_sourceRange.top()),
+                                QPoint(m_targetRange.right(), m_sourceRange.bottom()));
+        const bool filled = m_sourceRange.width() == 1 && fillFormulas(m_sourceRange, destination);
+        for (int y = m_sourceRange.top(); !filled && y <= m_sourceRange.bottom(); y++) {
             int x;
             QList<KCCell> destList;
             for (x = m_sourceRange.right() + 1; x <= m_targetRange.right(); x++)
@@ -729,7 +734,11 @@ bool KCAutoFillCommand::mainProcessing()
 
     // Fill from top to bottom
     if (m_sourceRange.top() == m_targetRange.top() && m_sourceRange.bottom() < m_targetRange.bottom()) {
-        for (int x = m_sourceRange.left(); x <= m_targetRange.right(); x++) {
+        const QRect destination(QPoint(m_sourceRange.left(), m_sourceRange.bottom() + 1),
+                                m_targetRange.bottomRight());
+        const bool filled = m_sourceRange.height() == 1 && m_sourceRange.right() == m_targetRange.right() &&
+                            fillFormulas(m_sourceRange, destination);
+        for (int x = m_sourceRange.left(); !filled && x <= m_targetRange.right(); x++) {
             int y;
             QList<KCCell> destList;
             for (y = m_sourceRange.bottom() + 1; y <= m_targetRange.bottom(); y++)
@@ -785,6 +794,22 @@ bool KCAutoFillCommand::mainProcessing()
     return true;
 }
 
+bool KCAutoFillCommand::fillFormulas(const QRect& source, const QRect& destination)
+{
+    // A single formula gets repeated with moved references only, just like
+    // a copied cell. So the cells can be copied at once, if all are formulas.
+    KCCellStorage *const storage = m_sheet->cellStorage();
+    if (storage->formulaStorage()->dataInRect(source).count() != source.width() * source.height())
+        return false;
+    const KCCellBlock block = storage->block(source);
+    if (block.isNull())
+        return false;
+    // the same data as the one set by ::fillSequence()
+    const int visiting = KCCellStorage::VisitContent | KCCellStorage::Styles | KCCellStorage::ConditionStyles;
+    storage->pasteBlock(block, destination, KCCellStorage::Visiting(visiting));
+    return true;
+}
+
 void KCAutoFillCommand::fillSequence(const QList<KCCell>& _srcList,
                                    const QList<KCCell>& _destList,
                                    const AutoFillSequence& _seqList,
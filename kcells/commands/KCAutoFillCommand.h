@@ -41,7 +41,7 @@ class KCCell;
  * \ingroup Commands
  * \brief Auto-filling of a cell range.
  */
-class KCAutoFillCommand : public KCAbstractDataManipulator
+class KCELLS_TEST_EXPORT KCAutoFillCommand : public KCAbstractDataManipulator
 {
 public:
     /**
@@ -70,6 +70,11 @@ public:
     static QStringList *shortDay;
 
 private:
+    /**
+     * Fills \p destination by copying the cells of \p source , if these are formulas.
+     * \return \c true , if \p destination got filled
+     */
+    bool fillFormulas(const QRect& source, const QRect& destination);
     void fillSequence(const QList<KCCell>& _srcList,
                       const QList<KCCell>& _destList,
                       const AutoFillSequence& _seqList,
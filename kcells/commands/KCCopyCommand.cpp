@@ -21,6 +21,8 @@
 
 #include "KCCopyCommand.h"
 
+#include <QMimeData>
+
 #include "KCCellStorage.h"
 #include "KCRegion.h"
 #include "RowColumnFormat.h"
@@ -136,6 +138,18 @@ QDomDocument KCCopyCommand::saveAsXml(const KCRegion& region, bool era)
     return xmlDoc;
 }
 
+void KCCopyCommand::saveAsBlock(QMimeData* mimeData, const KCRegion& region)
+{
+    if (!region.isContiguous() || region.isColumnOrRowSelected())
+        return;
+    KCSheet *const sheet = region.firstSheet();
+    if (!sheet)
+        return;
+    const KCCellBlock block = sheet->cellStorage()->block(region.firstRange());
+    if (!block.isNull())
+        mimeData->setProperty("kcells-cell-block", QVariant::fromValue(block));
+}
+
 static QString cellAsText(const KCCell& cell, bool addTab)
 {
     QString result;
@@ -22,6 +22,9 @@
 
 #include <QDomDocument>
 
+#include "kcells_export.h"
+
+class QMimeData;
 class KCRegion;
 
 /**
@@ -37,7 +40,17 @@ namespace KCCopyCommand
  *            absolutely (they will be switched back to relative
  *            references during decoding) - used for cut to clipboard
  */
-QDomDocument saveAsXml(const KCRegion&, bool era = false);
+KCELLS_TEST_EXPORT QDomDocument saveAsXml(const KCRegion&, bool era = false);
+
+/**
+ * Attaches the cell data of \p region to \p mimeData , if \p region is a
+ * single cell range. Pasting it within the application transfers the data
+ * block-wise instead of loading the XML snippet cell by cell.
+ * \param mimeData the MIME data holding the XML snippet of \p region
+ * \param region the cell region to process
+ * \see KCCellStorage::block()
+ */
+KCELLS_TEST_EXPORT void saveAsBlock(QMimeData* mimeData, const KCRegion& region);
 
 /**
  * Saves the cell \p region as plain text.
@@ -96,6 +96,47 @@ private:
     QHash<KCCell, KXmlElement> m_elements;
 };
 
+class PasteBlockCommand : public KCAbstractRegionCommand
+{
+public:
+    PasteBlockCommand(const KCCellBlock& block, QUndoCommand *parent = 0)
+            : KCAbstractRegionCommand(parent)
+            , m_block(block) {
+    }
+    virtual ~PasteBlockCommand() {}
+
+protected:
+    bool process(Element *element) {
+        m_sheet->cellStorage()->pasteBlock(m_block, element->rect());
+        return true;
+    }
+
+    bool preProcessing() {
+        if (m_firstrun) {
+            m_sheet->cellStorage()->startUndoRecording();
+        }
+        return true;
+    }
+
+    bool mainProcessing() {
+        if (m_reverse) {
+            QUndoCommand::undo(); // undo child commands
+            return true;
+        }
+        return KCAbstractRegionCommand::mainProcessing();
+    }
+
+    bool postProcessing() {
+        if (m_firstrun) {
+            m_sheet->cellStorage()->stopUndoRecording(this);
+        }
+        return true;
+    }
+
+private:
+    const KCCellBlock m_block;
+};
+
 
 
 KCPasteCommand::KCPasteCommand(QUndoCommand *parent)
@@ -428,6 +469,19 @@ bool KCPasteCommand::processXmlData(Element *element, KXmlDocument *data)
         }
     }
 
+    // The cell data copied within the application is transferred block-wise
+    // instead of loading the cells one by one, if all of it gets pasted.
+    const KCCellBlock block = m_mimeData->property("kcells-cell-block").value<KCCellBlock>();
+    const bool pasteBlock = !block.isNull() && block.sheet()->map() == map &&
+                            block.rect().width() == sourceWidth && block.rect().height() == sourceHeight &&
+                            noRowsInClipboard && noColumnsInClipboard && !sheet->isProtected() &&
+                            m_pasteMode == Paste::Normal && m_operation == Paste::OverWrite && m_pasteFC;
+    if (pasteBlock) {
+        PasteBlockCommand *const command = new PasteBlockCommand(block, this);
+        command->setSheet(m_sheet);
+        command->add(KCRegion(xOffset + 1, yOffset + 1, pasteWidth, pasteHeight, sheet));
+    }
+
     // This command will collect as many cell loads as possible in the iteration.
     PasteCellCommand *pasteCellCommand = 0;
 
@@ -509,7 +563,7 @@ bool KCPasteCommand::processXmlData(Element *element, KXmlDocument *data)
             }
         }
 
-        if (e.tagName() == "cell") {
+        if (e.tagName() == "cell" && !pasteBlock) {
             // Create a new PasteCellCommand, if necessary.
             if (!pasteCellCommand) {
                 pasteCellCommand = new PasteCellCommand(this);
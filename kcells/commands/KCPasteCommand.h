@@ -33,7 +33,7 @@ class KXmlDocument;
  * \ingroup Commands
  * \brief Command to paste cell data.
  */
-class KCPasteCommand : public KCAbstractRegionCommand
+class KCELLS_TEST_EXPORT KCPasteCommand : public KCAbstractRegionCommand
 {
 public:
     KCPasteCommand(QUndoCommand *parent = 0);
@@ -140,56 +140,99 @@ KCStyle KCSortManipulator::newFormat(Element *element, int col, int row)
 
 void KCSortManipulator::sort(Element *element)
 {
-    // we'll use insert-sort to sort
+    // we use a merge sort, which is stable and needs n*log(n) comparisons
     QRect range = element->rect();
     int max = m_rows ? range.bottom() : range.right();
     int min = m_rows ? range.top() : range.left();
     int count = max - min + 1;
     // initially, all values are at their original positions
-    sorted.clear();
+    sorted.resize(count);
     for (int i = 0; i < count; ++i) sorted[i] = i;
 
-    // for each position, find the lowest value and move it there
+    extractSortKeys(element, count);
+
+    // merge ever larger sorted runs, from 'buffer' into 'sorted'
     int start = m_skipfirst ? 1 : 0;
-    for (int i = start; i < count - 1; ++i) {
-        int lowest = i;
-        for (int j = i + 1; j < count; ++j)
-            if (shouldReorder(element, sorted[lowest], sorted[j]))
-                lowest = j;
-        // move lowest to start
-        int tmp = sorted[i];
-        sorted[i] = sorted[lowest];
-        sorted[lowest] = tmp;
+    QVector<int> buffer(sorted);
+    for (int width = 1; width < count - start; width *= 2) {
+        for (int left = start; left < count; left += 2 * width) {
+            const int middle = qMin(left + width, count);
+            const int right = qMin(left + 2 * width, count);
+            int i = left;
+            int j = middle;
+            int k = left;
+            while (i < middle && j < right) {
+                // only take from the second run if it has to go first, this keeps equal values in order
+                if (shouldReorder(sorted[i], sorted[j]))
+                    buffer[k++] = sorted[j++];
+                else
+                    buffer[k++] = sorted[i++];
+            }
+            while (i < middle)
+                buffer[k++] = sorted[i++];
+            while (j < right)
+                buffer[k++] = sorted[j++];
+        }
+        qSwap(sorted, buffer);
     }
 
+    m_sortKeys.clear();
+    m_customListPositions.clear();
+
     // that's all - process will take care of the rest, together with our
     // newValue/newFormat
 }
 
-bool KCSortManipulator::shouldReorder(Element *element, int first, int second)
+void KCSortManipulator::extractSortKeys(Element *element, int count)
 {
-    // we use KCValueCalc::natural* to compare
-    // indexes are real indexes, we don't use the sorted array here
-
-    KCValueCalc *calc = m_sheet->map()->calc();
     KCValueConverter *conv = m_sheet->map()->converter();
 
     QRect range = element->rect();
     int firstrow = range.top();
     int firstcol = range.left();
 
-    for (int i = 0; i < m_criteria.count(); ++i) {
-        int which = m_criteria[i].index;
+    // the first position of each string in the custom list
+    QHash<QString, int> customListPositions;
+    if (m_usecustomlist) {
+        for (int pos = 0; pos < m_customlist.count(); ++pos) {
+            const QString item = m_customlist[pos].toLower();
+            if (!customListPositions.contains(item))
+                customListPositions.insert(item, pos);
+        }
+    }
+
+    const int criteriaCount = m_criteria.count();
+    m_sortKeys.resize(count * criteriaCount);
+    m_customListPositions.fill(-1, count * criteriaCount);
+    for (int i = 0; i < count; ++i) {
+        for (int c = 0; c < criteriaCount; ++c) {
+            int which = m_criteria[c].index;
+            int row = firstrow + (m_rows ? i : which);
+            int col = firstcol + (m_rows ? which : i);
+            const KCValue value = m_sheet->cellStorage()->value(col, row);
+            m_sortKeys[i * criteriaCount + c] = value;
+            if (m_usecustomlist) {
+                const QString text = conv->asString(value).asString().toLower();
+                m_customListPositions[i * criteriaCount + c] = customListPositions.value(text, -1);
+            }
+        }
+    }
+}
+
+bool KCSortManipulator::shouldReorder(int first, int second) const
+{
+    // we use KCValueCalc::natural* to compare
+    // indexes are real indexes, we don't use the sorted array here
+
+    KCValueCalc *calc = m_sheet->map()->calc();
+
+    const int criteriaCount = m_criteria.count();
+    for (int i = 0; i < criteriaCount; ++i) {
         bool ascending = m_criteria[i].order == Qt::AscendingOrder;
         bool caseSensitive = m_criteria[i].caseSensitivity == Qt::CaseSensitive;
 
-        // figure out coordinates of the cells
-        int row1 = firstrow + (m_rows ? first : which);
-        int row2 = firstrow + (m_rows ? second : which);
-        int col1 = firstcol + (m_rows ? which : first);
-        int col2 = firstcol + (m_rows ? which : second);
-        KCValue val1 = KCCell(m_sheet, col1, row1).value();
-        KCValue val2 = KCCell(m_sheet, col2, row2).value();
+        const KCValue &val1 = m_sortKeys[first * criteriaCount + i];
+        const KCValue &val2 = m_sortKeys[second * criteriaCount + i];
         // empty values always go to the end, so if second value is empty and
         // first one is not, we don't need to reorder
         if ((!val1.isEmpty()) && val2.isEmpty())
@@ -197,20 +240,9 @@ bool KCSortManipulator::shouldReorder(Element *element, int first, int second)
 
         // custom list ?
         if (m_usecustomlist) {
-            QString s1 = conv->asString(val1).asString().toLower();
-            QString s2 = conv->asString(val2).asString().toLower();
-            QStringList::iterator it;
-            int pos1 = -1, pos2 = -1;
-            int pos = 0;
-            // Try to locate our two strings in the list. If both are there, assume
-            // ordering as specified by the list.
-            for (it = m_customlist.begin(); it != m_customlist.end(); ++it) {
-                if ((pos1 == -1) && ((*it).toLower() == s1))
-                    pos1 = pos;
-                if ((pos2 == -1) && ((*it).toLower() == s2))
-                    pos2 = pos;
-                pos++;
-            }
+            // If both are in the list, assume ordering as specified by the list.
+            int pos1 = m_customListPositions[first * criteriaCount + i];
+            int pos2 = m_customListPositions[second * criteriaCount + i];
             if ((pos1 >= 0) && (pos2 >= 0) && (pos1 != pos2))
                 // both are in the list, not the same
                 return (pos1 > pos2);
@@ -23,6 +23,8 @@
 #include "KCCellStorage.h"
 #include "DataManipulators.h"
 
+#include <QVector>
+
 class KCCellStorage;
 
 /**
@@ -77,7 +79,10 @@ protected:
 
     /** sort the data, filling the "sorted" structure */
     void sort(Element *element);
-    bool shouldReorder(Element *element, int first, int second);
+    /** fetch the values of all sort criteria of each row/column once, before sorting */
+    void extractSortKeys(Element *element, int count);
+    /** true if the row/column \p first has to go after \p second, using the extracted keys */
+    bool shouldReorder(int first, int second) const;
 
     bool m_rows, m_skipfirst, m_usecustomlist;
     QStringList m_customlist;
@@ -90,7 +95,12 @@ protected:
     QList<Criterion> m_criteria;
 
     /** sorted order - which row/column will move to where */
-    QMap<int, int> sorted;
+    QVector<int> sorted;
+
+    /** the values of each criterion, for each row/column; criteria count values per row/column */
+    QVector<KCValue> m_sortKeys; // temporary
+    /** the position in the custom list of each sort key, or -1 */
+    QVector<int> m_customListPositions; // temporary
 
     KCCellStorage* m_cellStorage; // temporary
     QHash<KCCell, KCStyle> m_styles; // temporary
@@ -0,0 +1,873 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "DataPilot.h"
+
+#include <QHash>
+#include <QPair>
+#include <QRect>
+#include <QSet>
+#include <QVector>
+
+#include <KOdfXmlNS.h>
+#include <KXmlWriter.h>
+#include <kdebug.h>
+#include <klocale.h>
+
+#include "KCCellStorage.h"
+#include "kcells_limits.h"
+#include "KCMap.h"
+#include "KCRegion.h"
+#include "KCSheet.h"
+#include "KCValue.h"
+#include "KCValueConverter.h"
+
+namespace
+{
+/**
+ * The aggregation of the values of a data field within a group.
+ */
+struct Aggregate {
+    Aggregate() : sum(0.0), count(0), numbers(0), min(0.0), max(0.0) {}
+
+    void add(const KCValue& value) {
+        if (value.isEmpty())
+            return;
+        ++count;
+        // like the spreadsheet functions on cell ranges, only numbers are summarized
+        if (!value.isInteger() && !value.isFloat())
+            return;
+        const KCNumber number = value.asFloat();
+        sum += number;
+        min = numbers ? qMin(min, number) : number;
+        max = numbers ? qMax(max, number) : number;
+        ++numbers;
+    }
+
+    KCValue result(DataPilot::Function function) const {
+        switch (function) {
+        case DataPilot::Sum:
+            return KCValue(sum);
+        case DataPilot::Count:
+            return KCValue(count);
+        case DataPilot::Average:
+            return numbers ? KCValue(sum / numbers) : KCValue::errorDIV0();
+        case DataPilot::Min:
+            return KCValue(min);
+        case DataPilot::Max:
+            return KCValue(max);
+        }
+        return KCValue();
+    }
+
+    KCNumber sum;
+    int count;
+    int numbers;
+    KCNumber min;
+    KCNumber max;
+};
+
+// the values of the row or column fields of a group
+typedef QVector<KCValue> Key;
+
+/**
+ * \return \c true , if \p value is grouped by its number
+ */
+inline bool isNumeric(const KCValue& value)
+{
+    return value.isInteger() || value.isFloat();
+}
+
+/**
+ * \return the hash of \p value ; the same for equal numbers of any type
+ */
+uint keyHash(const KCValue& value)
+{
+    if (!isNumeric(value))
+        return qHash(value);
+    // Hash all bits of the number; not the rounded integer, that qHash() uses.
+    union {
+        double number;
+        quint64 bits;
+    } canonical;
+    canonical.bits = 0;
+    canonical.number = numToDouble(value.asFloat());
+    if (canonical.number == 0.0)
+        canonical.number = 0.0; // no -0.0
+    return qHash(canonical.bits);
+}
+
+/**
+ * \return \c true , if \p value1 and \p value2 belong to the same group
+ */
+bool keyEqual(const KCValue& value1, const KCValue& value2)
+{
+    // The integer 1 and the float 1.0 are one group, unlike for KCValue::operator==().
+    if (isNumeric(value1) || isNumeric(value2)) {
+        return isNumeric(value1) && isNumeric(value2) &&
+               numToDouble(value1.asFloat()) == numToDouble(value2.asFloat());
+    }
+    return value1 == value2;
+}
+
+/**
+ * Moves the interval from \p begin to \p end along with the \p count
+ * columns or rows, that get inserted or removed at \p position .
+ * \return \c false , if the whole interval got removed
+ */
+bool shiftInterval(int& begin, int& end, int position, int count, bool insert, int maximum)
+{
+    if (insert) {
+        if (begin >= position)
+            begin += count;
+        if (end >= position)
+            end = qMin(end + count, maximum);
+        return begin <= maximum;
+    }
+    const int last = position + count - 1;
+    begin = (begin < position) ? begin : (begin > last) ? begin - count : position;
+    end = (end < position) ? end : (end > last) ? end - count : position - 1;
+    return begin <= end;
+}
+
+/**
+ * \return \p range moved along with the cells in \p rect of \p sheet ,
+ * that get inserted or removed; an invalid region, if all of its cells got removed
+ */
+KCRegion shiftedRange(const KCRegion& range, KCSheet* sheet, const QRect& rect,
+                      Qt::Orientation orientation, bool insert)
+{
+    if (!range.isValid() || range.firstSheet() != sheet)
+        return range;
+    QRect shifted = range.firstRange();
+    if (orientation == Qt::Horizontal) {
+        // Only the rows of rect get shifted; the range can not be split up.
+        if (shifted.top() < rect.top() || shifted.bottom() > rect.bottom())
+            return range;
+        int left = shifted.left();
+        int right = shifted.right();
+        if (!shiftInterval(left, right, rect.left(), rect.width(), insert, KS_colMax))
+            return KCRegion();
+        shifted.setLeft(left);
+        shifted.setRight(right);
+    } else {
+        // Only the columns of rect get shifted; the range can not be split up.
+        if (shifted.left() < rect.left() || shifted.right() > rect.right())
+            return range;
+        int top = shifted.top();
+        int bottom = shifted.bottom();
+        if (!shiftInterval(top, bottom, rect.top(), rect.height(), insert, KS_rowMax))
+            return KCRegion();
+        shifted.setTop(top);
+        shifted.setBottom(bottom);
+    }
+    return KCRegion(shifted, sheet);
+}
+
+/**
+ * The distinct keys of the row or column fields.
+ */
+struct Keys {
+    /**
+     * \return the id of \p key ; a new one, if \p key is not known yet
+     */
+    int id(const Key& key) {
+        // Group by the values themselves, not by their formatted strings, so
+        // that neither the number 1 and the text "1" nor numbers, that only
+        // look the same, end up in one group. Numbers are compared as
+        // doubles, whether integer or float.
+        uint hash = 0;
+        for (int i = 0; i < key.count(); ++i)
+            hash = 31 * hash + keyHash(key[i]);
+        QMultiHash<uint, int>::const_iterator it = ids.constFind(hash);
+        for (; it != ids.constEnd() && it.key() == hash; ++it) {
+            if (equal(keys[it.value()], key))
+                return it.value();
+        }
+        ids.insert(hash, keys.count());
+        keys.append(key);
+        rowCounts.append(0);
+        return keys.count() - 1;
+    }
+
+    /**
+     * \return the ids of the keys of at least one source row in ascending order
+     */
+    QVector<int> sortedIds() const;
+
+    /**
+     * \return \c true , if \p key1 and \p key2 denote the same group
+     */
+    static bool equal(const Key& key1, const Key& key2) {
+        for (int i = 0; i < key1.count(); ++i) {
+            if (!keyEqual(key1[i], key2[i]))
+                return false;
+        }
+        return true;
+    }
+
+    // the ids of the keys by their hash values
+    QMultiHash<uint, int> ids;
+    QVector<Key> keys;
+    // the number of source rows per key
+    QVector<int> rowCounts;
+};
+
+class KeyLessThan
+{
+public:
+    explicit KeyLessThan(const QVector<Key>& keys) : m_keys(keys) {}
+
+    bool operator()(int id1, int id2) const {
+        const Key& key1 = m_keys[id1];
+        const Key& key2 = m_keys[id2];
+        for (int i = 0; i < key1.count(); ++i) {
+            const int result = key1[i].compare(key2[i]);
+            if (result != 0)
+                return result < 0;
+        }
+        return false;
+    }
+
+private:
+    const QVector<Key>& m_keys;
+};
+
+QVector<int> Keys::sortedIds() const
+{
+    QVector<int> sortedIds;
+    for (int id = 0; id < keys.count(); ++id) {
+        if (rowCounts[id] > 0)
+            sortedIds.append(id);
+    }
+    qStableSort(sortedIds.begin(), sortedIds.end(), KeyLessThan(keys));
+    return sortedIds;
+}
+
+/**
+ * The groups and the data values of a source row.
+ */
+struct SourceRow {
+    SourceRow() : rowKey(-1), columnKey(-1) {}
+
+    // -1, if the row is empty
+    int rowKey;
+    int columnKey;
+    QVector<KCValue> data;
+};
+
+// the row and the column key of a group
+typedef QPair<int, int> Group;
+
+QString functionName(DataPilot::Function function)
+{
+    switch (function) {
+    case DataPilot::Sum:
+        return "sum";
+    case DataPilot::Count:
+        return "count";
+    case DataPilot::Average:
+        return "average";
+    case DataPilot::Min:
+        return "min";
+    case DataPilot::Max:
+        return "max";
+    }
+    return QString();
+}
+
+QString functionCaption(DataPilot::Function function)
+{
+    switch (function) {
+    case DataPilot::Sum:
+        return i18nc("data pilot function", "Sum");
+    case DataPilot::Count:
+        return i18nc("data pilot function", "Count");
+    case DataPilot::Average:
+        return i18nc("data pilot function", "Average");
+    case DataPilot::Min:
+        return i18nc("data pilot function", "Min");
+    case DataPilot::Max:
+        return i18nc("data pilot function", "Max");
+    }
+    return QString();
+}
+}
+
+class DataPilot::Private : public QSharedData
+{
+public:
+    Private() : built(false) {}
+
+    /**
+     * Resets the summary state.
+     */
+    void reset();
+
+    /**
+     * Creates the source row of the field \p values .
+     */
+    SourceRow sourceRow(const QVector<KCValue>& values);
+
+    /**
+     * Adds the source row at \p index to its group.
+     */
+    void addRow(int index);
+
+    /**
+     * Removes the source row at \p index from its group.
+     * \return \c true , if the last row of a key was removed
+     */
+    bool removeRow(int index);
+
+    /**
+     * Aggregates the data values of the rows of \p group .
+     */
+    void aggregate(const Group& group);
+
+    /**
+     * Moves the ranges along with the cells in \p rect of \p sheet ,
+     * that get inserted or removed.
+     */
+    void shift(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation, bool insert);
+
+    /**
+     * Writes the whole summary into the target range.
+     */
+    void write();
+
+    /**
+     * Writes the results of \p group into the target range.
+     */
+    void write(const Group& group);
+
+    QString name;
+    KCRegion sourceRange;
+    KCRegion targetRange;
+    QList<Field> fields;
+
+    // the summary state; built by DataPilot::refresh()
+    bool built;
+    QVector<int> rowFields;
+    QVector<int> columnFields;
+    QVector<int> dataFields;
+    // the source column of each field or -1
+    QVector<int> columns;
+    Keys rowKeys;
+    Keys columnKeys;
+    QVector<SourceRow> rows;
+    QHash<Group, QList<int> > members;
+    QHash<Group, QVector<Aggregate> > aggregates;
+    // the target row of each row key and the first target column of each column key
+    QHash<int, int> targetRows;
+    QHash<int, int> targetColumns;
+};
+
+void DataPilot::Private::reset()
+{
+    built = false;
+    rowFields.clear();
+    columnFields.clear();
+    dataFields.clear();
+    columns.clear();
+    rowKeys = Keys();
+    columnKeys = Keys();
+    rows.clear();
+    members.clear();
+    aggregates.clear();
+    targetRows.clear();
+    targetColumns.clear();
+}
+
+SourceRow DataPilot::Private::sourceRow(const QVector<KCValue>& values)
+{
+    SourceRow row;
+    bool empty = true;
+    for (int i = 0; i < values.count() && empty; ++i)
+        empty = values[i].isEmpty();
+    if (empty)
+        return row;
+
+    Key key(rowFields.count());
+    for (int i = 0; i < rowFields.count(); ++i)
+        key[i] = values[rowFields[i]];
+    row.rowKey = rowKeys.id(key);
+    key.resize(columnFields.count());
+    for (int i = 0; i < columnFields.count(); ++i)
+        key[i] = values[columnFields[i]];
+    row.columnKey = columnKeys.id(key);
+    row.data.resize(dataFields.count());
+    for (int i = 0; i < dataFields.count(); ++i)
+        row.data[i] = values[dataFields[i]];
+    return row;
+}
+
+void DataPilot::Private::addRow(int index)
+{
+    const SourceRow& row = rows[index];
+    if (row.rowKey == -1)
+        return;
+    members[Group(row.rowKey, row.columnKey)].append(index);
+    ++rowKeys.rowCounts[row.rowKey];
+    ++columnKeys.rowCounts[row.columnKey];
+}
+
+bool DataPilot::Private::removeRow(int index)
+{
+    const SourceRow& row = rows[index];
+    if (row.rowKey == -1)
+        return false;
+    members[Group(row.rowKey, row.columnKey)].removeOne(index);
+    const bool rowKeyRemoved = --rowKeys.rowCounts[row.rowKey] == 0;
+    const bool columnKeyRemoved = --columnKeys.rowCounts[row.columnKey] == 0;
+    return rowKeyRemoved || columnKeyRemoved;
+}
+
+void DataPilot::Private::aggregate(const Group& group)
+{
+    const QList<int> indices = members.value(group);
+    if (indices.isEmpty()) {
+        members.remove(group);
+        aggregates.remove(group);
+        return;
+    }
+    QVector<Aggregate> results(dataFields.count());
+    foreach(int index, indices) {
+        const SourceRow& row = rows[index];
+        for (int i = 0; i < dataFields.count(); ++i)
+            results[i].add(row.data[i]);
+    }
+    aggregates.insert(group, results);
+}
+
+void DataPilot::Private::shift(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation, bool insert)
+{
+    const KCRegion source = shiftedRange(sourceRange, sheet, rect, orientation, insert);
+    const KCRegion target = shiftedRange(targetRange, sheet, rect, orientation, insert);
+    if (source == sourceRange && target == targetRange)
+        return;
+    sourceRange = source;
+    targetRange = target;
+    // The summary state refers to absolute columns and rows.
+    reset();
+}
+
+void DataPilot::Private::write()
+{
+    KCSheet* const sheet = targetRange.firstSheet();
+    if (!sheet)
+        return;
+    KCCellStorage* const storage = sheet->cellStorage();
+    const QPoint anchor = targetRange.firstRange().topLeft();
+    const QVector<int> sortedRowKeys = rowKeys.sortedIds();
+    const QVector<int> sortedColumnKeys = columnKeys.sortedIds();
+
+    // the header row
+    int column = anchor.x();
+    for (int i = 0; i < rowFields.count(); ++i)
+        storage->setValue(column++, anchor.y(), KCValue(fields[rowFields[i]].name));
+    targetColumns.clear();
+    foreach(int columnKey, sortedColumnKeys) {
+        targetColumns.insert(columnKey, column);
+        QString prefix;
+        const Key& key = columnKeys.keys[columnKey];
+        for (int i = 0; i < key.count(); ++i)
+            prefix += sheet->map()->converter()->asString(key[i]).asString() + " - ";
+        for (int i = 0; i < dataFields.count(); ++i) {
+            const Field& field = fields[dataFields[i]];
+            const QString caption = prefix + functionCaption(field.function) + " - " + field.name;
+            storage->setValue(column++, anchor.y(), KCValue(caption));
+        }
+    }
+    const int right = qMax(column - 1, anchor.x());
+
+    // a row per row key
+    int row = anchor.y() + 1;
+    targetRows.clear();
+    foreach(int rowKey, sortedRowKeys) {
+        targetRows.insert(rowKey, row);
+        const Key& key = rowKeys.keys[rowKey];
+        for (int i = 0; i < key.count(); ++i)
+            storage->setValue(anchor.x() + i, row, key[i]);
+        foreach(int columnKey, sortedColumnKeys)
+            write(Group(rowKey, columnKey));
+        ++row;
+    }
+    const QRect range(anchor, QPoint(right, row - 1));
+
+    // clear the rest of the former summary
+    if (targetRange.isValid()) {
+        const QRect oldRange = targetRange.firstRange();
+        for (int r = oldRange.top(); r <= oldRange.bottom(); ++r) {
+            for (int c = oldRange.left(); c <= oldRange.right(); ++c) {
+                if (!range.contains(c, r))
+                    storage->setValue(c, r, KCValue());
+            }
+        }
+    }
+    targetRange = KCRegion(range, sheet);
+}
+
+void DataPilot::Private::write(const Group& group)
+{
+    KCSheet* const sheet = targetRange.firstSheet();
+    if (!sheet || !targetRows.contains(group.first) || !targetColumns.contains(group.second))
+        return;
+    KCCellStorage* const storage = sheet->cellStorage();
+    const int row = targetRows.value(group.first);
+    const int column = targetColumns.value(group.second);
+    const QVector<Aggregate> results = aggregates.value(group);
+    for (int i = 0; i < dataFields.count(); ++i) {
+        const KCValue value = results.isEmpty() ? KCValue() : results[i].result(fields[dataFields[i]].function);
+        storage->setValue(column + i, row, value);
+    }
+}
+
+
+DataPilot::DataPilot()
+        : d(new Private)
+{
+}
+
+DataPilot::DataPilot(const QString& name)
+        : d(new Private)
+{
+    d->name = name;
+}
+
+DataPilot::DataPilot(const DataPilot& other)
+        : d(other.d)
+{
+}
+
+DataPilot::~DataPilot()
+{
+}
+
+bool DataPilot::isEmpty() const
+{
+    return d->name.isNull(); // it may be empty though
+}
+
+const QString& DataPilot::name() const
+{
+    return d->name;
+}
+
+void DataPilot::setName(const QString& name)
+{
+    d->name = name;
+}
+
+const KCRegion& DataPilot::sourceRange() const
+{
+    return d->sourceRange;
+}
+
+void DataPilot::setSourceRange(const KCRegion& region)
+{
+    Q_ASSERT(region.isContiguous());
+    d->sourceRange = region;
+    d->reset();
+}
+
+const KCRegion& DataPilot::targetRange() const
+{
+    return d->targetRange;
+}
+
+void DataPilot::setTargetRange(const KCRegion& region)
+{
+    Q_ASSERT(region.isContiguous());
+    d->targetRange = region;
+    d->reset();
+}
+
+const QList<DataPilot::Field>& DataPilot::fields() const
+{
+    return d->fields;
+}
+
+void DataPilot::addField(const QString& name, Orientation orientation, Function function)
+{
+    Field field;
+    field.name = name;
+    field.orientation = orientation;
+    field.function = function;
+    d->fields.append(field);
+    d->reset();
+}
+
+void DataPilot::refresh()
+{
+    d->reset();
+    KCSheet* const sheet = d->sourceRange.firstSheet();
+    if (!d->sourceRange.isValid() || !sheet || !d->targetRange.isValid())
+        return;
+    const KCCellStorage* const storage = sheet->cellStorage();
+    const KCValueConverter* const converter = sheet->map()->converter();
+    const QRect range = d->sourceRange.firstRange();
+
+    // the columns of the fields by the names in the header row
+    QHash<QString, int> headers;
+    for (int col = range.left(); col <= range.right(); ++col) {
+        const QString header = converter->asString(storage->value(col, range.top())).asString();
+        if (!headers.contains(header))
+            headers.insert(header, col);
+    }
+    d->columns.fill(-1, d->fields.count());
+    for (int i = 0; i < d->fields.count(); ++i) {
+        const Field& field = d->fields[i];
+        // page fields would filter the source rows; they are not supported
+        if (field.orientation == Row)
+            d->rowFields.append(i);
+        else if (field.orientation == Column)
+            d->columnFields.append(i);
+        else if (field.orientation == Data)
+            d->dataFields.append(i);
+        else
+            continue;
+        d->columns[i] = headers.value(field.name, -1);
+    }
+
+    // a single pass over the column of each used field
+    const int count = range.height() - 1;
+    QVector<KCValue> columnValues(d->fields.count());
+    for (int i = 0; i < d->fields.count(); ++i) {
+        if (d->columns[i] != -1 && count > 0) {
+            const QRect column(d->columns[i], range.top() + 1, 1, count);
+            columnValues[i] = storage->valueRegion(KCRegion(column, sheet));
+        }
+    }
+    d->rows.resize(count);
+    QVector<KCValue> values(d->fields.count());
+    for (int index = 0; index < count; ++index) {
+        for (int i = 0; i < d->fields.count(); ++i)
+            values[i] = d->columns[i] == -1 ? KCValue() : columnValues[i].element(0, index);
+        d->rows[index] = d->sourceRow(values);
+        d->addRow(index);
+    }
+    foreach(const Group& group, d->members.keys())
+        d->aggregate(group);
+
+    d->built = true;
+    d->write();
+}
+
+void DataPilot::update(const KCRegion& region)
+{
+    KCSheet* const sheet = d->sourceRange.firstSheet();
+    if (!d->sourceRange.isValid() || !sheet)
+        return;
+    const QRect range = d->sourceRange.firstRange();
+
+    // the changed source rows
+    QSet<int> changedRows;
+    KCRegion::ConstIterator end(region.constEnd());
+    for (KCRegion::ConstIterator it(region.constBegin()); it != end; ++it) {
+        if ((*it)->sheet() != sheet)
+            continue;
+        const QRect changedRange = (*it)->rect() & range;
+        if (changedRange.isEmpty())
+            continue;
+        // changed field names or no summary yet
+        if (!d->built || changedRange.top() == range.top()) {
+            refresh();
+            return;
+        }
+        for (int row = changedRange.top(); row <= changedRange.bottom(); ++row)
+            changedRows.insert(row - range.top() - 1);
+    }
+    if (changedRows.isEmpty())
+        return;
+
+    const KCCellStorage* const storage = sheet->cellStorage();
+    QSet<Group> changedGroups;
+    bool keysChanged = false;
+    QVector<KCValue> values(d->fields.count());
+    foreach(int index, changedRows) {
+        const SourceRow& oldRow = d->rows[index];
+        if (oldRow.rowKey != -1)
+            changedGroups.insert(Group(oldRow.rowKey, oldRow.columnKey));
+        keysChanged |= d->removeRow(index);
+
+        for (int i = 0; i < d->fields.count(); ++i) {
+            const int column = d->columns[i];
+            values[i] = column == -1 ? KCValue() : storage->value(column, range.top() + 1 + index);
+        }
+        d->rows[index] = d->sourceRow(values);
+        const SourceRow& row = d->rows[index];
+        if (row.rowKey == -1)
+            continue;
+        // a new key shifts the other groups within the summary
+        if (d->rowKeys.rowCounts[row.rowKey] == 0 || d->columnKeys.rowCounts[row.columnKey] == 0)
+            keysChanged = true;
+        d->addRow(index);
+        changedGroups.insert(Group(row.rowKey, row.columnKey));
+    }
+    foreach(const Group& group, changedGroups)
+        d->aggregate(group);
+
+    if (keysChanged)
+        d->write();
+    else {
+        foreach(const Group& group, changedGroups)
+            d->write(group);
+    }
+}
+
+void DataPilot::insertCells(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation)
+{
+    d->shift(sheet, rect, orientation, true);
+}
+
+void DataPilot::removeCells(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation)
+{
+    d->shift(sheet, rect, orientation, false);
+}
+
+bool DataPilot::loadOdf(const KXmlElement& element, const KCMap* map)
+{
+    if (element.hasAttributeNS(KOdfXmlNS::table, "name"))
+        d->name = element.attributeNS(KOdfXmlNS::table, "name", QString());
+    if (element.hasAttributeNS(KOdfXmlNS::table, "target-range-address")) {
+        const QString address = element.attributeNS(KOdfXmlNS::table, "target-range-address", QString());
+        // only absolute addresses allowed; no fallback sheet needed
+        d->targetRange = KCRegion(KCRegion::loadOdf(address), map);
+    }
+    if (!d->targetRange.isValid())
+        return false;
+    KXmlElement child;
+    forEachElement(child, element) {
+        if (child.namespaceURI() != KOdfXmlNS::table)
+            continue;
+        if (child.localName() == "source-cell-range") {
+            const QString address = child.attributeNS(KOdfXmlNS::table, "cell-range-address", QString());
+            d->sourceRange = KCRegion(KCRegion::loadOdf(address), map);
+            if (!d->sourceRange.isValid())
+                return false;
+        } else if (child.localName() == "source-service" ||
+                   child.localName() == "database-source-sql" ||
+                   child.localName() == "database-source-table" ||
+                   child.localName() == "database-source-query") {
+            // Only cell ranges are supported as source; the caller skips this table.
+            kDebug() << "unsupported data pilot source" << child.localName();
+            return false;
+        } else if (child.localName() == "data-pilot-field") {
+            // the pseudo field of the data fields' captions
+            if (child.attributeNS(KOdfXmlNS::table, "is-data-layout-field", "false") == "true")
+                continue;
+            Field field;
+            field.name = child.attributeNS(KOdfXmlNS::table, "source-field-name", QString());
+            const QString orientation = child.attributeNS(KOdfXmlNS::table, "orientation", QString());
+            if (orientation == "row")
+                field.orientation = Row;
+            else if (orientation == "column")
+                field.orientation = Column;
+            else if (orientation == "data")
+                field.orientation = Data;
+            else if (orientation == "page")
+                field.orientation = Page;
+            else
+                field.orientation = Hidden;
+            const QString function = child.attributeNS(KOdfXmlNS::table, "function", "sum");
+            if (function == "count")
+                field.function = Count;
+            else if (function == "average")
+                field.function = Average;
+            else if (function == "min")
+                field.function = Min;
+            else if (function == "max")
+                field.function = Max;
+            else if (function == "sum" || function == "auto" || field.orientation != Data)
+                field.function = Sum;
+            else {
+                kDebug() << "table:function: unsupported data pilot function" << function;
+                continue;
+            }
+            d->fields.append(field);
+        }
+    }
+    return d->sourceRange.isValid();
+}
+
+void DataPilot::saveOdf(KXmlWriter& xmlWriter) const
+{
+    if (d->sourceRange.isEmpty() || d->targetRange.isEmpty())
+        return;
+    xmlWriter.startElement("table:data-pilot-table");
+    if (!d->name.isNull())
+        xmlWriter.addAttribute("table:name", d->name);
+    xmlWriter.addAttribute("table:target-range-address", d->targetRange.saveOdf());
+    // no totals are written into the target range
+    xmlWriter.addAttribute("table:grand-total", "none");
+    xmlWriter.startElement("table:source-cell-range");
+    xmlWriter.addAttribute("table:cell-range-address", d->sourceRange.saveOdf());
+    xmlWriter.endElement();
+    for (int i = 0; i < d->fields.count(); ++i) {
+        const Field& field = d->fields[i];
+        xmlWriter.startElement("table:data-pilot-field");
+        xmlWriter.addAttribute("table:source-field-name", field.name);
+        switch (field.orientation) {
+        case Hidden:
+            xmlWriter.addAttribute("table:orientation", "hidden");
+            break;
+        case Row:
+            xmlWriter.addAttribute("table:orientation", "row");
+            break;
+        case Column:
+            xmlWriter.addAttribute("table:orientation", "column");
+            break;
+        case Data:
+            xmlWriter.addAttribute("table:orientation", "data");
+            xmlWriter.addAttribute("table:function", functionName(field.function));
+            break;
+        case Page:
+            xmlWriter.addAttribute("table:orientation", "page");
+            break;
+        }
+        xmlWriter.endElement();
+    }
+    xmlWriter.endElement();
+}
+
+void DataPilot::operator=(const DataPilot& other)
+{
+    d = other.d;
+}
+
+bool DataPilot::operator==(const DataPilot& other) const
+{
+    // NOTE Like for Database, the target range is not compared.
+    if (d->name != other.d->name)
+        return false;
+    if (d->sourceRange != other.d->sourceRange)
+        return false;
+    if (d->fields.count() != other.d->fields.count())
+        return false;
+    for (int i = 0; i < d->fields.count(); ++i) {
+        const Field& field = d->fields[i];
+        const Field& otherField = other.d->fields[i];
+        if (field.name != otherField.name || field.orientation != otherField.orientation)
+            return false;
+        if (field.orientation == Data && field.function != otherField.function)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,190 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KCELLS_DATA_PILOT
+#define KCELLS_DATA_PILOT
+
+#include <QList>
+#include <QSharedDataPointer>
+#include <QString>
+
+#include <KXmlReader.h>
+
+#include "../kcells_export.h"
+
+class KXmlWriter;
+
+class QRect;
+
+class KCMap;
+class KCRegion;
+class KCSheet;
+
+/**
+ * OpenDocument, 8.6.3 Data Pilot Table
+ *
+ * Summarizes the rows of a source cell range grouped by the values of its
+ * row and column fields. The first row of the source range contains the
+ * field names.
+ *
+ * The summary is computed in a single pass over the columns of the used
+ * fields; the rows are aggregated in hashes keyed by their group. The
+ * values of each source row are kept, so that changes of single rows only
+ * recompute the groups they belong to.
+ */
+class KCELLS_EXPORT DataPilot
+{
+public:
+    enum Orientation {
+        Hidden,
+        Row,
+        Column,
+        Data,
+        Page
+    };
+
+    enum Function {
+        Sum,
+        Count,
+        Average,
+        Min,
+        Max
+    };
+
+    /**
+     * OpenDocument, 8.6.7 Data Pilot Field
+     */
+    struct Field {
+        QString name;
+        Orientation orientation;
+        Function function;
+    };
+
+    /**
+     * Constructor.
+     * Creates an empty data pilot table.
+     */
+    DataPilot();
+
+    /**
+     * Constructor.
+     * Creates a data pilot table named \p name.
+     */
+    DataPilot(const QString& name);
+
+    /**
+     * Copy Constructor.
+     */
+    DataPilot(const DataPilot& other);
+
+    /**
+     * Destructor.
+     */
+    ~DataPilot();
+
+    /**
+     * \return \c true if this is the default/empty data pilot table
+     */
+    bool isEmpty() const;
+
+    /**
+     * \return the data pilot table's name
+     */
+    const QString& name() const;
+
+    /**
+     * Sets the data pilot table's name.
+     */
+    void setName(const QString& name);
+
+    /**
+     * \return the summarized cell range
+     */
+    const KCRegion& sourceRange() const;
+
+    /**
+     * Sets the summarized cell range.
+     * \p region has to be contiguous.
+     */
+    void setSourceRange(const KCRegion& region);
+
+    /**
+     * \return the cell range of the summary
+     */
+    const KCRegion& targetRange() const;
+
+    /**
+     * Sets the cell range of the summary. Its top left cell is the anchor;
+     * the range is adjusted to the size of the summary by refresh().
+     */
+    void setTargetRange(const KCRegion& region);
+
+    /**
+     * \return the fields in the order of their grouping
+     */
+    const QList<Field>& fields() const;
+
+    /**
+     * Adds the field of the source column named \p name .
+     * \p function is only used for data fields.
+     */
+    void addField(const QString& name, Orientation orientation, Function function = Sum);
+
+    /**
+     * Computes the summary of the source range and writes it into the
+     * target range.
+     */
+    void refresh();
+
+    /**
+     * Updates the summary after the source cells in \p region have changed.
+     * Only the groups of the changed rows are computed again.
+     */
+    void update(const KCRegion& region);
+
+    /**
+     * Moves the source and the target range along with the cells, when the
+     * cells in \p rect of \p sheet get inserted.
+     * \param orientation Qt::Horizontal , if the cells right of \p rect get
+     * shifted; Qt::Vertical , if the cells below \p rect get shifted
+     */
+    void insertCells(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation);
+
+    /**
+     * Moves the source and the target range along with the cells, when the
+     * cells in \p rect of \p sheet get removed.
+     * \param orientation Qt::Horizontal , if the cells right of \p rect get
+     * shifted; Qt::Vertical , if the cells below \p rect get shifted
+     */
+    void removeCells(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation);
+
+    bool loadOdf(const KXmlElement& element, const KCMap* map);
+    void saveOdf(KXmlWriter& xmlWriter) const;
+
+    void operator=(const DataPilot& other);
+    bool operator==(const DataPilot& other) const;
+
+private:
+    class Private;
+    QSharedDataPointer<Private> d;
+};
+
+Q_DECLARE_TYPEINFO(DataPilot, Q_MOVABLE_TYPE);
+
+#endif // KCELLS_DATA_PILOT
@@ -25,6 +25,7 @@
 #include <KXmlWriter.h>
 
 #include "KCCellStorage.h"
+#include "DataPilot.h"
 #include "Database.h"
 #include "KCMap.h"
 #include "KCRegion.h"
@@ -34,6 +35,7 @@ class DatabaseManager::Private
 {
 public:
     const KCMap* map;
+    QList<DataPilot> dataPilots;
     static int s_id;
 };
 
@@ -56,6 +58,52 @@ QString DatabaseManager::createUniqueName() const
     return "database-" + QString::number(Private::s_id++);
 }
 
+void DatabaseManager::addDataPilot(const DataPilot& dataPilot)
+{
+    d->dataPilots.append(dataPilot);
+    d->dataPilots.last().refresh();
+}
+
+void DatabaseManager::removeDataPilot(const QString& name)
+{
+    for (int i = 0; i < d->dataPilots.count(); ++i) {
+        if (d->dataPilots[i].name() == name) {
+            d->dataPilots.removeAt(i);
+            return;
+        }
+    }
+}
+
+QList<DataPilot> DatabaseManager::dataPilots() const
+{
+    return d->dataPilots;
+}
+
+void DatabaseManager::regionChanged(const KCRegion& region)
+{
+    // the data pilot tables ignore the cells outside their source range
+    for (int i = 0; i < d->dataPilots.count(); ++i)
+        d->dataPilots[i].update(region);
+}
+
+void DatabaseManager::updateAllDataPilots()
+{
+    for (int i = 0; i < d->dataPilots.count(); ++i)
+        d->dataPilots[i].refresh();
+}
+
+void DatabaseManager::insertCells(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation)
+{
+    for (int i = 0; i < d->dataPilots.count(); ++i)
+        d->dataPilots[i].insertCells(sheet, rect, orientation);
+}
+
+void DatabaseManager::removeCells(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation)
+{
+    for (int i = 0; i < d->dataPilots.count(); ++i)
+        d->dataPilots[i].removeCells(sheet, rect, orientation);
+}
+
 bool DatabaseManager::loadOdf(const KXmlElement& body)
 {
     const KXmlNode databaseRanges = KoXml::namedItemNS(body, KOdfXmlNS::table, "database-ranges");
@@ -76,6 +124,19 @@ bool DatabaseManager::loadOdf(const KXmlElement& body)
             sheet->cellStorage()->setDatabase(region, database);
         }
     }
+    const KXmlNode dataPilotTables = KoXml::namedItemNS(body, KOdfXmlNS::table, "data-pilot-tables");
+    forEachElement(element, dataPilotTables) {
+        if (element.namespaceURI() != KOdfXmlNS::table)
+            continue;
+        if (element.localName() == "data-pilot-table") {
+            DataPilot dataPilot;
+            // skip the unsupported tables, but load the others
+            if (!dataPilot.loadOdf(element, d->map))
+                continue;
+            // the summary is already in the cells
+            d->dataPilots.append(dataPilot);
+        }
+    }
     return true;
 }
 
@@ -86,18 +147,24 @@ void DatabaseManager::saveOdf(KXmlWriter& xmlWriter) const
     const QList<KCSheet*>& sheets = d->map->sheetList();
     for (int i = 0; i < sheets.count(); ++i)
         databases << sheets[i]->cellStorage()->databases(region);
-    if (databases.isEmpty())
-        return;
-
-    xmlWriter.startElement("table:database-ranges");
-    for (int i = 0; i < databases.count(); ++i) {
-        Database database = databases[i].second;
-        database.setRange(KCRegion(databases[i].first.toRect(), database.range().firstSheet()));
-        if (!database.range().isValid())
-            continue;
-        database.saveOdf(xmlWriter);
+    if (!databases.isEmpty()) {
+        xmlWriter.startElement("table:database-ranges");
+        for (int i = 0; i < databases.count(); ++i) {
+            Database database = databases[i].second;
+            database.setRange(KCRegion(databases[i].first.toRect(), database.range().firstSheet()));
+            if (!database.range().isValid())
+                continue;
+            database.saveOdf(xmlWriter);
+        }
+        xmlWriter.endElement();
+    }
+
+    if (!d->dataPilots.isEmpty()) {
+        xmlWriter.startElement("table:data-pilot-tables");
+        for (int i = 0; i < d->dataPilots.count(); ++i)
+            d->dataPilots[i].saveOdf(xmlWriter);
+        xmlWriter.endElement();
     }
-    xmlWriter.endElement();
 }
 
 #include "DatabaseStorage.moc"
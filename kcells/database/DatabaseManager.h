@@ -26,9 +26,13 @@
 
 #include "../kcells_export.h"
 
+class QRect;
 class KXmlWriter;
 
+class DataPilot;
 class KCMap;
+class KCRegion;
+class KCSheet;
 
 class KCELLS_EXPORT DatabaseManager : public QObject
 {
@@ -50,6 +54,48 @@ public:
      */
     QString createUniqueName() const;
 
+    /**
+     * Adds the data pilot table \p dataPilot and writes its summary.
+     */
+    void addDataPilot(const DataPilot& dataPilot);
+
+    /**
+     * Removes the data pilot table named \p name .
+     * Its summary stays in the cells.
+     */
+    void removeDataPilot(const QString& name);
+
+    /**
+     * \return the data pilot tables
+     */
+    QList<DataPilot> dataPilots() const;
+
+    /**
+     * Updates the data pilot tables, whose source cells in \p region have changed.
+     */
+    void regionChanged(const KCRegion& region);
+
+    /**
+     * Computes the summaries of all data pilot tables again.
+     */
+    void updateAllDataPilots();
+
+    /**
+     * Moves the ranges of the data pilot tables along with the cells, when
+     * the cells in \p rect of \p sheet get inserted.
+     * \param orientation Qt::Horizontal , if the cells right of \p rect get
+     * shifted; Qt::Vertical , if the cells below \p rect get shifted
+     */
+    void insertCells(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation);
+
+    /**
+     * Moves the ranges of the data pilot tables along with the cells, when
+     * the cells in \p rect of \p sheet get removed.
+     * \param orientation Qt::Horizontal , if the cells right of \p rect get
+     * shifted; Qt::Vertical , if the cells below \p rect get shifted
+     */
+    void removeCells(KCSheet* sheet, const QRect& rect, Qt::Orientation orientation);
+
     /**
      * Loads databases.
      * \ingroup OpenDocument
@@ -21,6 +21,7 @@
 
 #include <QList>
 #include <QRect>
+#include <QVector>
 
 #include <KOdfXmlNS.h>
 #include <KXmlWriter.h>
@@ -33,6 +34,51 @@
 #include "KCValue.h"
 #include "KCValueConverter.h"
 
+/**
+ * The values of the fields used by the conditions, converted to strings, for a range of
+ * columns/rows. Each field is fetched once, when a condition asks for it first.
+ */
+class FieldValues
+{
+public:
+    FieldValues(const Database& database, int first, int count)
+            : m_database(database)
+            , m_first(first)
+            , m_count(count) {
+    }
+
+    const QVector<QString>& strings(int fieldNumber) {
+        QHash<int, QVector<QString> >::const_iterator it = m_strings.constFind(fieldNumber);
+        if (it != m_strings.constEnd())
+            return it.value();
+
+        const KCSheet* sheet = m_database.range().lastSheet();
+        const QRect range = m_database.range().lastRange();
+        const KCCellStorage* storage = sheet->cellStorage();
+        const KCValueConverter* converter = sheet->map()->converter();
+        const bool vertical = m_database.orientation() == Qt::Vertical;
+        const int field = (vertical ? range.left() : range.top()) + fieldNumber;
+        QVector<QString> strings(m_count);
+        for (int i = 0; i < m_count; ++i) {
+            const int index = m_first + i;
+            const KCValue value = vertical ? storage->value(field, index) : storage->value(index, field);
+            if (!value.isEmpty())
+                strings[i] = converter->asString(value).asString();
+        }
+        return m_strings.insert(fieldNumber, strings).value();
+    }
+
+    int count() const {
+        return m_count;
+    }
+
+private:
+    const Database& m_database;
+    const int m_first;
+    const int m_count;
+    QHash<int, QVector<QString> > m_strings;
+};
+
 class AbstractCondition
 {
 public:
@@ -42,6 +88,7 @@ public:
     virtual bool loadOdf(const KXmlElement& element) = 0;
     virtual void saveOdf(KXmlWriter& xmlWriter) = 0;
     virtual bool evaluate(const Database& database, int index) const = 0;
+    virtual QBitArray evaluate(FieldValues& values) const = 0;
     virtual bool isEmpty() const = 0;
     virtual QHash<QString, Filter::Comparison> conditions(int fieldNumber) const = 0;
     virtual void removeConditions(int fieldNumber) = 0;
@@ -79,6 +126,12 @@ public:
         }
         return true;
     }
+    virtual QBitArray evaluate(FieldValues& values) const {
+        QBitArray result(values.count(), true);
+        for (int i = 0; i < list.count(); ++i)
+            result &= list[i]->evaluate(values);
+        return result;
+    }
     virtual bool isEmpty() const {
         return list.isEmpty();
     }
@@ -147,6 +200,12 @@ public:
         }
         return false;
     }
+    virtual QBitArray evaluate(FieldValues& values) const {
+        QBitArray result(values.count(), false);
+        for (int i = 0; i < list.count(); ++i)
+            result |= list[i]->evaluate(values);
+        return result;
+    }
     virtual bool isEmpty() const {
         return list.isEmpty();
     }
@@ -360,6 +419,18 @@ public:
         }
         return false;
     }
+    virtual QBitArray evaluate(FieldValues& values) const {
+        QBitArray result(values.count(), false);
+        if (operation != Match && operation != NotMatch)
+            return result;
+        const QVector<QString>& strings = values.strings(fieldNumber);
+        const bool match = operation == Match;
+        for (int i = 0; i < strings.count(); ++i) {
+            if ((QString::compare(this->value, strings[i], caseSensitivity) == 0) == match)
+                result.setBit(i);
+        }
+        return result;
+    }
     virtual bool isEmpty() const {
         return fieldNumber == -1;
     }
@@ -635,6 +706,15 @@ bool Filter::evaluate(const Database& database, int index) const
     return d->condition ? d->condition->evaluate(database, index) : true;
 }
 
+QBitArray Filter::evaluate(const Database& database, int first, int last) const
+{
+    const int count = qMax(0, last - first + 1);
+    if (!d->condition)
+        return QBitArray(count, true);
+    FieldValues values(database, first, count);
+    return d->condition->evaluate(values);
+}
+
 bool Filter::loadOdf(const KXmlElement& element, const KCMap* map)
 {
     if (element.hasAttributeNS(KOdfXmlNS::table, "target-range-address")) {
@@ -20,6 +20,7 @@
 #ifndef KCELLS_FILTER
 #define KCELLS_FILTER
 
+#include <QBitArray>
 #include <QHash>
 #include <QString>
 
@@ -96,6 +97,14 @@ public:
      */
     bool evaluate(const Database& database, int index) const;
 
+    /**
+     * Evaluates the conditions for all columns/rows from \p first to \p last at once.
+     * The values of each field are fetched only once for all of them.
+     * \return a bit for each column/row, set if it fulfills all conditions
+     * \see evaluate(const Database&, int)
+     */
+    QBitArray evaluate(const Database& database, int first, int last) const;
+
     bool loadOdf(const KXmlElement& element, const KCMap* map);
     void saveOdf(KXmlWriter& xmlWriter) const;
 
@@ -34,6 +34,7 @@
 #include "KCMap.h"
 #include "ui/Selection.h"
 #include "KCSheet.h"
+#include "KCWhatIfEvaluator.h"
 #include "Util.h"
 
 // commands
@@ -244,7 +245,9 @@ void GoalSeekDialog::startCalc(double _start, double _goal)
     double x = startB + 0.5;
 
     int iterations = d->maxIter;
-    const KCFormula formula = d->targetCell.formula();
+    // The trial values are not written into the source cell.
+    const KCWhatIfEvaluator evaluator(d->targetCell.formula(), QList<KCCell>() << d->sourceCell);
+    bool firstStep = true;
 
     // while the result is not close enough to zero
     // or while the max number of iterations is not reached...
@@ -252,15 +255,22 @@ void GoalSeekDialog::startCalc(double _start, double _goal)
         startA = startB;
         startB = x;
 
-        d->sourceCell.setValue(KCValue(startA));
-        const double targetValueA = numToDouble(formula.eval().asFloat());
-        resultA = targetValueA - _goal;
-//         kDebug() << "Target A:" << targetValueA << "," << d->targetCell.userInput() << "Calc:" << resultA;
-
-        d->sourceCell.setValue(KCValue(startB));
-        const double targetValueB = numToDouble(formula.eval().asFloat());
-        resultB = targetValueB - _goal;
-//         kDebug() << "Target B:" << targetValueB << "," << d->targetCell.userInput() << "Calc:" << resultB;
+        if (firstStep) {
+            // evaluate both ends of the first secant at once
+            QList<QVector<KCValue> > trials;
+            trials << (QVector<KCValue>() << KCValue(startA)) << (QVector<KCValue>() << KCValue(startB));
+            const QVector<KCValue> targetValues = evaluator.evaluate(trials);
+            resultA = numToDouble(targetValues[0].asFloat()) - _goal;
+            resultB = numToDouble(targetValues[1].asFloat()) - _goal;
+            firstStep = false;
+        } else {
+            // the new start A is the last start B
+            resultA = resultB;
+            const KCValue targetValueB = evaluator.evaluate(QVector<KCValue>() << KCValue(startB));
+            resultB = numToDouble(targetValueB.asFloat()) - _goal;
+        }
+//         kDebug() << "Target A:" << resultA + _goal << "," << d->targetCell.userInput() << "Calc:" << resultA;
+//         kDebug() << "Target B:" << resultB + _goal << "," << d->targetCell.userInput() << "Calc:" << resultB;
 
 //         kDebug() <<"Iteration:" << iterations <<", StartA:" << startA
 //                  << ", ResultA: " << resultA << " (eps: " << eps << "), StartB: "
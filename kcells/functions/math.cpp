@@ -34,6 +34,8 @@
 #include "KCFunctionModuleRegistry.h"
 #include "KCFunction.h"
 #include "KCFunctionRepository.h"
+#include "KCLookupCache.h"
+#include "KCMap.h"
 #include "KCValueCalc.h"
 #include "KCValueConverter.h"
 
@@ -545,6 +547,23 @@ KCValue func_suma(valVector args, KCValueCalc *calc, FuncExtra *)
     return calc->sum(args, true);
 }
 
+//
+// Helper for the criteria functions
+//
+// Retrieves the cells of argument \p arg , if they were given as a cell range.
+// The criteria in those are matched with the shared indexes of KCLookupCache.
+static bool criteriaRange(FuncExtra *e, int arg, const KCSheet **sheet, QRect *range)
+{
+    if (!e || e->whatIf || e->ranges.count() <= arg || e->ranges[arg].col1 == -1 || e->ranges[arg].row1 == -1)
+        return false;
+    const KCRegion& region = e->regions[arg];
+    if (!region.isValid() || !region.isContiguous() || !region.firstSheet())
+        return false;
+    *sheet = region.firstSheet();
+    *range = region.firstRange();
+    return true;
+}
+
 // KCFunction: SUMIF
 KCValue func_sumif(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
@@ -553,6 +572,28 @@ KCValue func_sumif(valVector args, KCValueCalc *calc, FuncExtra *e)
     Condition cond;
     calc->getCond(cond, KCValue(condition));
 
+    const KCSheet* sheet = 0;
+    QRect range;
+    if (checkRange.isArray() && criteriaRange(e, 0, &sheet, &range)) {
+        QVector<int> positions;
+        if (sheet->map()->lookupCache()->criteriaMatches(sheet, range, checkRange, cond, calc, &positions) != -1) {
+            // add the matching numbers in the same order as KCValueCalc::sumIf()
+            KCValue res(0);
+            for (int i = 0; i < positions.count(); ++i) {
+                const int c = positions[i] % range.width();
+                const int r = positions[i] / range.width();
+                KCValue val;
+                if (args.count() == 3)
+                    val = KCCell(e->sheet, e->ranges[2].col1 + c, e->ranges[2].row1 + r).value();
+                else
+                    val = checkRange.element(c, r);
+                if (val.isNumber()) // only add numbers, no conversion from string allowed
+                    res = calc->add(res, val);
+            }
+            return res;
+        }
+    }
+
     if (args.count() == 3) {
         KCCell sumRangeStart(e->sheet, e->ranges[2].col1, e->ranges[2].row1);
         return calc->sumIf(sumRangeStart, checkRange, cond);
@@ -1009,6 +1050,14 @@ KCValue func_countif(valVector args, KCValueCalc *calc, FuncExtra *e)
     Condition cond;
     calc->getCond(cond, KCValue(condition));
 
+    const KCSheet* sheet = 0;
+    QRect cellRange;
+    if (range.isArray() && criteriaRange(e, 0, &sheet, &cellRange)) {
+        const int count = sheet->map()->lookupCache()->criteriaMatches(sheet, cellRange, range, cond, calc, 0);
+        if (count != -1)
+            return KCValue(count);
+    }
+
     return KCValue(calc->countIf(range, cond));
 }
 
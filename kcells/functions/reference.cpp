@@ -31,6 +31,8 @@
 #include "KCFormula.h"
 #include "KCFunction.h"
 #include "KCFunctionModuleRegistry.h"
+#include "KCLookupCache.h"
+#include "KCMap.h"
 #include "KCValueCalc.h"
 #include "KCValueConverter.h"
 
@@ -281,10 +283,28 @@ KCValue func_columns(valVector, KCValueCalc *, FuncExtra *e)
 }
 
 
+//
+// Helper for the lookup functions
+//
+// Retrieves the cells of argument \p arg , if they were given as a cell range.
+// The searches in those use the shared indexes of KCLookupCache.
+static bool lookupRange(FuncExtra *e, int arg, const KCSheet **sheet, QRect *range)
+{
+    if (!e || e->whatIf || e->ranges.count() <= arg || e->ranges[arg].col1 == -1 || e->ranges[arg].row1 == -1)
+        return false;
+    const KCRegion& region = e->regions[arg];
+    if (!region.isValid() || !region.isContiguous() || !region.firstSheet())
+        return false;
+    *sheet = region.firstSheet();
+    *range = region.firstRange();
+    return true;
+}
+
+
 //
 // KCFunction: HLOOKUP
 //
-KCValue func_hlookup(valVector args, KCValueCalc *calc, FuncExtra *)
+KCValue func_hlookup(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
     const KCValue key = args[0];
     const KCValue data = args[1];
@@ -295,6 +315,20 @@ KCValue func_hlookup(valVector args, KCValueCalc *calc, FuncExtra *)
         return KCValue::errorVALUE();
     const bool rangeLookup = (args.count() > 3) ? calc->conv()->asBoolean(args[3]).asBoolean() : true;
 
+    // search in the index of the first row, if possible
+    const KCSheet* sheet;
+    QRect range;
+    if (lookupRange(e, 1, &sheet, &range)) {
+        KCLookupCache* const cache = sheet->map()->lookupCache();
+        range.setHeight(1);
+        bool ok;
+        int col = cache->exactMatch(sheet, range, data, key, true, &ok);
+        if (ok && col == -1 && rangeLookup)
+            col = cache->lowerMatch(sheet, range, data, key, true, &ok);
+        if (ok)
+            return (col == -1) ? KCValue::errorNA() : data.element(col, row - 1);
+    }
+
     // now traverse the array and perform comparison
     KCValue r;
     KCValue v = KCValue::errorNA();
@@ -416,6 +450,16 @@ KCValue func_match(valVector args, KCValueCalc *calc, FuncExtra* e)
     int n = qMax(searchArray.rows(), searchArray.columns());
 
     if (matchType == 0) {
+        // search in the index, if possible
+        const KCSheet* sheet;
+        QRect range;
+        if (lookupRange(e, 1, &sheet, &range)) {
+            bool ok;
+            const int position = sheet->map()->lookupCache()->exactMatch(sheet, range, searchArray,
+                                                                         searchValue, false, &ok);
+            if (ok)
+                return (position == -1) ? KCValue::errorNA() : KCValue(position + 1);
+        }
         // linear search
         for (int r = 0, c = 0; r < n && c < n; r += dr, c += dc) {
             if (calc->naturalEqual(searchValue, searchArray.element(c, r), false)) {
@@ -515,7 +559,7 @@ KCValue func_rows(valVector, KCValueCalc *, FuncExtra *e)
 //
 // KCFunction: VLOOKUP
 //
-KCValue func_vlookup(valVector args, KCValueCalc *calc, FuncExtra *)
+KCValue func_vlookup(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
     const KCValue key = args[0];
     const KCValue data = args[1];
@@ -526,6 +570,20 @@ KCValue func_vlookup(valVector args, KCValueCalc *calc, FuncExtra *)
         return KCValue::errorVALUE();
     const bool rangeLookup = (args.count() > 3) ? calc->conv()->asBoolean(args[3]).asBoolean() : true;
 
+    // search in the index of the first column, if possible
+    const KCSheet* sheet;
+    QRect range;
+    if (lookupRange(e, 1, &sheet, &range)) {
+        KCLookupCache* const cache = sheet->map()->lookupCache();
+        range.setWidth(1);
+        bool ok;
+        int row = cache->exactMatch(sheet, range, data, key, true, &ok);
+        if (ok && row == -1 && rangeLookup)
+            row = cache->lowerMatch(sheet, range, data, key, true, &ok);
+        if (ok)
+            return (row == -1) ? KCValue::errorNA() : data.element(col - 1, row);
+    }
+
     // now traverse the array and perform comparison
     KCValue r;
     KCValue v = KCValue::errorNA();
@@ -24,6 +24,9 @@
 
 #include "KCFunction.h"
 #include "KCFunctionModuleRegistry.h"
+#include "KCLookupCache.h"
+#include "KCMap.h"
+#include "KCSheet.h"
 #include "KCValueCalc.h"
 #include "KCValueConverter.h"
 
@@ -35,6 +38,9 @@
 // needed for MODE
 #include <QList>
 #include <QMap>
+#include <QVector>
+
+#include <algorithm>
 
 using namespace KCells;
 
@@ -119,7 +125,7 @@ KCValue func_variancepa(valVector args, KCValueCalc *calc, FuncExtra *);
 KCValue func_weibull(valVector args, KCValueCalc *calc, FuncExtra *);
 KCValue func_ztest(valVector args, KCValueCalc *calc, FuncExtra *);
 
-typedef QList<double> List;
+typedef QVector<double> List;
 
 
 KCELLS_EXPORT_FUNCTION_MODULE("statistical", StatisticalModule)
@@ -464,6 +470,68 @@ void func_array_helper(KCValue range, KCValueCalc *calc,
 }
 
 
+//
+// helper: order_helper
+//
+// Collects the numbers of the argument \p arg into \p array like
+// func_array_helper(). If an order statistic of the same cell range was
+// requested before, the numbers are sorted and shared via the lookup cache.
+// Returns true, if \p array is sorted.
+//
+bool func_order_helper(valVector args, int arg, KCValueCalc *calc, FuncExtra *e, List &array)
+{
+    const KCSheet* sheet = 0;
+    QRect range;
+    if (e && !e->whatIf && e->ranges.count() > arg && e->ranges[arg].col1 != -1 && e->ranges[arg].row1 != -1) {
+        const KCRegion& region = e->regions[arg];
+        if (region.isValid() && region.isContiguous()) {
+            sheet = region.firstSheet();
+            range = region.firstRange();
+        }
+    }
+    KCLookupCache* const cache = sheet ? sheet->map()->lookupCache() : 0;
+    bool sort = false;
+    if (cache && cache->sortedNumbers(sheet, range, &array, &sort))
+        return true;
+
+    int number = 0;
+    func_array_helper(args[arg], calc, array, number);
+    if (sort) {
+        qSort(array);
+        cache->setSortedNumbers(sheet, range, array);
+    }
+    return sort;
+}
+
+
+//
+// helper: select_helper
+//
+// Returns the value at \p index of the ascending \p array . An unsorted
+// \p array is only partitioned around \p index .
+//
+double func_select_helper(List &array, bool sorted, int index)
+{
+    if (!sorted)
+        std::nth_element(array.begin(), array.begin() + index, array.end());
+    return array.at(index);
+}
+
+
+//
+// helper: select_next_helper
+//
+// Returns the value following \p index in the ascending \p array .
+// An unsorted \p array has to be partitioned by func_select_helper() before.
+//
+double func_select_next_helper(const List &array, bool sorted, int index)
+{
+    if (sorted)
+        return array.at(index + 1);
+    return *std::min_element(array.constBegin() + index + 1, array.constEnd());
+}
+
+
 //
 // helper: covar_helper
 //
@@ -1776,7 +1844,7 @@ KCValue func_kurtosis_pop(valVector args, KCValueCalc *calc, FuncExtra *)
 //
 // function: large
 //
-KCValue func_large(valVector args, KCValueCalc *calc, FuncExtra *)
+KCValue func_large(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
     // does NOT support anything other than doubles !!!
     int k = calc->conv()->asInteger(args[1]).asInteger();
@@ -1784,15 +1852,12 @@ KCValue func_large(valVector args, KCValueCalc *calc, FuncExtra *)
         return KCValue::errorVALUE();
 
     List array;
-    int number = 1;
+    const bool sorted = func_order_helper(args, 0, calc, e, array);
 
-    func_array_helper(args[0], calc, array, number);
-
-    if (k >= number || number - k - 1 >= array.count())
+    if (k > array.count())
         return KCValue::errorVALUE();
 
-    qSort(array);
-    double d = array.at(number - k - 1);
+    double d = func_select_helper(array, sorted, array.count() - k);
     return KCValue(d);
 }
 
@@ -1979,24 +2044,31 @@ KCValue func_lognormdist(valVector args, KCValueCalc *calc, FuncExtra *)
 //
 // KCFunction: MEDIAN
 //
-KCValue func_median(valVector args, KCValueCalc *calc, FuncExtra *)
+KCValue func_median(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
     // does NOT support anything other than doubles !!!
     List array;
-    int number = 0;
+    bool sorted = false;
 
-    for (int i = 0; i < args.count(); ++i)
-        func_array_helper(args[i], calc, array, number);
+    if (args.count() == 1)
+        sorted = func_order_helper(args, 0, calc, e, array);
+    else {
+        int number = 0;
+        for (int i = 0; i < args.count(); ++i)
+            func_array_helper(args[i], calc, array, number);
+    }
+    const int number = array.count();
 
     if (number == 0)
         return KCValue::errorVALUE();
 
-    qSort(array);
     double d;
     if (number % 2) // odd
-        d = array.at((number - 1) / 2);
-    else // even
-        d = 0.5 * (array.at(number / 2 - 1) + array.at(number / 2));
+        d = func_select_helper(array, sorted, (number - 1) / 2);
+    else { // even
+        const double lower = func_select_helper(array, sorted, number / 2 - 1);
+        d = 0.5 * (lower + func_select_next_helper(array, sorted, number / 2 - 1));
+    }
     return KCValue(d);
 }
 
@@ -2135,15 +2207,14 @@ KCValue func_normsinv(valVector args, KCValueCalc *calc, FuncExtra *)
 //
 // PERCENTILE( data set; alpha )
 //
-KCValue func_percentile(valVector args, KCValueCalc *calc, FuncExtra*)
+KCValue func_percentile(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
     double alpha = numToDouble(calc->conv()->toFloat(args[1]));
 
     // create array - does NOT support anything other than doubles !!!
     List array;
-    int number = 0;
-
-    func_array_helper(args[0], calc, array, number);
+    const bool sorted = func_order_helper(args, 0, calc, e, array);
+    const int number = array.count();
 
     // check constraints - number of values must be > 0 and flag >0 <=4
     if (number == 0)
@@ -2151,16 +2222,17 @@ KCValue func_percentile(valVector args, KCValueCalc *calc, FuncExtra*)
     if (alpha < -1e-9 || alpha > 1 + 1e-9)
         return KCValue::errorVALUE();
 
-    // sort values
-    qSort(array);
-
     if (number == 1)
-        return KCValue(array[0]); // only one value
+        return KCValue(array.at(0)); // only one value
     else {
-        double r = alpha * (number - 1);
+        // the tolerance of alpha must not lead beyond the values
+        double r = qBound(0.0, alpha * (number - 1), double(number - 1));
         int index = ::floor(r);
         double d = r - index;
-        return KCValue(array[index] + d * (array[index+1] - array[index]));
+        const double value = func_select_helper(array, sorted, index);
+        if (d == 0.0)
+            return KCValue(value);
+        return KCValue(value + d * (func_select_next_helper(array, sorted, index) - value));
     }
 }
 
@@ -2225,7 +2297,7 @@ KCValue func_poisson(valVector args, KCValueCalc *calc, FuncExtra *)
 // KCFunction: rank
 //
 // rank(rank; ref.;sort order)
-KCValue func_rank(valVector args, KCValueCalc *calc, FuncExtra*)
+KCValue func_rank(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
     double x = calc->conv()->asFloat(args[0]).asFloat();
 
@@ -2233,7 +2305,6 @@ KCValue func_rank(valVector args, KCValueCalc *calc, FuncExtra*)
     bool descending = true;
 
     double count = 1.0;
-    double val   = 0.0;
     bool valid = false; // flag
 
     // opt. parameter
@@ -2242,26 +2313,22 @@ KCValue func_rank(valVector args, KCValueCalc *calc, FuncExtra*)
 
     // does NOT support anything other than doubles !!!
     List array;
-    int number = 0;
-
-    func_array_helper(args[1], calc, array, number);
-
-    // sort array
-    qSort(array);
-
-    for (int i = 0; i < array.count(); i++) {
-        if (descending)
-            val = array[array.count()-count];
-        else
-            val = array[i];
-
-        //kDebug()<<"count ="<<count<<" val = "<<val<<" x = "<<x;
-
-        if (x == val) {
-            valid = true;
-            break;
-        } else if ((!descending && x > val) || (descending && x < val))
-            count++;
+    const bool sorted = func_order_helper(args, 1, calc, e, array);
+
+    // count the values ranked before x; no need to sort for that
+    if (sorted) {
+        List::ConstIterator lower = qLowerBound(array.constBegin(), array.constEnd(), x);
+        List::ConstIterator upper = qUpperBound(lower, array.constEnd(), x);
+        valid = lower != upper;
+        count += descending ? array.constEnd() - upper : lower - array.constBegin();
+    } else {
+        for (int i = 0; i < array.count(); i++) {
+            const double val = array.at(i);
+            if (x == val)
+                valid = true;
+            else if ((!descending && x > val) || (descending && x < val))
+                count++;
+        }
     }
 
     if (valid)
@@ -2332,15 +2399,14 @@ KCValue func_rsq(valVector args, KCValueCalc *calc, FuncExtra*)
 //  3 75th percentile
 //  4 equals MAX()
 //
-KCValue func_quartile(valVector args, KCValueCalc *calc, FuncExtra*)
+KCValue func_quartile(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
     int flag = calc->conv()->asInteger(args[1]).asInteger();
 
     // create array - does NOT support anything other than doubles !!!
     List array;
-    int number = 0;
-
-    func_array_helper(args[0], calc, array, number);
+    const bool sorted = func_order_helper(args, 0, calc, e, array);
+    const int number = array.count();
 
     // check constraints - number of values must be > 0 and flag >0 <=4
     if (number == 0)
@@ -2348,17 +2414,14 @@ KCValue func_quartile(valVector args, KCValueCalc *calc, FuncExtra*)
     if (flag < 0 || flag > 4)
         return KCValue::errorVALUE();
 
-    // sort values
-    qSort(array);
-
     if (number == 1)
-        return KCValue(array[0]); // only one value
+        return KCValue(array.at(0)); // only one value
     else {
         //
         // flag 0 -> MIN()
         //
         if (flag == 0)
-            return KCValue(array[0]);
+            return KCValue(func_select_helper(array, sorted, 0));
 
         //
         // flag 1 -> 25th percentile
@@ -2366,21 +2429,23 @@ KCValue func_quartile(valVector args, KCValueCalc *calc, FuncExtra*)
         else if (flag == 1) {
             int nIndex = ::floor(0.25 * (number - 1));
             double diff = 0.25 * (number - 1) - ::floor(0.25 * (number - 1));
+            const double value = func_select_helper(array, sorted, nIndex);
 
             if (diff == 0.0)
-                return KCValue(array[nIndex]);
+                return KCValue(value);
             else
-                return KCValue(array[nIndex] + diff*(array[nIndex+1] - array[nIndex]));
+                return KCValue(value + diff*(func_select_next_helper(array, sorted, nIndex) - value));
         }
 
         //
         // flag 2 -> 50th percentile equals MEDIAN()
         //
         else if (flag == 2) {
-            if (number % 2 == 0)
-                return KCValue((array[number/2-1] + array[number/2]) / 2.0);
-            else
-                return KCValue(array[(number-1)/2]);
+            if (number % 2 == 0) {
+                const double lower = func_select_helper(array, sorted, number / 2 - 1);
+                return KCValue((lower + func_select_next_helper(array, sorted, number / 2 - 1)) / 2.0);
+            } else
+                return KCValue(func_select_helper(array, sorted, (number - 1) / 2));
         }
 
         //
@@ -2389,18 +2454,19 @@ KCValue func_quartile(valVector args, KCValueCalc *calc, FuncExtra*)
         else if (flag == 3) {
             int nIndex = ::floor(0.75 * (number - 1));
             double diff = 0.75 * (number - 1) - ::floor(0.75 * (number - 1));
+            const double value = func_select_helper(array, sorted, nIndex);
 
             if (diff == 0.0)
-                return KCValue(array[nIndex]);
+                return KCValue(value);
             else
-                return KCValue(array[nIndex] + diff*(array[nIndex+1] - array[nIndex]));
+                return KCValue(value + diff*(func_select_next_helper(array, sorted, nIndex) - value));
         }
 
         //
         // flag 4 -> equals MAX()
         //
         else
-            return KCValue(array[number-1]);
+            return KCValue(func_select_helper(array, sorted, number - 1));
     }
 }
 
@@ -2475,7 +2541,7 @@ KCValue func_slope(valVector args, KCValueCalc* calc, FuncExtra*)
 //
 // function: small
 //
-KCValue func_small(valVector args, KCValueCalc *calc, FuncExtra *)
+KCValue func_small(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
     // does NOT support anything other than doubles !!!
     int k = calc->conv()->asInteger(args[1]).asInteger();
@@ -2483,15 +2549,12 @@ KCValue func_small(valVector args, KCValueCalc *calc, FuncExtra *)
         return KCValue::errorVALUE();
 
     List array;
-    int number = 1;
-
-    func_array_helper(args[0], calc, array, number);
+    const bool sorted = func_order_helper(args, 0, calc, e, array);
 
-    if (k > number || k - 1 >= array.count())
+    if (k > array.count())
         return KCValue::errorVALUE();
 
-    qSort(array);
-    double d = array.at(k - 1);
+    double d = func_select_helper(array, sorted, k - 1);
     return KCValue(d);
 }
 
@@ -2771,7 +2834,7 @@ KCValue func_trend(valVector args, KCValueCalc *calc, FuncExtra *)
 //
 // KCFunction: trimmean
 //
-KCValue func_trimmean(valVector args, KCValueCalc *calc, FuncExtra *)
+KCValue func_trimmean(valVector args, KCValueCalc *calc, FuncExtra *e)
 {
     KCValue dataSet    = args[0];
     KCValue cutOffFrac = args[1];
@@ -2787,17 +2850,17 @@ KCValue func_trimmean(valVector args, KCValueCalc *calc, FuncExtra *)
 
     // sort parameter into QList array
     List array;
-    int valCount = 0; // stores the number of values in array
-
-    func_array_helper(args[0], calc, array, valCount);
+    const bool sorted = func_order_helper(args, 0, calc, e, array);
+    const int valCount = array.count(); // stores the number of values in array
 
     if (valCount == 0)
         return KCValue::errorVALUE();
 
-    qSort(array);
+    if (!sorted)
+        qSort(array);
 
     for (int i = cutOff; i < valCount - cutOff ; i++)
-        res += array[i];
+        res += array.at(i);
 
     res /= (valCount - 2 * cutOff);
 
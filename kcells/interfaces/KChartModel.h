@@ -21,7 +21,9 @@
 #define KCHART_MODEL
 
 
+#include <QtCore/QBitArray>
 #include <QtCore/QHash>
+#include <QtCore/QString>
 #include <QtCore/QVector>
 #include <QtCore/QtPlugin>
 
@@ -81,9 +83,39 @@ public:
     virtual bool isCellRegionValid(const QString& regionName) const = 0;
 };
 
+/**
+* The values of a column, as read by ChartBulkModel::columnSlices().
+* All vectors have an entry per row.
+*/
+struct ColumnSlice
+{
+    QVector<double> numbers;    ///< the numbers; NaN for cells without one
+    QVector<QString> labels;    ///< the texts; null for cells without one
+    QBitArray dateTimes;        ///< set, if the number is a date/time serial number
+};
+
+/**
+* The ChartBulkModel class is implemented by models, that hand out the
+* values of whole columns at once. Large data series can be read without
+* a data() call per point.
+*/
+class ChartBulkModel
+{
+public:
+    virtual ~ChartBulkModel() {}
+
+    /**
+     * Reads the values of the columns in \p rect , given in model rows and
+     * columns.
+     * \return a slice per column of \p rect clipped to the model
+     */
+    virtual QVector<ColumnSlice> columnSlices(const QRect& rect) const = 0;
+};
+
 } // Namespace KChart
 
 Q_DECLARE_INTERFACE(KChart::ChartModel, "org.kde.KChart.ChartModel:1.0")
+Q_DECLARE_INTERFACE(KChart::ChartBulkModel, "org.kde.KChart.ChartBulkModel:1.0")
 
 #endif // KCHART_MODEL
 
@@ -266,7 +266,7 @@ void KCCanvas::paintEvent(QPaintEvent *event)
     const QPointF topLeft(sheet->columnPosition(visibleRect.left()), sheet->rowPosition(visibleRect.top()));
     SheetView *sv = view()->sheetView(sheet);
     sv->setPaintCellRange(visibleRect);
-    sv->paintCells(painter, paintRect, topLeft);
+    sv->paintCellsCached(painter, paintRect, topLeft);
 
     // flake
     painter.restore();
@@ -31,6 +31,7 @@
 #include <KCValue.h>
 #include <part/KCView.h>
 #include <KCRegion.h>
+#include <KCWhatIfEvaluator.h>
 
 #include "SolverDialog.h"
 
@@ -129,6 +130,9 @@ void Solver::optimize()
         }
     }
 
+    // The trial values are not written into the cells.
+    parameters->evaluator = new KCWhatIfEvaluator(*s_formula, parameters->cells);
+
     /* Initial vertex size vector with a step size of 1 */
     gsl_vector* stepSizes = gsl_vector_alloc(dimension);
     gsl_vector_set_all(stepSizes, 1.0);
@@ -176,11 +180,16 @@ void Solver::optimize()
         printf("f() = %7.3f size = %.3f\n", minimizer->fval, size);
     } while (status == GSL_CONTINUE && iteration < maxIterations);
 
+    // apply the best parameters found
+    for (int i = 0; i < dimension; ++i) {
+        parameters->cells[i].setValue(KCValue(gsl_vector_get(minimizer->x, i)));
+    }
 
     // free allocated memory
     gsl_vector_free(x);
     gsl_vector_free(stepSizes);
     gsl_multimin_fminimizer_free(minimizer);
+    delete parameters->evaluator;
     delete parameters;
     delete s_formula;
 }
@@ -196,12 +205,13 @@ double function(const gsl_vector* vector, void *params)
 {
     Solver::Parameters* parameters = static_cast<Solver::Parameters*>(params);
 
+    QVector<KCValue> values(parameters->cells.count());
     for (int i = 0; i < parameters->cells.count(); ++i) {
-        parameters->cells[i].setValue(KCValue(gsl_vector_get(vector, i)));
+        values[i] = KCValue(gsl_vector_get(vector, i));
     }
 
     // TODO check for errors/correct type
-    return numToDouble(s_formula->eval().asFloat());
+    return numToDouble(parameters->evaluator->evaluate(values).asFloat());
 }
 
 #include "Solver.moc"
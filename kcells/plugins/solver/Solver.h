@@ -31,6 +31,8 @@
 class QObject;
 #include <QVariantList>
 
+class KCWhatIfEvaluator;
+
 /**
  * \class Solver KCFunction Optimizer
  * \author Stefan Nikolaus <stefan.nikolaus@kdemail.net>
@@ -42,6 +44,7 @@ class KCELLS_EXPORT Solver : public KParts::Plugin
 public:
     struct Parameters {
         QList<KCCell> cells;
+        KCWhatIfEvaluator* evaluator;
     };
 
     /**
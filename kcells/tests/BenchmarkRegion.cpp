@@ -0,0 +1,111 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "BenchmarkRegion.h"
+
+#include "kcells_limits.h"
+
+#include "KCRegion.h"
+
+void RegionBenchmark::testCreationFromString()
+{
+    // The references of a filled column of formulas.
+    QStringList references;
+    for (int row = 1; row <= 1000; ++row)
+        references << QString("A%1:$B$%2").arg(row).arg(row + 10);
+    QBENCHMARK {
+        for (int i = 0; i < references.count(); ++i)
+            KCRegion region(references[i]);
+    }
+}
+
+void RegionBenchmark::testAddition_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("cols");
+
+    QTest::newRow("column") << 1000 << 1;
+    QTest::newRow("row") << 1 << 1000;
+    QTest::newRow("block") << 100 << 10;
+}
+
+void RegionBenchmark::testAddition()
+{
+    QFETCH(int, rows);
+    QFETCH(int, cols);
+    QBENCHMARK {
+        KCRegion region;
+        for (int row = 1; row <= rows; ++row) {
+            for (int col = 1; col <= cols; ++col)
+                region.add(QPoint(col, row));
+        }
+    }
+}
+
+void RegionBenchmark::testContains_data()
+{
+    QTest::addColumn<int>("elements");
+
+    QTest::newRow("few") << 5;
+    QTest::newRow("some") << 100;
+    QTest::newRow("many") << 10000;
+}
+
+void RegionBenchmark::testContains()
+{
+    QFETCH(int, elements);
+    KCRegion region;
+    for (int i = 0; i < elements; ++i)
+        region.add(QPoint(1 + (i * 7) % 100, 1 + i));
+    QBENCHMARK {
+        for (int row = 1; row <= 1000; ++row) {
+            for (int col = 1; col <= 10; ++col)
+                region.contains(QPoint(col, row));
+        }
+    }
+}
+
+void RegionBenchmark::testIntersection()
+{
+    KCRegion region1;
+    for (int col = 1; col <= 100; col += 2)
+        region1.add(QRect(col, 1, 1, 10000));
+    const KCRegion region2(QRect(1, 5000, 200, 1000));
+    QBENCHMARK {
+        region1.intersected(region2);
+    }
+}
+
+void RegionBenchmark::testCompaction()
+{
+    // The changed cells of a recalculation, e.g.
+    KCRegion region;
+    for (int row = 1; row <= 1000; ++row) {
+        for (int col = 1; col <= 10; ++col)
+            region.add(QPoint(col, row));
+    }
+    // The compacted ranges are kept by the region; compact a fresh copy.
+    QBENCHMARK {
+        KCRegion(region).compacted();
+    }
+}
+
+QTEST_MAIN(RegionBenchmark)
+
+#include "BenchmarkRegion.moc"
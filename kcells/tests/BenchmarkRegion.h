@@ -0,0 +1,39 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KCELLS_BENCHMARK_REGION
+#define KCELLS_BENCHMARK_REGION
+
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+class RegionBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testCreationFromString();
+    void testAddition_data();
+    void testAddition();
+    void testContains_data();
+    void testContains();
+    void testIntersection();
+    void testCompaction();
+};
+
+#endif // KCELLS_BENCHMARK_REGION
@@ -0,0 +1,106 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "BenchmarkValueFormatter.h"
+
+#include "KCCalculationSettings.h"
+#include "KCValue.h"
+#include "KCValueConverter.h"
+#include "KCValueFormatter.h"
+#include "KCValueParser.h"
+
+Q_DECLARE_METATYPE(KCFormat::Type)
+
+void ValueFormatterBenchmark::initTestCase()
+{
+    m_calcsettings = new KCCalculationSettings();
+    m_parser = new KCValueParser(m_calcsettings);
+    m_converter = new KCValueConverter(m_parser);
+}
+
+void ValueFormatterBenchmark::cleanupTestCase()
+{
+    delete m_converter;
+    delete m_parser;
+    delete m_calcsettings;
+}
+
+void ValueFormatterBenchmark::testNumberFormatPerformance_data()
+{
+    QTest::addColumn<KCFormat::Type>("formatType");
+    QTest::addColumn<int>("precision");
+    QTest::addColumn<QString>("formatString");
+
+    QTest::newRow("number") << KCFormat::KCNumber << -1 << QString();
+    QTest::newRow("number 2 decimals") << KCFormat::KCNumber << 2 << QString();
+    QTest::newRow("thousands separated") << KCFormat::KCNumber << 2 << QString("#,##0.00");
+    QTest::newRow("money") << KCFormat::Money << 2 << QString();
+    QTest::newRow("money with symbol") << KCFormat::Money << 2 << QString("#,##0.00 EUR");
+    QTest::newRow("percentage") << KCFormat::Percentage << 1 << QString("0.0%");
+    QTest::newRow("scientific") << KCFormat::Scientific << 3 << QString("0.000E+00");
+}
+
+void ValueFormatterBenchmark::testNumberFormatPerformance()
+{
+    QFETCH(KCFormat::Type, formatType);
+    QFETCH(int, precision);
+    QFETCH(QString, formatString);
+
+    KCValueFormatter formatter(m_converter);
+    QBENCHMARK {
+        // a column of typical amounts
+        for (int i = 0; i < 1000; ++i) {
+            const KCValue value((i - 500) * 1234.5678);
+            formatter.formatText(value, formatType, precision, KCStyle::OnlyNegSigned,
+                                 QString(), QString(), QString(), formatString);
+        }
+    }
+}
+
+void ValueFormatterBenchmark::testDateTimeFormatPerformance_data()
+{
+    QTest::addColumn<KCFormat::Type>("formatType");
+    QTest::addColumn<QString>("formatString");
+
+    QTest::newRow("short date") << KCFormat::ShortDate << QString();
+    QTest::newRow("date format string") << KCFormat::ShortDate << QString("yyyy-MM-dd");
+    QTest::newRow("extra-short month") << KCFormat::ShortDate << QString("X-yy");
+    QTest::newRow("time") << KCFormat::Time << QString();
+    QTest::newRow("date and time") << KCFormat::DateTime << QString("dd.MM.yyyy hh:mm");
+}
+
+void ValueFormatterBenchmark::testDateTimeFormatPerformance()
+{
+    QFETCH(KCFormat::Type, formatType);
+    QFETCH(QString, formatString);
+
+    KCValueFormatter formatter(m_converter);
+    QBENCHMARK {
+        // a column of serial dates with times
+        for (int i = 0; i < 1000; ++i) {
+            const KCValue value(40000.25 + i);
+            formatter.formatText(value, formatType, -1, KCStyle::OnlyNegSigned,
+                                 QString(), QString(), QString(), formatString);
+        }
+    }
+}
+
+QTEST_MAIN(ValueFormatterBenchmark)
+
+#include "BenchmarkValueFormatter.moc"
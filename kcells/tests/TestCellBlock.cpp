@@ -0,0 +1,313 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "TestCellBlock.h"
+
+#include "qtest_kde.h"
+
+#include <QtCore/QMimeData>
+
+#include "commands/KCAutoFillCommand.h"
+#include "commands/KCCopyCommand.h"
+#include "commands/KCPasteCommand.h"
+#include "KCCell.h"
+#include "KCCellStorage.h"
+#include "KCMap.h"
+#include "KCRegion.h"
+#include "KCSheet.h"
+#include "KCStyle.h"
+
+namespace
+{
+// the copied cells in the source sheet
+const QRect source(2, 2, 3, 2); // B2:D3
+
+/**
+ * \return the formula of \p source copied to \p destination cell by cell
+ */
+QString moved(const KCCell& source, const KCCell& destination)
+{
+    return destination.decodeFormula(source.encodeFormula());
+}
+
+/**
+ * \return the source cell of \p destination for a paste at \p topLeft
+ */
+KCCell sourceCell(KCSheet* sheet, const QPoint& topLeft, const KCCell& destination)
+{
+    return KCCell(sheet, source.left() + (destination.column() - topLeft.x()) % source.width(),
+                  source.top() + (destination.row() - topLeft.y()) % source.height());
+}
+
+/**
+ * Copies \p region like CellToolBase::copy() does.
+ * \param block attach the cell block or only the XML snippet
+ */
+QMimeData* copy(const KCRegion& region, bool block)
+{
+    QMimeData* mimeData = new QMimeData();
+    mimeData->setData("application/x-kcells-snippet", KCCopyCommand::saveAsXml(region).toByteArray());
+    if (block)
+        KCCopyCommand::saveAsBlock(mimeData, region);
+    return mimeData;
+}
+
+/**
+ * Pastes \p mimeData into \p destination like CellToolBase::paste() does.
+ */
+KCPasteCommand* paste(const QMimeData* mimeData, KCSheet* sheet, const QRect& destination)
+{
+    KCPasteCommand* command = new KCPasteCommand();
+    command->setSheet(sheet);
+    command->add(KCRegion(destination, sheet));
+    command->setMimeData(mimeData);
+    command->setPasteFC(true);
+    command->redo();
+    return command;
+}
+
+/**
+ * Fills \p rect with old contents; some of the cells with an italic font.
+ */
+void fillOld(KCSheet* sheet, const QRect& rect)
+{
+    KCStyle italic;
+    italic.setFontItalic(true);
+    for (int row = rect.top(); row <= rect.bottom(); ++row) {
+        for (int col = rect.left(); col <= rect.right(); ++col) {
+            KCCell cell(sheet, col, row);
+            cell.parseUserInput(QString("old%1").arg(col * row));
+            if ((col + row) % 2)
+                cell.setStyle(italic);
+        }
+    }
+}
+}
+
+void TestCellBlock::init()
+{
+    m_map = new KCMap(0 /* no KCDoc */);
+    m_source = m_map->addNewSheet();
+    m_source->setSheetName("Sheet1");
+    m_other = m_map->addNewSheet();
+    m_other->setSheetName("Other");
+    m_block = m_map->addNewSheet();
+    m_block->setSheetName("Block");
+    m_xml = m_map->addNewSheet();
+    m_xml->setSheetName("Xml");
+
+    KCCell(m_other, 2, 2).parseUserInput("5");
+    KCCell(m_source, 1, 1).parseUserInput("1");
+    // B2:D3; D3 stays empty
+    KCCell(m_source, 2, 2).parseUserInput("=A1+C2");      // relative
+    KCCell(m_source, 3, 2).parseUserInput("=$A$1*2");     // absolute
+    KCCell(m_source, 3, 2).setComment("Note");
+    KCCell(m_source, 4, 2).parseUserInput("=A$1+$B2");    // mixed
+    KCCell(m_source, 2, 3).parseUserInput("=Other!B2+1"); // on another sheet
+    KCCell(m_source, 3, 3).setLink("http://www.koffice.org");
+    KCStyle bold;
+    bold.setFontBold(true);
+    KCCell(m_source, 3, 3).setStyle(bold);
+}
+
+void TestCellBlock::testNullBlock()
+{
+    QVERIFY(!m_source->cellStorage()->block(source).isNull());
+    m_source->cellStorage()->mergeCells(2, 2, 1, 0);
+    QVERIFY(m_source->cellStorage()->block(source).isNull());
+}
+
+void TestCellBlock::testMoveReferences()
+{
+    const KCCellBlock block = m_source->cellStorage()->block(source);
+    // moving up and left; overflowing references become #REF!
+    m_block->cellStorage()->pasteBlock(block, QRect(1, 1, 3, 2));
+    QCOMPARE(KCCell(m_block, 1, 1).userInput(), QString("=#REF!+B1"));
+    QCOMPARE(KCCell(m_block, 2, 1).userInput(), QString("=$A$1*2"));
+    QCOMPARE(KCCell(m_block, 3, 1).userInput(), QString("=#REF!+$B1"));
+    QCOMPARE(KCCell(m_block, 1, 2).userInput(), QString("=Other!A1+1"));
+
+    // moving down and right
+    const QRect destination(6, 5, 3, 2);
+    m_block->cellStorage()->pasteBlock(block, destination);
+    for (int row = destination.top(); row <= destination.bottom(); ++row) {
+        for (int col = destination.left(); col <= destination.right(); ++col) {
+            const KCCell cell(m_block, col, row);
+            const KCCell original = sourceCell(m_source, destination.topLeft(), cell);
+            if (original.isFormula())
+                QCOMPARE(cell.userInput(), moved(original, cell));
+        }
+    }
+    QCOMPARE(KCCell(m_block, 6, 5).userInput(), QString("=E4+G5"));
+    QCOMPARE(KCCell(m_block, 8, 5).userInput(), QString("=E$1+$F5"));
+}
+
+void TestCellBlock::testTiling()
+{
+    // two and a half tiles wide, one and a half tiles high
+    const QRect destination(8, 10, 8, 3);
+    fillOld(m_block, destination);
+    m_block->cellStorage()->pasteBlock(m_source->cellStorage()->block(source), destination);
+    for (int row = destination.top(); row <= destination.bottom(); ++row) {
+        for (int col = destination.left(); col <= destination.right(); ++col) {
+            const KCCell cell(m_block, col, row);
+            const KCCell original = sourceCell(m_source, destination.topLeft(), cell);
+            if (original.isFormula())
+                QCOMPARE(cell.userInput(), moved(original, cell));
+            else if (original.isEmpty())
+                QCOMPARE(cell.userInput(), QString("old%1").arg(col * row)); // kept
+            else
+                QCOMPARE(cell.userInput(), original.userInput());
+            QCOMPARE(cell.comment(), original.comment());
+            QCOMPARE(cell.link(), original.link());
+            QCOMPARE(cell.style().bold(), original.style().bold());
+            // the missing style of the source does not reset the old one
+            QCOMPARE(cell.style().italic(), bool((col + row) % 2));
+        }
+    }
+    // nothing beyond the destination
+    QCOMPARE(KCCell(m_block, 16, 10).userInput(), QString());
+    QCOMPARE(KCCell(m_block, 8, 13).userInput(), QString());
+}
+
+void TestCellBlock::testPasteLikeXml()
+{
+    const KCRegion region(source, m_source);
+    QMimeData* const blockData = copy(region, true);
+    QMimeData* const xmlData = copy(region, false);
+    QVERIFY(blockData->property("kcells-cell-block").isValid());
+    QVERIFY(!xmlData->property("kcells-cell-block").isValid());
+
+    const QRect destination(8, 10, 5, 3);
+    const QRect area = destination.adjusted(-1, -1, 1, 1);
+    fillOld(m_block, area);
+    fillOld(m_xml, area);
+    KCPasteCommand* const blockCommand = paste(blockData, m_block, destination);
+    KCPasteCommand* const xmlCommand = paste(xmlData, m_xml, destination);
+
+    for (int row = area.top(); row <= area.bottom(); ++row) {
+        for (int col = area.left(); col <= area.right(); ++col) {
+            const KCCell cell(m_block, col, row);
+            const KCCell expected(m_xml, col, row);
+            QCOMPARE(cell.userInput(), expected.userInput());
+            if (!expected.isFormula())
+                QCOMPARE(cell.value(), expected.value());
+            QCOMPARE(cell.comment(), expected.comment());
+            QCOMPARE(cell.link(), expected.link());
+            QVERIFY(cell.style() == expected.style());
+        }
+    }
+
+    delete blockCommand;
+    delete xmlCommand;
+    delete blockData;
+    delete xmlData;
+}
+
+void TestCellBlock::testUndoRedo()
+{
+    QMimeData* const mimeData = copy(KCRegion(source, m_source), true);
+    const QRect destination(8, 10, 6, 4);
+    const QRect area = destination.adjusted(-1, -1, 1, 1);
+    fillOld(m_block, area);
+
+    QList<QString> oldInputs;
+    QList<KCStyle> oldStyles;
+    for (int row = area.top(); row <= area.bottom(); ++row) {
+        for (int col = area.left(); col <= area.right(); ++col) {
+            oldInputs.append(KCCell(m_block, col, row).userInput());
+            oldStyles.append(KCCell(m_block, col, row).style());
+        }
+    }
+
+    KCPasteCommand* const command = paste(mimeData, m_block, destination);
+    // one record for the whole block instead of one for each cell
+    QCOMPARE(command->childCount(), 1);
+    QList<QString> newInputs;
+    QList<KCStyle> newStyles;
+    for (int row = area.top(); row <= area.bottom(); ++row) {
+        for (int col = area.left(); col <= area.right(); ++col) {
+            newInputs.append(KCCell(m_block, col, row).userInput());
+            newStyles.append(KCCell(m_block, col, row).style());
+        }
+    }
+    QVERIFY(newInputs != oldInputs);
+
+    command->undo();
+    int i = 0;
+    for (int row = area.top(); row <= area.bottom(); ++row) {
+        for (int col = area.left(); col <= area.right(); ++col, ++i) {
+            QCOMPARE(KCCell(m_block, col, row).userInput(), oldInputs[i]);
+            QVERIFY(KCCell(m_block, col, row).style() == oldStyles[i]);
+            QCOMPARE(KCCell(m_block, col, row).comment(), QString());
+            QCOMPARE(KCCell(m_block, col, row).link(), QString());
+        }
+    }
+
+    command->redo();
+    i = 0;
+    for (int row = area.top(); row <= area.bottom(); ++row) {
+        for (int col = area.left(); col <= area.right(); ++col, ++i) {
+            QCOMPARE(KCCell(m_block, col, row).userInput(), newInputs[i]);
+            QVERIFY(KCCell(m_block, col, row).style() == newStyles[i]);
+        }
+    }
+
+    delete command;
+    delete mimeData;
+}
+
+void TestCellBlock::testFillFormulas()
+{
+    // a column of formulas filled to the right
+    const QRect column(2, 2, 1, 2); // B2:B3
+    const QRect target(2, 2, 5, 2); // B2:F3
+    KCStyle bold;
+    bold.setFontBold(true);
+    KCCell(m_source, 2, 3).setStyle(bold);
+    KCAutoFillCommand* const command = new KCAutoFillCommand();
+    command->setSheet(m_source);
+    command->setSourceRange(column);
+    command->setTargetRange(target);
+    command->add(KCRegion(target, m_source));
+    command->redo();
+
+    // the same as filling the cells one by one
+    for (int row = target.top(); row <= target.bottom(); ++row) {
+        const KCCell original(m_source, column.left(), row);
+        for (int col = column.right() + 1; col <= target.right(); ++col) {
+            const KCCell cell(m_source, col, row);
+            QCOMPARE(cell.userInput(), moved(original, cell));
+            QVERIFY(cell.style() == original.style());
+        }
+    }
+    QCOMPARE(KCCell(m_source, 6, 2).userInput(), QString("=E1+G2"));
+    QCOMPARE(KCCell(m_source, 6, 3).userInput(), QString("=Other!F2+1"));
+    QVERIFY(KCCell(m_source, 6, 3).style().bold());
+    delete command;
+}
+
+void TestCellBlock::cleanup()
+{
+    delete m_map;
+}
+
+QTEST_KDEMAIN(TestCellBlock, GUI)
+
+#include "TestCellBlock.moc"
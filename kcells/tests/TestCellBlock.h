@@ -0,0 +1,51 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KCELLS_TEST_CELL_BLOCK
+#define KCELLS_TEST_CELL_BLOCK
+
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+class KCMap;
+class KCSheet;
+
+class TestCellBlock : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void testNullBlock();
+    void testMoveReferences();
+    void testTiling();
+    void testPasteLikeXml();
+    void testUndoRedo();
+    void testFillFormulas();
+    void cleanup();
+
+private:
+    KCMap* m_map;
+    KCSheet* m_source;
+    KCSheet* m_other;
+    KCSheet* m_block;
+    KCSheet* m_xml;
+};
+
+#endif // KCELLS_TEST_CELL_BLOCK
@@ -0,0 +1,142 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "TestDamages.h"
+
+#include "qtest_kde.h"
+
+#include "commands/KCAbstractRegionCommand.h"
+#include "KCCellStorage.h"
+#include "Damages.h"
+#include "KCMap.h"
+#include "KCSheet.h"
+#include "KCValue.h"
+
+namespace
+{
+/**
+ * Sets the cells one by one and lets the events be processed in between,
+ * like a long running command updating its progress.
+ */
+class FillCommand : public KCAbstractRegionCommand
+{
+protected:
+    virtual bool process(Element* element) {
+        const QRect range = element->rect();
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            for (int col = range.left(); col <= range.right(); ++col)
+                m_sheet->cellStorage()->setValue(col, row, KCValue(col * row));
+            QApplication::processEvents();
+        }
+        return true;
+    }
+};
+}
+
+void TestDamages::damagesFlushed(const QList<KCDamage*>& damages)
+{
+    ++m_flushes;
+    foreach(const KCDamage* damage, damages) {
+        if (damage->type() != KCDamage::DamagedCell)
+            continue;
+        const KCCellDamage* const cellDamage = static_cast<const KCCellDamage*>(damage);
+        if (cellDamage->changes() & KCCellDamage::KCValue)
+            m_valueRegions.append(cellDamage->region());
+    }
+}
+
+void TestDamages::initTestCase()
+{
+    m_map = new KCMap(0 /* no KCDoc */);
+    m_sheet = m_map->addNewSheet();
+    m_sheet->setSheetName("Sheet1");
+    connect(m_map, SIGNAL(damagesFlushed(const QList<KCDamage*>&)),
+            this, SLOT(damagesFlushed(const QList<KCDamage*>&)));
+}
+
+void TestDamages::init()
+{
+    QApplication::processEvents(); // handle the remaining Damages
+    m_flushes = 0;
+    m_valueRegions.clear();
+}
+
+void TestDamages::testBatch()
+{
+    m_map->beginDamageBatch();
+    m_sheet->cellStorage()->setValue(1, 1, KCValue(1));
+    m_sheet->cellStorage()->setValue(2, 1, KCValue(2));
+    QApplication::processEvents();
+    QCOMPARE(m_flushes, 0);
+
+    m_sheet->cellStorage()->setValue(1, 2, KCValue(3));
+    m_sheet->cellStorage()->setValue(2, 2, KCValue(4));
+    m_map->endDamageBatch();
+    QApplication::processEvents();
+    QCOMPARE(m_flushes, 1);
+    QCOMPARE(m_valueRegions.count(), 1);
+    QCOMPARE(m_valueRegions.first().rects().count(), 1);
+    QCOMPARE(m_valueRegions.first().boundingRect(), QRect(1, 1, 2, 2));
+}
+
+void TestDamages::testNestedBatches()
+{
+    m_map->beginDamageBatch();
+    m_sheet->cellStorage()->setValue(5, 1, KCValue(1));
+    m_map->beginDamageBatch();
+    m_sheet->cellStorage()->setValue(5, 2, KCValue(2));
+    m_map->endDamageBatch();
+    // the inner batch does not flush the damages
+    QApplication::processEvents();
+    QCOMPARE(m_flushes, 0);
+
+    m_sheet->cellStorage()->setValue(5, 3, KCValue(3));
+    m_map->endDamageBatch();
+    QApplication::processEvents();
+    QCOMPARE(m_flushes, 1);
+    QCOMPARE(m_valueRegions.count(), 1);
+    QCOMPARE(m_valueRegions.first().boundingRect(), QRect(5, 1, 1, 3));
+}
+
+void TestDamages::testBatchedCommand()
+{
+    FillCommand command;
+    command.setSheet(m_sheet);
+    command.setRegisterUndo(false);
+    command.add(QRect(10, 1, 3, 4));
+    command.redo();
+    // kept back, although the events were processed after each row
+    QCOMPARE(m_flushes, 0);
+
+    QApplication::processEvents();
+    QCOMPARE(m_flushes, 1);
+    QCOMPARE(m_valueRegions.count(), 1);
+    QCOMPARE(m_valueRegions.first().rects().count(), 1);
+    QCOMPARE(m_valueRegions.first().boundingRect(), QRect(10, 1, 3, 4));
+    QCOMPARE(m_sheet->cellStorage()->value(12, 4), KCValue(48));
+}
+
+void TestDamages::cleanupTestCase()
+{
+    delete m_map;
+}
+
+QTEST_KDEMAIN(TestDamages, GUI)
+
+#include "TestDamages.moc"
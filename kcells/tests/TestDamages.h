@@ -0,0 +1,56 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KCELLS_TEST_DAMAGES
+#define KCELLS_TEST_DAMAGES
+
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+#include "KCRegion.h"
+
+class KCDamage;
+class KCMap;
+class KCSheet;
+
+class TestDamages : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void damagesFlushed(const QList<KCDamage*>& damages);
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void testBatch();
+    void testNestedBatches();
+    void testBatchedCommand();
+    void cleanupTestCase();
+
+private:
+    KCMap* m_map;
+    KCSheet* m_sheet;
+    // the number of flushes
+    int m_flushes;
+    // the regions of the flushed value damages
+    QList<KCRegion> m_valueRegions;
+};
+
+#endif // KCELLS_TEST_DAMAGES
@@ -0,0 +1,217 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "TestDataPilot.h"
+
+#include "qtest_kde.h"
+
+#include "database/DataPilot.h"
+#include "database/DatabaseManager.h"
+#include "KCCellStorage.h"
+#include "KCMap.h"
+#include "KCRegion.h"
+#include "KCSheet.h"
+#include "KCValue.h"
+
+void TestDataPilot::initTestCase()
+{
+    m_map = new KCMap(0 /* no KCDoc */);
+    m_sheet = m_map->addNewSheet();
+    KCCellStorage* storage = m_sheet->cellStorage();
+
+    // A1:C5
+    storage->setValue(1, 1, KCValue("Region"));
+    storage->setValue(2, 1, KCValue("Product"));
+    storage->setValue(3, 1, KCValue("Sales"));
+    storage->setValue(1, 2, KCValue("North"));
+    storage->setValue(2, 2, KCValue("X"));
+    storage->setValue(3, 2, KCValue(10));
+    storage->setValue(1, 3, KCValue("South"));
+    storage->setValue(2, 3, KCValue("X"));
+    storage->setValue(3, 3, KCValue(5));
+    storage->setValue(1, 4, KCValue("North"));
+    storage->setValue(2, 4, KCValue("Y"));
+    storage->setValue(3, 4, KCValue(7));
+    storage->setValue(1, 5, KCValue("South"));
+    storage->setValue(2, 5, KCValue("Y"));
+    storage->setValue(3, 5, KCValue(1));
+}
+
+void TestDataPilot::testRefresh()
+{
+    KCCellStorage* storage = m_sheet->cellStorage();
+    DataPilot dataPilot("DataPilot1");
+    dataPilot.setSourceRange(KCRegion(QRect(1, 1, 3, 5), m_sheet));
+    dataPilot.setTargetRange(KCRegion(QPoint(5, 1), m_sheet));
+    dataPilot.addField("Region", DataPilot::Row);
+    dataPilot.addField("Product", DataPilot::Column);
+    dataPilot.addField("Sales", DataPilot::Data, DataPilot::Sum);
+    dataPilot.refresh();
+
+    QCOMPARE(dataPilot.targetRange(), KCRegion(QRect(5, 1, 3, 3), m_sheet));
+    QCOMPARE(storage->value(5, 1), KCValue("Region"));
+    QCOMPARE(storage->value(6, 1), KCValue("X - Sum - Sales"));
+    QCOMPARE(storage->value(7, 1), KCValue("Y - Sum - Sales"));
+    QCOMPARE(storage->value(5, 2), KCValue("North"));
+    QCOMPARE(storage->value(6, 2), KCValue(10.0));
+    QCOMPARE(storage->value(7, 2), KCValue(7.0));
+    QCOMPARE(storage->value(5, 3), KCValue("South"));
+    QCOMPARE(storage->value(6, 3), KCValue(5.0));
+    QCOMPARE(storage->value(7, 3), KCValue(1.0));
+
+    // a smaller summary clears the rest of the former one
+    DataPilot smaller(dataPilot.name());
+    smaller.setSourceRange(dataPilot.sourceRange());
+    smaller.setTargetRange(dataPilot.targetRange());
+    smaller.addField("Region", DataPilot::Row);
+    smaller.addField("Sales", DataPilot::Data, DataPilot::Average);
+    smaller.refresh();
+
+    QCOMPARE(smaller.targetRange(), KCRegion(QRect(5, 1, 2, 3), m_sheet));
+    QCOMPARE(storage->value(6, 2), KCValue(8.5));
+    QCOMPARE(storage->value(6, 3), KCValue(3.0));
+    QCOMPARE(storage->value(7, 2), KCValue());
+}
+
+void TestDataPilot::testUpdate()
+{
+    KCCellStorage* storage = m_sheet->cellStorage();
+    DataPilot dataPilot("DataPilot2");
+    dataPilot.setSourceRange(KCRegion(QRect(1, 1, 3, 5), m_sheet));
+    dataPilot.setTargetRange(KCRegion(QPoint(10, 1), m_sheet));
+    dataPilot.addField("Region", DataPilot::Row);
+    dataPilot.addField("Sales", DataPilot::Data, DataPilot::Max);
+    dataPilot.refresh();
+
+    QCOMPARE(storage->value(11, 2), KCValue(10.0));
+    QCOMPARE(storage->value(11, 3), KCValue(5.0));
+
+    // a changed value updates its group only
+    storage->setValue(3, 2, KCValue(3));
+    dataPilot.update(KCRegion(QPoint(3, 2), m_sheet));
+    QCOMPARE(storage->value(11, 2), KCValue(7.0));
+    QCOMPARE(storage->value(11, 3), KCValue(5.0));
+
+    // a new group rearranges the summary
+    storage->setValue(1, 5, KCValue("East"));
+    dataPilot.update(KCRegion(QPoint(1, 5), m_sheet));
+    QCOMPARE(dataPilot.targetRange(), KCRegion(QRect(10, 1, 2, 4), m_sheet));
+    QCOMPARE(storage->value(10, 2), KCValue("East"));
+    QCOMPARE(storage->value(11, 2), KCValue(1.0));
+    QCOMPARE(storage->value(10, 3), KCValue("North"));
+    QCOMPARE(storage->value(11, 3), KCValue(7.0));
+    QCOMPARE(storage->value(10, 4), KCValue("South"));
+    QCOMPARE(storage->value(11, 4), KCValue(5.0));
+
+    storage->setValue(3, 2, KCValue(10));
+    storage->setValue(1, 5, KCValue("South"));
+}
+
+void TestDataPilot::testDistinctKeys()
+{
+    KCCellStorage* storage = m_sheet->cellStorage();
+    // T1:U6
+    storage->setValue(20, 1, KCValue("Key"));
+    storage->setValue(21, 1, KCValue("Amount"));
+    storage->setValue(20, 2, KCValue(1.0));
+    storage->setValue(21, 2, KCValue(2));
+    storage->setValue(20, 3, KCValue("1"));
+    storage->setValue(21, 3, KCValue(3));
+    storage->setValue(20, 4, KCValue(1.0000000001));
+    storage->setValue(21, 4, KCValue(4));
+    storage->setValue(20, 5, KCValue(1.0));
+    storage->setValue(21, 5, KCValue(5));
+    storage->setValue(20, 6, KCValue(1)); // an integer
+    storage->setValue(21, 6, KCValue(6));
+
+    DataPilot dataPilot("DataPilot3");
+    dataPilot.setSourceRange(KCRegion(QRect(20, 1, 2, 6), m_sheet));
+    dataPilot.setTargetRange(KCRegion(QPoint(24, 1), m_sheet));
+    dataPilot.addField("Key", DataPilot::Row);
+    dataPilot.addField("Amount", DataPilot::Data, DataPilot::Sum);
+    dataPilot.refresh();
+
+    // the number 1, the text "1" and a number formatted like 1 are distinct groups;
+    // the integer 1 and the float 1.0 are one group
+    QCOMPARE(dataPilot.targetRange(), KCRegion(QRect(24, 1, 2, 4), m_sheet));
+    QList<double> sums;
+    for (int row = 2; row <= 4; ++row)
+        sums.append(storage->value(25, row).asFloat());
+    qSort(sums);
+    QCOMPARE(sums, QList<double>() << 3.0 << 4.0 << 13.0);
+}
+
+void TestDataPilot::testShiftRanges()
+{
+    KCSheet* sheet = m_map->addNewSheet();
+    KCCellStorage* storage = sheet->cellStorage();
+    // A1:B4
+    storage->setValue(1, 1, KCValue("Key"));
+    storage->setValue(2, 1, KCValue("Amount"));
+    storage->setValue(1, 2, KCValue("x"));
+    storage->setValue(2, 2, KCValue(1));
+    storage->setValue(1, 3, KCValue("y"));
+    storage->setValue(2, 3, KCValue(2));
+    storage->setValue(1, 4, KCValue("x"));
+    storage->setValue(2, 4, KCValue(3));
+
+    DataPilot dataPilot("DataPilot4");
+    dataPilot.setSourceRange(KCRegion(QRect(1, 1, 2, 4), sheet));
+    dataPilot.setTargetRange(KCRegion(QPoint(4, 1), sheet));
+    dataPilot.addField("Key", DataPilot::Row);
+    dataPilot.addField("Amount", DataPilot::Data, DataPilot::Sum);
+    DatabaseManager* manager = m_map->databaseManager();
+    manager->addDataPilot(dataPilot);
+    QCOMPARE(manager->dataPilots().last().targetRange(), KCRegion(QRect(4, 1, 2, 3), sheet));
+
+    // an inserted row moves both ranges down
+    sheet->insertRows(1, 1);
+    storage->insertRows(1, 1);
+    QCOMPARE(manager->dataPilots().last().sourceRange(), KCRegion(QRect(1, 2, 2, 4), sheet));
+    QCOMPARE(manager->dataPilots().last().targetRange(), KCRegion(QRect(4, 2, 2, 3), sheet));
+
+    // an inserted column between the ranges moves the target only
+    sheet->insertColumns(3, 1);
+    storage->insertColumns(3, 1);
+    QCOMPARE(manager->dataPilots().last().sourceRange(), KCRegion(QRect(1, 2, 2, 4), sheet));
+    QCOMPARE(manager->dataPilots().last().targetRange(), KCRegion(QRect(5, 2, 2, 3), sheet));
+
+    sheet->removeColumns(3, 1);
+    storage->removeColumns(3, 1);
+    QCOMPARE(manager->dataPilots().last().targetRange(), KCRegion(QRect(4, 2, 2, 3), sheet));
+
+    // a changed value updates the summary at its new location
+    storage->setValue(2, 3, KCValue(10));
+    manager->regionChanged(KCRegion(QPoint(2, 3), sheet));
+    QCOMPARE(storage->value(4, 3), KCValue("x"));
+    QCOMPARE(storage->value(5, 3), KCValue(13.0));
+    QCOMPARE(storage->value(4, 4), KCValue("y"));
+    QCOMPARE(storage->value(5, 4), KCValue(2.0));
+
+    manager->removeDataPilot(dataPilot.name());
+}
+
+void TestDataPilot::cleanupTestCase()
+{
+    delete m_map;
+}
+
+QTEST_KDEMAIN(TestDataPilot, GUI)
+
+#include "TestDataPilot.moc"
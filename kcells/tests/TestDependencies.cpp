@@ -29,6 +29,7 @@
 #include "KCRegion.h"
 #include "KCSheet.h"
 #include "KCValue.h"
+#include "KCWhatIfEvaluator.h"
 
 void TestDependencies::initTestCase()
 {
@@ -81,6 +82,101 @@ void TestDependencies::testCircles()
     QCOMPARE(m_storage->value(1, 3), KCValue::errorCIRCLE());
 }
 
+void TestDependencies::testWhatIf()
+{
+    m_storage->setValue(2, 1, KCValue(2)); // B1
+    KCFormula formula(m_sheet);
+    formula.setExpression("=B1*3");
+    m_storage->setFormula(2, 2, formula); // B2
+    formula.setExpression("=SUM(B1:B2)+1");
+    m_storage->setFormula(2, 3, formula); // B3
+
+    QApplication::processEvents(); // handle Damages
+
+    QCOMPARE(m_storage->value(2, 3).asInteger(), qint64(9));
+
+    const KCWhatIfEvaluator evaluator(m_storage->formula(2, 3), QList<KCCell>() << KCCell(m_sheet, 2, 1));
+    QCOMPARE(evaluator.evaluate(QVector<KCValue>() << KCValue(5)).asInteger(), qint64(21));
+
+    QList<QVector<KCValue> > trials;
+    trials << (QVector<KCValue>() << KCValue(1)) << (QVector<KCValue>() << KCValue(5));
+    const QVector<KCValue> results = evaluator.evaluate(trials);
+    QCOMPARE(results.count(), 2);
+    QCOMPARE(results[0].asInteger(), qint64(5));
+    QCOMPARE(results[1].asInteger(), qint64(21));
+
+    // the cells are not altered
+    QCOMPARE(m_storage->value(2, 1), KCValue(2));
+    QCOMPARE(m_storage->value(2, 2).asInteger(), qint64(6));
+    QCOMPARE(m_storage->value(2, 3).asInteger(), qint64(9));
+}
+
+void TestDependencies::testUpdateAllDependencies()
+{
+    // A map of its own, whose damages are never processed, like on loading.
+    KCMap map(0 /* no KCDoc */);
+    KCSheet* sheet1 = map.addNewSheet();
+    sheet1->setSheetName("Sheet1");
+    KCSheet* sheet2 = map.addNewSheet();
+    sheet2->setSheetName("Sheet2");
+    KCCellStorage* storage1 = sheet1->cellStorage();
+    KCCellStorage* storage2 = sheet2->cellStorage();
+
+    KCFormula formula(sheet1);
+    storage1->setValue(2, 1, KCValue(2)); // B1
+    formula.setExpression("=B1*3");
+    storage1->setFormula(2, 2, formula); // B2
+    formula.setExpression("=SUM(B1:B2)+1");
+    storage1->setFormula(2, 3, formula); // B3
+    // flagged as circular in the loaded file
+    formula.setExpression("=B1");
+    storage1->setFormula(5, 1, formula); // E1
+    storage1->setValue(5, 1, KCValue::errorCIRCLE());
+    formula.setExpression("=E1");
+    storage1->setFormula(5, 2, formula); // E2
+
+    formula = KCFormula(sheet2);
+    formula.setExpression("=1");
+    storage2->setFormula(3, 1, formula); // C1
+    formula.setExpression("=C1+Sheet1!B1");
+    storage2->setFormula(3, 2, formula); // C2
+    formula.setExpression("=SUM(C1:C2)");
+    storage2->setFormula(3, 3, formula); // C3
+    formula.setExpression("=D2");
+    storage2->setFormula(4, 1, formula); // D1
+    formula.setExpression("=D1");
+    storage2->setFormula(4, 2, formula); // D2
+    formula.setExpression("=D1+1");
+    storage2->setFormula(4, 3, formula); // D3
+
+    KCDependencyManager* manager = map.dependencyManager();
+    manager->updateAllDependencies(&map);
+
+    const QHash<KCCell, int> depths = manager->depths();
+    QCOMPARE(depths.count(), 10);
+    QCOMPARE(depths.value(KCCell(sheet1, 2, 2)), 1);
+    QCOMPARE(depths.value(KCCell(sheet1, 2, 3)), 2);
+    QCOMPARE(depths.value(KCCell(sheet1, 5, 1)), 0);
+    QCOMPARE(depths.value(KCCell(sheet1, 5, 2)), 1);
+    QCOMPARE(depths.value(KCCell(sheet2, 3, 1)), 0);
+    QCOMPARE(depths.value(KCCell(sheet2, 3, 2)), 1);
+    QCOMPARE(depths.value(KCCell(sheet2, 3, 3)), 2);
+    QCOMPARE(depths.value(KCCell(sheet2, 4, 1)), 0);
+    QCOMPARE(depths.value(KCCell(sheet2, 4, 2)), 0);
+    QCOMPARE(depths.value(KCCell(sheet2, 4, 3)), 1);
+
+    QCOMPARE(storage1->value(5, 1), KCValue::errorCIRCLE());
+    QCOMPARE(storage1->value(5, 2), KCValue());
+    QCOMPARE(storage2->value(4, 1), KCValue::errorCIRCLE());
+    QCOMPARE(storage2->value(4, 2), KCValue::errorCIRCLE());
+    QCOMPARE(storage2->value(4, 3), KCValue());
+
+    // B1 is consumed by B2, B3, E1 and Sheet2!C2
+    QCOMPARE(manager->d->consumers.value(sheet1)->contains(QRect(2, 1, 1, 1)).count(), 4);
+    QCOMPARE(manager->d->consumers.value(sheet2)->contains(QRect(3, 1, 1, 1)).count(), 2);
+    QCOMPARE(manager->d->providers.value(KCCell(sheet2, 3, 3)), KCRegion(QRect(3, 1, 1, 2), sheet2));
+}
+
 void TestDependencies::cleanupTestCase()
 {
     delete m_map;
@@ -35,6 +35,8 @@ private Q_SLOTS:
     void initTestCase();
     void testCircleRemoval();
     void testCircles();
+    void testWhatIf();
+    void testUpdateAllDependencies();
     void cleanupTestCase();
 
 private:
@@ -270,6 +270,16 @@ void TestInformationFunctions::testCOUNTIF()
     CHECK_EVAL("COUNTIF(\"\";B4)",        KCValue::errorNA());   // Constant values are not allowed for the range.
     CHECK_EVAL("COUNTIF(B3:B10;\"7\")",   KCValue(1));           // [.B3] is the string "7".
     CHECK_EVAL("COUNTIF(B3:B10;1+1)",     KCValue(1));           // The criteria can be an expression.
+
+    // repeated criteria on the same cells use an index, that has to follow the cell changes
+    KCCellStorage* storage = m_map->sheet(0)->cellStorage();
+    CHECK_EVAL("COUNTIF(B4:B5;\">=2\")",  KCValue(2));
+    CHECK_EVAL("COUNTIF(B4:B5;\"<>2\")",  KCValue(1));
+    CHECK_EVAL("COUNTIF(B4:B5;2)",        KCValue(1));
+    storage->setValue(2, 5, KCValue(2));
+    CHECK_EVAL("COUNTIF(B4:B5;2)",        KCValue(2));
+    storage->setValue(2, 5, KCValue(3));
+    CHECK_EVAL("COUNTIF(B4:B5;2)",        KCValue(1));
 }
 
 void TestInformationFunctions::testERRORTYPE()
@@ -287,6 +297,19 @@ void TestInformationFunctions::testFORMULA()
 }
 */
 
+void TestInformationFunctions::testHLOOKUP()
+{
+    // exact match; case sensitive
+    CHECK_EVAL("HLOOKUP(\"kde\";A1000:G1000;1;0)", KCValue("kde"));
+    CHECK_EVAL("HLOOKUP(\"KDE\";A1000:G1000;1;0)", KCValue::errorNA());
+    CHECK_EVAL("HLOOKUP(\"epub\";A1000:G1000;1;0)", KCValue::errorNA());
+
+    // range lookup, the greatest value lower than the searched one
+    CHECK_EVAL("HLOOKUP(\"epub\";A1000:G1000;1)", KCValue("efoob"));
+    CHECK_EVAL("HLOOKUP(\"zzz\";A1000:G1000;1)", KCValue("xxx"));
+    CHECK_EVAL("HLOOKUP(\"aaa\";A1000:G1000;1)", KCValue::errorNA());
+}
+
 void TestInformationFunctions::testINFO()
 {
     CHECK_EVAL("INFO(\"recalc\")",             KCValue("Automatic"));     //
@@ -549,6 +572,14 @@ void TestInformationFunctions::testMATCH()
     CHECK_EVAL("MATCH(\"hello\";B3:B10;0)", KCValue(5)); // match is always case insensitive
     CHECK_EVAL("MATCH(\"kde\";A1000:G1000;0)", KCValue(5));
 
+    // repeated searches use an index, that has to follow the cell changes
+    KCCellStorage* storage = m_map->sheet(0)->cellStorage();
+    CHECK_EVAL("MATCH(7;C11:C17;0)", KCValue::errorNA());
+    storage->setValue(3, 16, KCValue(7));
+    CHECK_EVAL("MATCH(7;C11:C17;0)", KCValue(6));
+    storage->setValue(3, 16, KCValue(2));
+    CHECK_EVAL("MATCH(7;C11:C17;0)", KCValue::errorNA());
+
     // matchType == 1 or omitted, largest value less than or equal to search value in sorted range
     CHECK_EVAL("MATCH(0;A19:A31;1)", KCValue::errorNA());
     CHECK_EVAL("MATCH(1;A19:A31;1)", KCValue(1));
@@ -575,6 +606,14 @@ void TestInformationFunctions::testMATCH()
     CHECK_EVAL("MATCH(13;C11:D13;-1)", KCValue::errorNA()); // not sure if this is the best error
 }
 
+void TestInformationFunctions::testVLOOKUP()
+{
+    CHECK_EVAL("VLOOKUP(8;C11:C17;1;0)", KCValue(8));
+    CHECK_EVAL("VLOOKUP(1;C11:C17;1)", KCValue(1));
+    CHECK_EVAL("VLOOKUP(9;C11:C17;1;0)", KCValue::errorNA());
+    CHECK_EVAL("VLOOKUP(8;C11:C17;2;0)", KCValue::errorVALUE());
+}
+
 //
 // cleanup test
 //
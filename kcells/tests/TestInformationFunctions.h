@@ -45,6 +45,7 @@ private slots:
     void testCOUNTBLANK();
     void testCOUNTIF();
     void testERRORTYPE();
+    void testHLOOKUP();
     // void testFORMULA();  // to be implemented
     void testINFO();
     void testISBLANK();
@@ -69,6 +70,7 @@ private slots:
     // void testSHEETS();      // to be implemented
     void testTYPE();
     void testVALUE();
+    void testVLOOKUP();
 
     void cleanupTestCase();
 
@@ -847,6 +847,16 @@ void TestMathFunctions::testSUMIF()
     CHECK_EVAL("SUMIF(B3:B4;\"7\";B4:B5)", KCValue(2));     // B3 is the string "7", but its match is mapped to B4 for the summation.
     CHECK_EVAL("SUMIF(B3:B10;1+1)",        KCValue(2));     // The criteria can be an expression.
     CHECK_EVAL("SUMIF(B3:B4;\"7\")",       KCValue(0));     // TODO B3 is the string "7", but only numbers are summed.
+
+    // repeated criteria on the same cells use an index, that has to follow the cell changes
+    KCCellStorage* storage = m_map->sheet(0)->cellStorage();
+    CHECK_EVAL("SUMIF(B3:B5;\">=2\")",     KCValue(5));
+    CHECK_EVAL("SUMIF(B3:B5;\"<>3\")",     KCValue(2));
+    CHECK_EVAL("SUMIF(B3:B5;\"<3\";B4:B6)", KCValue(3));
+    storage->setValue(2, 5, KCValue(4));
+    CHECK_EVAL("SUMIF(B3:B5;\">=2\")",     KCValue(6));
+    storage->setValue(2, 5, KCValue(3));
+    CHECK_EVAL("SUMIF(B3:B5;\">=2\")",     KCValue(5));
 }
 
 void TestMathFunctions::testSUMSQ()
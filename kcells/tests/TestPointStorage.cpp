@@ -1194,6 +1194,88 @@ void PointStorageTest::testSubStorage()
 // #endif
 }
 
+void PointStorageTest::testDataInRect()
+{
+    KCPointStorage<int> storage;
+    storage.m_data << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9 << 10 << 11 << 12;
+    storage.m_rows << 0 << 3 << 6 << 9 << 10;
+    storage.m_cols << 1 << 2 << 5 << 1 << 2 << 3 << 2 << 3 << 5 << 4 << 1 << 5;
+    // ( 1, 2,  ,  , 3)
+    // ( 4, 5, 6,  ,  )
+    // (  , 7, 8,  , 9)
+    // (  ,  ,  ,10,  )
+    // (11,  ,  ,  ,12)
+
+    QVector< QPair<QPoint, int> > pairs = storage.dataInRect(QRect(2, 2, 2, 10));
+    // ( 5, 6)
+    // ( 7, 8)
+    // (  ,  )
+    // (  ,  )
+    QCOMPARE(pairs.count(), 4);
+    QCOMPARE(pairs[0].first, QPoint(2, 2));
+    QCOMPARE(pairs[0].second, 5);
+    QCOMPARE(pairs[1].first, QPoint(3, 2));
+    QCOMPARE(pairs[1].second, 6);
+    QCOMPARE(pairs[2].first, QPoint(2, 3));
+    QCOMPARE(pairs[2].second, 7);
+    QCOMPARE(pairs[3].first, QPoint(3, 3));
+    QCOMPARE(pairs[3].second, 8);
+
+    pairs = storage.dataInRect(QRect(5, 1, 1, 5));
+    QCOMPARE(pairs.count(), 3);
+    QCOMPARE(pairs[0].second, 3);
+    QCOMPARE(pairs[1].second, 9);
+    QCOMPARE(pairs[2].second, 12);
+    QCOMPARE(pairs[2].first, QPoint(5, 5));
+
+    QVERIFY(storage.dataInRect(QRect(4, 1, 1, 3)).isEmpty());
+    QVERIFY(storage.dataInRect(QRect(1, 6, 5, 5)).isEmpty());
+}
+
+void PointStorageTest::testSetDataInRect()
+{
+    KCPointStorage<int> storage;
+    storage.m_data << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9 << 10 << 11 << 12;
+    storage.m_rows << 0 << 3 << 6 << 9 << 10;
+    storage.m_cols << 1 << 2 << 5 << 1 << 2 << 3 << 2 << 3 << 5 << 4 << 1 << 5;
+    // ( 1, 2,  ,  , 3)
+    // ( 4, 5, 6,  ,  )
+    // (  , 7, 8,  , 9)
+    // (  ,  ,  ,10,  )
+    // (11,  ,  ,  ,12)
+
+    QVector< QPair<QPoint, int> > data;
+    data << qMakePair(QPoint(3, 2), 20) << qMakePair(QPoint(2, 3), 21);
+    QVector< QPair<QPoint, int> > oldData = storage.setDataInRect(QRect(2, 2, 2, 2), data);
+    // ( 1, 2,  ,  , 3)
+    // ( 4,  ,20,  ,  )
+    // (  ,21,  ,  , 9)
+    // (  ,  ,  ,10,  )
+    // (11,  ,  ,  ,12)
+    QCOMPARE(oldData.count(), 4);
+    QCOMPARE(oldData[0].first, QPoint(2, 2));
+    QCOMPARE(oldData[0].second, 5);
+    QCOMPARE(oldData[3].first, QPoint(3, 3));
+    QCOMPARE(oldData[3].second, 8);
+    QCOMPARE(storage.m_data, QVector<int>() << 1 << 2 << 3 << 4 << 20 << 21 << 9 << 10 << 11 << 12);
+    QCOMPARE(storage.m_rows, QVector<int>() << 0 << 3 << 5 << 7 << 8);
+    QCOMPARE(storage.m_cols, QVector<int>() << 1 << 2 << 5 << 1 << 3 << 2 << 5 << 4 << 1 << 5);
+
+    // below the used rows
+    data.clear();
+    data << qMakePair(QPoint(2, 7), 30);
+    QVERIFY(storage.setDataInRect(QRect(1, 7, 2, 1), data).isEmpty());
+    QCOMPARE(storage.lookup(2, 7), 30);
+    QCOMPARE(storage.m_rows, QVector<int>() << 0 << 3 << 5 << 7 << 8 << 10 << 10);
+
+    // clearing the last rows
+    oldData = storage.setDataInRect(QRect(1, 5, 5, 3), QVector< QPair<QPoint, int> >());
+    QCOMPARE(oldData.count(), 3);
+    QCOMPARE(oldData[2].second, 30);
+    QCOMPARE(storage.m_data, QVector<int>() << 1 << 2 << 3 << 4 << 20 << 21 << 9 << 10);
+    QCOMPARE(storage.m_rows, QVector<int>() << 0 << 3 << 5 << 7);
+}
+
 QTEST_MAIN(PointStorageTest)
 
 #include "TestPointStorage.moc"
@@ -52,6 +52,8 @@ private Q_SLOTS:
     void testRowIteration();
     void testDimension();
     void testSubStorage();
+    void testDataInRect();
+    void testSetDataInRect();
 };
 
 #endif // TEST_POINT_STORAGE_H
@@ -140,6 +140,92 @@ void TestRegion::testExtrem()
     QCOMPARE(region6.name(), region7.name());
 }
 
+void TestRegion::testContains()
+{
+    KCSheet* sheet1 = m_map->sheet(0);
+    KCSheet* sheet2 = m_map->sheet(1);
+    KCRegion region("A1:B2;D4;Sheet2!C3:C10", m_map, sheet1);
+    QVERIFY(region.contains(QPoint(2, 2), sheet1));
+    QVERIFY(region.contains(QPoint(4, 4), sheet1));
+    QVERIFY(!region.contains(QPoint(3, 3), sheet1));
+    QVERIFY(region.contains(QPoint(3, 3), sheet2));
+    QVERIFY(!region.contains(QPoint(2, 2), sheet2));
+    QVERIFY(region.contains(QPoint(3, 3)));
+
+    // Enough elements to be compacted.
+    region.clear();
+    for (int row = 1; row <= 100; row += 2)
+        region.add(QPoint(row % 7 + 1, row), sheet1);
+    for (int row = 1; row <= 100; ++row) {
+        for (int col = 1; col <= 8; ++col)
+            QCOMPARE(region.contains(QPoint(col, row), sheet1), row % 2 == 1 && col == row % 7 + 1);
+    }
+    // The compacted ranges have to follow changes.
+    region.add(QRect(1, 2, 8, 1), sheet1);
+    QVERIFY(region.contains(QPoint(5, 2), sheet1));
+    QVERIFY(!region.contains(QPoint(5, 2), sheet2));
+}
+
+void TestRegion::testIntersection()
+{
+    KCSheet* sheet1 = m_map->sheet(0);
+    KCSheet* sheet2 = m_map->sheet(1);
+    KCRegion region1("A1:C3;E5", m_map, sheet1);
+    KCRegion region2("B2:E5", m_map, sheet1);
+    KCRegion intersection = region1.intersected(region2);
+    QCOMPARE(intersection.name(), QString("Sheet1!B2:C3;Sheet1!E5"));
+
+    region2 = KCRegion("B2:E5", m_map, sheet2);
+    QVERIFY(region1.intersected(region2).isEmpty());
+
+    region2 = KCRegion("A1:A1000;C1:C1000", m_map, sheet1);
+    intersection = region1.intersected(region2);
+    QCOMPARE(intersection.name(), QString("Sheet1!A1:A3;Sheet1!C1:C3"));
+
+    // An intersection with a whole column does not need to visit its cells.
+    region2 = KCRegion(QRect(2, 1, 1, KS_rowMax), sheet1);
+    intersection = region1.intersected(region2);
+    QCOMPARE(intersection.name(), QString("Sheet1!B1:B3"));
+}
+
+void TestRegion::testCompaction()
+{
+    KCSheet* sheet1 = m_map->sheet(0);
+    KCRegion region;
+    for (int row = 1; row <= 10; ++row) {
+        region.add(QPoint(1, row), sheet1);
+        region.add(QPoint(2, row), sheet1);
+    }
+    QCOMPARE(region.compacted().name(), QString("Sheet1!A1:B10"));
+
+    region = KCRegion("A1:B2;B1:C2;A3:C3", m_map, sheet1);
+    QCOMPARE(region.compacted().name(), QString("Sheet1!A1:C3"));
+
+    region = KCRegion("A1:C3;B2", m_map, sheet1);
+    QCOMPARE(region.compacted().name(), QString("Sheet1!A1:C3"));
+
+    region = KCRegion("A1:B2;D1:E2;A3:E3", m_map, sheet1);
+    QCOMPARE(region.compacted().name(), QString("Sheet1!A1:B2;Sheet1!D1:E2;Sheet1!A3:E3"));
+
+    QVERIFY(KCRegion().compacted().isEmpty());
+}
+
+void TestRegion::testUnion()
+{
+    KCSheet* sheet1 = m_map->sheet(0);
+    KCSheet* sheet2 = m_map->sheet(1);
+    const KCRegion region1("A1:B2", m_map, sheet1);
+    const KCRegion region2("C1:C2;Sheet2!A1", m_map, sheet1);
+    const KCRegion region3("B2;A3:C3");
+    QVector<const KCRegion*> regions;
+    regions << &region1 << &region2 << &region3;
+    const KCRegion region = KCRegion::united(regions, sheet1);
+    QCOMPARE(region.rects().count(), 2);
+    QCOMPARE(region.intersected(KCRegion(QRect(1, 1, 10, 10), sheet1)).name(), QString("Sheet1!A1:C3"));
+    QCOMPARE(region.intersected(KCRegion(QRect(1, 1, 10, 10), sheet2)).name(), QString("Sheet2!A1"));
+    QVERIFY(KCRegion::united(QVector<const KCRegion*>()).isEmpty());
+}
+
 void TestRegion::cleanupTestCase()
 {
     delete m_map;
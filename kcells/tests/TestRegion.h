@@ -35,6 +35,10 @@ private Q_SLOTS:
     void testFixation();
     void testSheet();
     void testExtrem();
+    void testContains();
+    void testIntersection();
+    void testCompaction();
+    void testUnion();
     void cleanupTestCase();
 
 private:
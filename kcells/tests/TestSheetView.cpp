@@ -0,0 +1,117 @@
+/* This file is part of the KDE project
+   Copyright 2026 agent <agent@local>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "TestSheetView.h"
+
+#include "qtest_kde.h"
+
+#include <QtGui/QImage>
+#include <QtGui/QPainter>
+
+#include <KoZoomHandler.h>
+
+#include "ui/SheetView.h"
+#include "KCCell.h"
+#include "KCMap.h"
+#include "RowColumnFormat.h"
+#include "KCSheet.h"
+
+namespace
+{
+/**
+ * Paints the top left area of the sheet with the rendered tiles of \p sheetView .
+ */
+QImage paint(SheetView* sheetView)
+{
+    QImage image(300, 300, QImage::Format_ARGB32);
+    image.fill(0xffffffff);
+    QPainter painter(&image);
+    sheetView->setPaintCellRange(QRect(1, 1, 5, 20));
+    sheetView->paintCellsCached(painter, QRectF(0.0, 0.0, 300.0, 300.0), QPointF(0.0, 0.0));
+    return image;
+}
+}
+
+void TestSheetView::init()
+{
+    m_map = new KCMap(0 /* no KCDoc */);
+    m_sheet = m_map->addNewSheet();
+    m_sheet->setSheetName("Sheet1");
+    for (int row = 1; row <= 20; ++row) {
+        for (int col = 1; col <= 5; ++col)
+            KCCell(m_sheet, col, row).parseUserInput(QString("%1/%2").arg(col).arg(row));
+    }
+}
+
+void TestSheetView::testFilterRows()
+{
+    KoZoomHandler zoomHandler;
+    zoomHandler.setZoomedResolution(1.0, 1.0);
+    SheetView sheetView(m_sheet);
+    sheetView.setViewConverter(&zoomHandler);
+    const QImage unfiltered = paint(&sheetView);
+
+    // the rows below the filtered ones move up
+    for (int row = 2; row <= 4; ++row)
+        m_sheet->nonDefaultRowFormat(row)->setFiltered(true);
+    const QImage filtered = paint(&sheetView);
+    QVERIFY(filtered != unfiltered);
+
+    // the same as without any rendered tiles
+    SheetView freshSheetView(m_sheet);
+    freshSheetView.setViewConverter(&zoomHandler);
+    QCOMPARE(filtered, paint(&freshSheetView));
+
+    // and back
+    for (int row = 2; row <= 4; ++row)
+        m_sheet->nonDefaultRowFormat(row)->setFiltered(false);
+    QCOMPARE(paint(&sheetView), unfiltered);
+}
+
+void TestSheetView::testFilterColumns()
+{
+    KoZoomHandler zoomHandler;
+    zoomHandler.setZoomedResolution(1.0, 1.0);
+    SheetView sheetView(m_sheet);
+    sheetView.setViewConverter(&zoomHandler);
+    const QImage unfiltered = paint(&sheetView);
+
+    // the columns to the right of the filtered one move left
+    m_sheet->nonDefaultColumnFormat(2)->setFiltered(true);
+    const QImage filtered = paint(&sheetView);
+    QVERIFY(filtered != unfiltered);
+
+    // the same as without any rendered tiles
+    SheetView freshSheetView(m_sheet);
+    freshSheetView.setViewConverter(&zoomHandler);
+    QCOMPARE(filtered, paint(&freshSheetView));
+
+    // and back
+    m_sheet->nonDefaultColumnFormat(2)->setFiltered(false);
+    QCOMPARE(paint(&sheetView), unfiltered);
+}
+
+void TestSheetView::cleanup()
+{
+    delete m_map;
+}
+
+QTEST_KDEMAIN(TestSheetView, GUI)
+
+#include "TestSheetView.moc"
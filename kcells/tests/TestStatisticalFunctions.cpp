@@ -910,6 +910,8 @@ void TestStatisticalFunctions::testPERCENTILE()
     // my tests
     CHECK_EVAL("PERCENTILE(A10:A15;-0.1)",          KCValue::errorVALUE()); //
     CHECK_EVAL("PERCENTILE(A19:A25;1.1)",           KCValue::errorVALUE()); //
+    CHECK_EVAL("PERCENTILE(A19:A25;0)",             KCValue(1));            // MIN()
+    CHECK_EVAL("PERCENTILE(A19:A25;1)",             KCValue(64));           // MAX()
 
 }
 
@@ -959,6 +961,16 @@ void TestStatisticalFunctions::testRANK()
     CHECK_EVAL("RANK(A20;A19:A25;1)", KCValue(2));    // ascending
     CHECK_EVAL("RANK(A25;A19:A25;0)", KCValue(1));    // descending
     CHECK_EVAL("RANK(A21;A19:A25  )", KCValue(5));    // ommitted equals descending order
+
+    // repeated requests share the sorted values, that have to follow the cell changes
+    KCCellStorage* storage = m_map->sheet(0)->cellStorage();
+    CHECK_EVAL("RANK(3;A19:A25;1)", KCValue::errorNA());
+    storage->setValue(1, 21, KCValue(3));
+    CHECK_EVAL("RANK(3;A19:A25;1)", KCValue(3));
+    CHECK_EVAL("MEDIAN(A19:A25)",   KCValue(8));
+    storage->setValue(1, 21, KCValue(4));
+    CHECK_EVAL("RANK(3;A19:A25;1)", KCValue::errorNA());
+    CHECK_EVAL("RANK(4;A19:A25;0)", KCValue(5));
 }
 
 void TestStatisticalFunctions::testRSQ()
@@ -61,6 +61,34 @@ void TestStyleStorage::testGarbageCollection()
     }
 }
 
+void TestStyleStorage::testCachedStyles()
+{
+    KCMap map;
+    KCStyleStorage storage(&map);
+
+    QColor c1(Qt::red);
+    QColor c2(Qt::blue);
+    const QColor none = storage.contains(QPoint(1, 1)).backgroundColor();
+    storage.insert(QRect(3, 2, 8, 1), KCSharedSubStyle(new SubStyleOne<KCStyle::BackgroundColor, QColor>(c1)));
+    // look the cells up twice; the second lookup is served from the cache
+    for (int i = 0; i < 2; i++) {
+        QCOMPARE(storage.contains(QPoint(2, 2)).backgroundColor(), none);
+        QCOMPARE(storage.contains(QPoint(3, 2)).backgroundColor(), c1);
+        QCOMPARE(storage.contains(QPoint(7, 2)).backgroundColor(), c1);
+        QCOMPARE(storage.contains(QPoint(10, 2)).backgroundColor(), c1);
+        QCOMPARE(storage.contains(QPoint(11, 2)).backgroundColor(), none);
+        QCOMPARE(storage.contains(QPoint(7, 3)).backgroundColor(), none);
+    }
+
+    // changing a cell in the middle must not affect its cached neighbours
+    storage.insert(QRect(5, 2, 1, 1), KCSharedSubStyle(new SubStyleOne<KCStyle::BackgroundColor, QColor>(c2)));
+    QCOMPARE(storage.contains(QPoint(4, 2)).backgroundColor(), c1);
+    QCOMPARE(storage.contains(QPoint(5, 2)).backgroundColor(), c2);
+    QCOMPARE(storage.contains(QPoint(6, 2)).backgroundColor(), c1);
+    QCOMPARE(storage.contains(QPoint(10, 2)).backgroundColor(), c1);
+    QCOMPARE(storage.contains(QPoint(11, 2)).backgroundColor(), none);
+}
+
 QTEST_KDEMAIN(TestStyleStorage, GUI)
 
 #include "TestStyleStorage.moc"
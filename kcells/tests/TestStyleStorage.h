@@ -28,6 +28,7 @@ class TestStyleStorage : public QObject
     Q_OBJECT
 private slots:
     void testGarbageCollection();
+    void testCachedStyles();
 };
 
 #endif // KCELLS_TEST_STYLESTORAGE
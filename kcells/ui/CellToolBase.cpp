@@ -2910,6 +2910,7 @@ void CellToolBase::copy() const
         QMimeData* mimeData = new QMimeData();
         mimeData->setText(KCCopyCommand::saveAsPlainText(*selection));
         mimeData->setData("application/x-kcells-snippet", buffer.buffer());
+        KCCopyCommand::saveAsBlock(mimeData, *selection);
 
         QApplication::clipboard()->setMimeData(mimeData);
     } else {
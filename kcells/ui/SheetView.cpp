@@ -21,8 +21,10 @@
 #include "SheetView.h"
 
 #include <QCache>
+#include <QPixmap>
 #include <QRect>
 #include <QPainter>
+#include <QTimer>
 
 
 #include <KViewConverter.h>
@@ -33,6 +35,11 @@
 #include "RowColumnFormat.h"
 #include "KCSheet.h"
 
+// the edge length of the rendered tiles in pixels
+static const int g_tileSize = 256;
+// the maximum number of rendered tiles kept per sheet
+static const int g_maximumCachedTiles = 128;
+
 class SheetView::Private
 {
 public:
@@ -44,11 +51,21 @@ public:
     CellView* defaultCellView;
     // The maximum accessed cell range used for the scrollbar ranges.
     QSize accessedCellRange;
+    // The rendered tiles. The tile at (x, y) starts at pixel (x, y) * g_tileSize
+    // of the sheet painted with the zoom factors below.
+    QCache<QPoint, QPixmap> tiles;
+    qreal tileZoomX;
+    qreal tileZoomY;
+    // The tiles to render in advance.
+    QList<QPoint> pendingTiles;
 
 public:
     KCCell cellToProcess(int col, int row, QPointF& coordinate, QSet<KCCell>& processedMergedCells);
     CellView cellViewToProcess(KCCell& cell, QPointF& coordinate, QSet<KCCell>& processedObscuredCells,
                                SheetView* sheetView);
+    void paintBackgroundImage(QPainter& painter);
+    QPixmap renderTile(const QPoint& tile, SheetView* sheetView);
+    void invalidateTiles(const QRect& range);
 };
 
 KCCell SheetView::Private::cellToProcess(int col, int row, QPointF& coordinate,
@@ -108,6 +125,87 @@ CellView SheetView::Private::cellViewToProcess(KCCell& cell, QPointF& coordinate
     return cellView;
 }
 
+void SheetView::Private::paintBackgroundImage(QPainter& painter)
+{
+    if (sheet->backgroundImage().isNull())
+        return;
+    //TODO support all the different properties
+    KCSheet::BackgroundImageProperties properties = sheet->backgroundImageProperties();
+    if( properties.repeat == KCSheet::BackgroundImageProperties::Repeat ) {
+        const int firstCol = visibleRect.left();
+        const int firstRow = visibleRect.top();
+        const int firstColPosition = sheet->columnPosition(firstCol);
+        const int firstRowPosition = sheet->rowPosition(firstRow);
+
+        const int imageWidth = sheet->backgroundImage().rect().width();
+        const int imageHeight = sheet->backgroundImage().rect().height();
+
+        int xBackground = firstColPosition - (firstColPosition % imageWidth);
+        int yBackground = firstRowPosition - (firstRowPosition % imageHeight);
+
+        const int lastCol = visibleRect.right();
+        const int lastRow = visibleRect.bottom();
+        const int lastColPosition = sheet->columnPosition(lastCol);
+        const int lastRowPosition = sheet->rowPosition(lastRow);
+
+        while ( xBackground < lastColPosition ) {
+            int y = yBackground;
+            while ( y < lastRowPosition ) {
+                painter.drawImage(QRect(xBackground, y, imageWidth, imageHeight), sheet->backgroundImage());
+                y += imageHeight;
+            }
+            xBackground += imageWidth;
+        }
+    }
+}
+
+QPixmap SheetView::Private::renderTile(const QPoint& tile, SheetView* sheetView)
+{
+    const double tileWidth = g_tileSize / tileZoomX;
+    const double tileHeight = g_tileSize / tileZoomY;
+    const QRectF rect(tile.x() * tileWidth, tile.y() * tileHeight, tileWidth, tileHeight);
+
+    QPixmap pixmap(g_tileSize, g_tileSize);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+    painter.scale(tileZoomX, tileZoomY);
+    painter.translate(-rect.topLeft());
+
+    // Include the adjacent cells; their borders may reach into the tile.
+    double left, top;
+    int firstCol = sheet->leftColumn(rect.left(), left);
+    int firstRow = sheet->topRow(rect.top(), top);
+    const int lastCol = qMin(KS_colMax, sheet->rightColumn(rect.right()) + 1);
+    const int lastRow = qMin(KS_rowMax, sheet->bottomRow(rect.bottom()) + 1);
+    if (firstCol > 1)
+        left -= sheet->columnFormat(--firstCol)->visibleWidth();
+    if (firstRow > 1)
+        top -= sheet->rowFormat(--firstRow)->visibleHeight();
+
+    const QRect savedVisibleRect = visibleRect;
+    visibleRect = QRect(QPoint(firstCol, firstRow), QPoint(lastCol, lastRow));
+    sheetView->paintCellRange(painter, rect, QPointF(left, top));
+    visibleRect = savedVisibleRect;
+    return pixmap;
+}
+
+void SheetView::Private::invalidateTiles(const QRect& range)
+{
+    if (tiles.isEmpty())
+        return;
+    // The cell contents may overflow into the whole row and the borders into
+    // the adjacent rows.
+    const int firstTile = int(sheet->rowPosition(qMax(1, range.top() - 1)) * tileZoomY) / g_tileSize;
+    const bool toTheEnd = range.bottom() + 2 > KS_rowMax;
+    const int lastTile = toTheEnd ? 0 : int(sheet->rowPosition(range.bottom() + 2) * tileZoomY) / g_tileSize;
+    const QList<QPoint> keys = tiles.keys();
+    for (int i = 0; i < keys.count(); ++i) {
+        if (keys[i].y() >= firstTile && (toTheEnd || keys[i].y() <= lastTile))
+            tiles.remove(keys[i]);
+    }
+}
+
 
 SheetView::SheetView(const KCSheet* sheet)
         : QObject(const_cast<KCSheet*>(sheet))
@@ -119,6 +217,12 @@ SheetView::SheetView(const KCSheet* sheet)
     d->cache.setMaxCost(10000);
     d->defaultCellView = new CellView(this);
     d->accessedCellRange =  sheet->usedArea().size().expandedTo(QSize(256, 256));
+    d->tiles.setMaxCost(g_maximumCachedTiles);
+    d->tileZoomX = 0.0;
+    d->tileZoomY = 0.0;
+
+    // Changed column widths or row heights move the cells in the tiles.
+    connect(sheet, SIGNAL(documentSizeChanged(const QSizeF&)), this, SLOT(invalidateTiles()));
 }
 
 SheetView::~SheetView()
@@ -168,9 +272,13 @@ void SheetView::invalidateRegion(const KCRegion& region)
     for (KCRegion::ConstIterator it(region.constBegin()); it != end; ++it) {
         qregion += (*it)->rect();
     }
+    // the rendered tiles may contain cells, that are not cached anymore
+    QVector<QRect> rects = qregion.rects();
+    for (int i = 0; i < rects.count(); ++i)
+        d->invalidateTiles(rects[i]);
     // reduce to the cached area
     qregion &= d->cachedArea;
-    QVector<QRect> rects = qregion.rects();
+    rects = qregion.rects();
     for (int i = 0; i < rects.count(); ++i)
         invalidateRange(rects[i]);
 }
@@ -181,6 +289,7 @@ void SheetView::invalidate()
     d->defaultCellView = new CellView(this);
     d->cache.clear();
     d->cachedArea = QRegion();
+    d->tiles.clear();
 }
 
 void SheetView::paintCells(QPainter& painter, const QRectF& paintRect, const QPointF& topLeft)
@@ -200,37 +309,66 @@ void SheetView::paintCells(QPainter& painter, const QRectF& paintRect, const QPo
 // kDebug() << "topLeft:" << topLeft;
 
     // 0. Paint the sheet background
-    if (!sheet()->backgroundImage().isNull()) {
-        //TODO support all the different properties
-        KCSheet::BackgroundImageProperties properties = sheet()->backgroundImageProperties();
-        if( properties.repeat == KCSheet::BackgroundImageProperties::Repeat ) {
-            const int firstCol = d->visibleRect.left();
-            const int firstRow = d->visibleRect.top();
-            const int firstColPosition = d->sheet->columnPosition(firstCol);
-            const int firstRowPosition = d->sheet->rowPosition(firstRow);
-
-            const int imageWidth = sheet()->backgroundImage().rect().width();
-            const int imageHeight = sheet()->backgroundImage().rect().height();
-
-            int xBackground = firstColPosition - (firstColPosition % imageWidth);
-            int yBackground = firstRowPosition - (firstRowPosition % imageHeight);
-
-            const int lastCol = d->visibleRect.right();
-            const int lastRow = d->visibleRect.bottom();
-            const int lastColPosition = d->sheet->columnPosition(lastCol);
-            const int lastRowPosition = d->sheet->rowPosition(lastRow);
-
-            while ( xBackground < lastColPosition ) {
-                int y = yBackground;
-                while ( y < lastRowPosition ) {
-                    painter.drawImage(QRect(xBackground, y, imageWidth, imageHeight), sheet()->backgroundImage());
-                    y += imageHeight;
-                }
-                xBackground += imageWidth;
-            }
+    d->paintBackgroundImage(painter);
+
+    paintCellRange(painter, paintRect, topLeft);
+}
+
+void SheetView::paintCellsCached(QPainter& painter, const QRectF& paintRect, const QPointF& topLeft)
+{
+    // The tiles are not mirrored for right-to-left sheets.
+    if (sheet()->layoutDirection() == Qt::RightToLeft) {
+        paintCells(painter, paintRect, topLeft);
+        return;
+    }
+
+    // 0. Paint the sheet background
+    d->paintBackgroundImage(painter);
+
+    // The tiles are rendered for one zoom level.
+    qreal zoomX, zoomY;
+    viewConverter()->zoom(&zoomX, &zoomY);
+    if (zoomX != d->tileZoomX || zoomY != d->tileZoomY) {
+        d->tiles.clear();
+        d->tileZoomX = zoomX;
+        d->tileZoomY = zoomY;
+    }
+
+    const double tileWidth = g_tileSize / zoomX;
+    const double tileHeight = g_tileSize / zoomY;
+    const int firstX = qMax(0, int(paintRect.left() / tileWidth));
+    const int firstY = qMax(0, int(paintRect.top() / tileHeight));
+    const int lastX = qMax(0, int(paintRect.right() / tileWidth));
+    const int lastY = qMax(0, int(paintRect.bottom() / tileHeight));
+
+    // 1.-4. Paint the tiles in device coordinates to avoid scaling them.
+    const QPoint origin = painter.worldTransform().map(QPointF(0.0, 0.0)).toPoint();
+    painter.save();
+    painter.setWorldTransform(QTransform());
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            const QPoint tile(x, y);
+            if (!d->tiles.contains(tile))
+                d->tiles.insert(tile, new QPixmap(d->renderTile(tile, this)));
+            painter.drawPixmap(origin + tile * g_tileSize, *d->tiles.object(tile));
+        }
+    }
+    painter.restore();
+
+    // Render the surrounding tiles in advance for scrolling.
+    d->pendingTiles.clear();
+    for (int y = qMax(0, firstY - 1); y <= lastY + 1; ++y) {
+        for (int x = qMax(0, firstX - 1); x <= lastX + 1; ++x) {
+            if (!d->tiles.contains(QPoint(x, y)))
+                d->pendingTiles.append(QPoint(x, y));
         }
     }
+    if (!d->pendingTiles.isEmpty())
+        QTimer::singleShot(0, this, SLOT(renderPendingTiles()));
+}
 
+void SheetView::paintCellRange(QPainter& painter, const QRectF& paintRect, const QPointF& topLeft)
+{
     // 1. Paint the cell background
 
     // Handle right-to-left layout.
@@ -378,6 +516,26 @@ void SheetView::invalidateRange(const QRect& range)
     d->cachedArea -= range;
 }
 
+void SheetView::invalidateTiles()
+{
+    d->tiles.clear();
+    d->pendingTiles.clear();
+}
+
+void SheetView::renderPendingTiles()
+{
+    // Render one tile at a time to keep the application responsive.
+    while (!d->pendingTiles.isEmpty()) {
+        const QPoint tile = d->pendingTiles.takeFirst();
+        if (d->tiles.contains(tile))
+            continue;
+        d->tiles.insert(tile, new QPixmap(d->renderTile(tile, this)));
+        break;
+    }
+    if (!d->pendingTiles.isEmpty())
+        QTimer::singleShot(0, this, SLOT(renderPendingTiles()));
+}
+
 void SheetView::obscureCells(const QRect& range, const QPoint& position)
 {
     const int right = range.right();
@@ -104,13 +104,42 @@ public:
      */
     void paintCells(QPainter& painter, const QRectF& paintRect, const QPointF& topLeft);
 
+    /**
+     * Paints the cells like paintCells(), but reuses the rendered cells.
+     * The cells are rendered into tiles for the current zoom level, which
+     * are kept until the cells in them get invalidated. The tiles around
+     * the painted area are rendered in advance, if the event loop is idle.
+     * Meant for painting on screen; the painter has to be scaled by the
+     * zoom of the viewConverter().
+     */
+    void paintCellsCached(QPainter& painter, const QRectF& paintRect, const QPointF& topLeft);
+
 public Q_SLOTS:
     void updateAccessedCellRange(const QPoint& location = QPoint());
 
 Q_SIGNALS:
     void visibleSizeChanged(const QSizeF&);
 
+private Q_SLOTS:
+    /**
+     * Discards all rendered tiles.
+     * Called, if the column widths or row heights change.
+     */
+    void invalidateTiles();
+
+    /**
+     * Renders one of the tiles around the last painted area and schedules
+     * the next one.
+     */
+    void renderPendingTiles();
+
 private:
+    /**
+     * Paints the cells in the paint cell range, but not the sheet background.
+     * Helper method for paintCells() and the rendering of the tiles.
+     */
+    void paintCellRange(QPainter& painter, const QRectF& paintRect, const QPointF& topLeft);
+
     /**
      * Helper method for invalidateRegion().
      * Invalidates all cached CellViews in \p range .
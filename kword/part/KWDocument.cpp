@@ -72,6 +72,7 @@
 
 #include <KoProgressUpdater.h>
 #include <KoUpdater.h>
+#include <KoMainWindow.h>
 
 // KDE + Qt includes
 #include <klocale.h>
@@ -139,6 +140,7 @@ KWDocument::KWDocument(QWidget *parentWidget, QObject *parent, bool singleViewMo
         : KoDocument(parentWidget, parent, singleViewMode),
         m_frameLayout(&m_pageManager, m_frameSets),
         m_magicCurtain(0),
+        m_layoutProgress(0),
         m_mainFramesetEverFinished(false),
         m_loadingTemplate(false),
         m_commandBeingAdded(0)
@@ -169,6 +171,7 @@ KWDocument::KWDocument(QWidget *parentWidget, QObject *parent, bool singleViewMo
 
 KWDocument::~KWDocument()
 {
+    delete m_layoutProgress;
     delete m_magicCurtain;
     m_config.setUnit(unit());
     saveConfig();
@@ -346,6 +349,7 @@ void KWDocument::addFrameSet(KWFrameSet *fs)
             connect(tfs, SIGNAL(moreFramesNeeded(KWTextFrameSet*)),
                     this, SLOT(requestMoreSpace(KWTextFrameSet*)));
             connect(tfs, SIGNAL(layoutDone()), this, SLOT(mainTextFrameSetLayoutDone()));
+            connect(tfs, SIGNAL(layoutProgress(int)), this, SLOT(mainTextFrameSetLayoutProgress(int)));
         }
         else {
             connect(tfs, SIGNAL(decorationFrameResize(KWTextFrameSet*)),
@@ -416,6 +420,14 @@ void KWDocument::removeFrame(KWFrame *frame)
 void KWDocument::mainTextFrameSetLayoutDone()
 {
     m_mainFramesetEverFinished = true;
+    delete m_layoutProgress;
+    m_layoutProgress = 0;
+}
+
+void KWDocument::mainTextFrameSetLayoutProgress(int percent)
+{
+    if (m_layoutProgress)
+        m_layoutProgress->setProgress(percent);
 }
 
 KWFrameSet *KWDocument::frameSetByName(const QString &name)
@@ -790,6 +802,10 @@ void KWDocument::endOfLoading() // called by both oasis and oldxml
         tfs->setAllowLayout(true);
     }
 
+    // the text of long documents is layouted in chunks after loading, show how far along that is.
+    if (mainFrameSet() && !m_layoutProgress)
+        m_layoutProgress = new LayoutProgress(this);
+
     if (updater) updater->setProgress(100);
 
     kDebug(32001) << "KWDocument::endOfLoading done";
@@ -1034,3 +1050,46 @@ void PageProcessingQueue::process()
     deleteLater();
     emit m_document->pageSetupChanged();
 }
+
+LayoutProgress::LayoutProgress(KWDocument *document)
+    : m_document(document)
+{
+    // threaded mode; the statusbar is updated from a timer and never from inside the layout run
+    m_progressUpdater = new KoProgressUpdater(this);
+    m_progressUpdater->start(100);
+    m_updater = m_progressUpdater->startSubtask(1, "KWDocument::layout");
+}
+
+LayoutProgress::~LayoutProgress()
+{
+    delete m_progressUpdater;
+    setValue(-1);
+}
+
+void LayoutProgress::setProgress(int percent)
+{
+    if (m_updater)
+        m_updater->setProgress(percent);
+}
+
+int LayoutProgress::maximum() const
+{
+    return 100;
+}
+
+void LayoutProgress::setValue(int value)
+{
+    foreach (KoMainWindow *shell, m_document->shells())
+        shell->slotProgress(value);
+}
+
+void LayoutProgress::setRange(int minimum, int maximum)
+{
+    Q_UNUSED(minimum);
+    Q_UNUSED(maximum);
+}
+
+void LayoutProgress::setFormat(const QString &format)
+{
+    Q_UNUSED(format);
+}
@@ -41,6 +41,7 @@ class KWView;
 class KWPage;
 class KWFrameSet;
 class MagicCurtain;
+class LayoutProgress;
 
 class KInlineTextObjectManager;
 class KShapeContainer;
@@ -203,6 +204,7 @@ private slots:
     /// Called after the constructor figures out there is an install problem.
     void showErrorAndDie();
     void mainTextFrameSetLayoutDone();
+    void mainTextFrameSetLayoutProgress(int percent);
 
 private:
     friend class PageProcessingQueue;
@@ -238,6 +240,7 @@ private:
     KWApplicationConfig m_config;
 
     MagicCurtain *m_magicCurtain; ///< all things we don't want to show are behind this one
+    LayoutProgress *m_layoutProgress; ///< only set while the main text is layouted for the first time
     bool m_mainFramesetEverFinished;
     bool m_loadingTemplate;
     QUndoCommand *m_commandBeingAdded;
@@ -20,10 +20,15 @@
 #ifndef KWDOCUMENT_P_H
 #define KWDOCUMENT_P_H
 
+#include <KoProgressProxy.h>
+
 #include <QObject>
+#include <QPointer>
 
 class KWPage;
 class KWDocument;
+class KoProgressUpdater;
+class KoUpdater;
 
 /// \internal
 class PageProcessingQueue : public QObject
@@ -42,4 +47,26 @@ private:
     KWDocument *m_document;
 };
 
+/// \internal
+/// shows the progress of the first layout of the main text after loading in the statusbar
+class LayoutProgress : public KoProgressProxy
+{
+public:
+    explicit LayoutProgress(KWDocument *document);
+    ~LayoutProgress();
+
+    void setProgress(int percent);
+
+    // reimplemented from KoProgressProxy
+    int maximum() const;
+    void setValue(int value);
+    void setRange(int minimum, int maximum);
+    void setFormat(const QString &format);
+
+private:
+    KWDocument *m_document;
+    KoProgressUpdater *m_progressUpdater;
+    QPointer<KoUpdater> m_updater;
+};
+
 #endif
@@ -62,6 +62,7 @@ void KWPage::setPageStyle(const KWPageStyle style)
     KWPageManagerPrivate::Page page = priv->pages[n];
     page.style = style;
     priv->pages.insert(n, page);
+    priv->invalidatePageOffsets();
 }
 
 void KWPage::setPageSide(PageSide ps)
@@ -76,6 +77,7 @@ void KWPage::setPageSide(PageSide ps)
     const bool needsRenumbering = (page.pageSide == PageSpread && ps != PageSpread) || ps == PageSpread;
     page.pageSide = ps;
     priv->pages.insert(n, page);
+    priv->invalidatePageOffsets();
 
     if (needsRenumbering)
         priv->setPageNumberForId(n, page.pageNumber);
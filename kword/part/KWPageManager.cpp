@@ -34,14 +34,24 @@
 KWPageManagerPrivate::KWPageManagerPrivate()
         : lastId(0),
         preferPageSpread(false),
-        defaultPageStyle("Standard")
+        defaultPageStyle("Standard"),
+        documentHeight(0.0),
+        offsetsValid(false),
+        offsetsRevision(0)
 {
     pageStyles.insert(defaultPageStyle.name(), defaultPageStyle);
 }
 
-qreal KWPageManagerPrivate::pageOffset(int pageNum, bool bottom) const
+void KWPageManagerPrivate::updatePageOffsets() const
 {
-    Q_ASSERT(pageNum >= 0);
+    if (offsetsValid && offsetsRevision == KWPageStylePrivate::pageLayoutRevision)
+        return;
+    offsetPageNumbers.clear();
+    pageTops.clear();
+    pageHeights.clear();
+    offsetPageNumbers.reserve(pageNumbers.count());
+    pageTops.reserve(pageNumbers.count());
+    pageHeights.reserve(pageNumbers.count());
     qreal offset = 0.0;
     const qreal totalPadding = padding.top + padding.bottom;
 
@@ -50,20 +60,55 @@ qreal KWPageManagerPrivate::pageOffset(int pageNum, bool bottom) const
         const KWPageManagerPrivate::Page &page = pages.value(iter.value());
         if (page.pageSide == KWPage::PageSpread && iter.key() % 2 == 1)
             continue;
-        if (iter.key() == pageNum) {
-            if (bottom)
-                offset += page.style.pageLayout().height;
-            break;
-        }
-        offset += page.style.priv()->pageLayout.height + totalPadding;
+        const qreal height = page.style.priv()->pageLayout.height;
+        offsetPageNumbers.append(iter.key());
+        pageTops.append(offset);
+        pageHeights.append(height);
+        offset += height + totalPadding;
+    }
+    documentHeight = offset;
+    offsetsRevision = KWPageStylePrivate::pageLayoutRevision;
+    offsetsValid = true;
+}
+
+qreal KWPageManagerPrivate::pageOffset(int pageNum, bool bottom) const
+{
+    Q_ASSERT(pageNum >= 0);
+    updatePageOffsets();
+    QVector<int>::const_iterator iter = qBinaryFind(offsetPageNumbers.constBegin(),
+            offsetPageNumbers.constEnd(), pageNum);
+    if (iter == offsetPageNumbers.constEnd())
+        return documentHeight;
+    const int index = iter - offsetPageNumbers.constBegin();
+    if (bottom)
+        return pageTops[index] + pageHeights[index];
+    return pageTops[index];
+}
+
+int KWPageManagerPrivate::pageIndexAt(qreal y) const
+{
+    updatePageOffsets();
+    if (offsetPageNumbers.isEmpty())
+        return -1;
+    const qreal totalPadding = padding.top + padding.bottom;
+    // find the first page that ends at or after y
+    int low = 0;
+    int high = pageTops.count();
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (pageTops[middle] + pageHeights[middle] + totalPadding < y)
+            low = middle + 1;
+        else
+            high = middle;
     }
-    return offset;
+    return qMin(low, pageTops.count() - 1);
 }
 
 void KWPageManagerPrivate::setPageNumberForId(int pageId, int newPageNumber)
 {
     if (pageNumbers.isEmpty() || ! pages.contains(pageId))
         return;
+    invalidatePageOffsets();
 
     const uint oldPageNumber = pages[pageId].pageNumber;
     int diff = newPageNumber - oldPageNumber;
@@ -139,6 +184,7 @@ void KWPageManagerPrivate::insertPage(const Page &newPage)
     pageNumbers.insert(newPage.pageNumber, lastId);
     if (newPage.pageSide == KWPage::PageSpread)
         pageNumbers.insert(newPage.pageNumber + 1, lastId);
+    invalidatePageOffsets();
 }
 
 ///////////
@@ -155,19 +201,10 @@ KWPageManager::~KWPageManager()
 
 int KWPageManager::pageNumber(const QPointF &point) const
 {
-    qreal startOfpage = 0.0;
-    int answer = -1;
-    QMap<int, int>::const_iterator iter = d->pageNumbers.constBegin();
-    for (;iter != d->pageNumbers.constEnd(); ++iter) {
-        const KWPageManagerPrivate::Page page = d->pages[iter.value()];
-        if (page.pageSide == KWPage::PageSpread && iter.key() % 2 == 1)
-            continue;
-        startOfpage += page.style.pageLayout().height + d->padding.top + d->padding.bottom;
-        answer = iter.key();
-        if (startOfpage >= point.y())
-            break;
-    }
-    return answer;
+    const int index = d->pageIndexAt(point.y());
+    if (index < 0)
+        return -1;
+    return d->offsetPageNumbers[index];
 }
 
 int KWPageManager::pageNumber(const KShape *shape) const
@@ -182,15 +219,8 @@ int KWPageManager::pageNumber(const qreal y) const
 
 int KWPageManager::pageCount() const
 {
-    int count = 0;
-    QHash<int,KWPageManagerPrivate::Page>::const_iterator iter = d->pages.constBegin();
-    while (iter != d->pages.constEnd()) {
-        if (iter.value().pageSide == KWPage::PageSpread)
-            ++count;
-        ++count;
-        ++iter;
-    }
-    return count;
+    // a pagespread is registered under both its page numbers
+    return d->pageNumbers.count();
 }
 
 KWPage KWPageManager::page(int pageNum) const
@@ -300,6 +330,7 @@ KWPage KWPageManager::appendPage(const KWPageStyle &pageStyle)
     d->pageNumbers.insert(page.pageNumber, d->lastId);
     if (page.pageSide == KWPage::PageSpread)
         d->pageNumbers.insert(page.pageNumber + 1, d->lastId);
+    d->invalidatePageOffsets();
 #ifdef DEBUG_PAGES
     kDebug(32001) << "pageNumber=" << page.pageNumber << "pageCount=" << pageCount();
     kDebug(32001) << "           " << d->pageNumbers;
@@ -348,6 +379,7 @@ void KWPageManager::removePage(const KWPage &page)
         }
         ++iter;
     }
+    d->invalidatePageOffsets();
 #ifdef DEBUG_PAGES
     kDebug(32001) << "pageNumber=" << removedPageNumber << "pageCount=" << pageCount();
     kDebug(32001) << "           " << d->pageNumbers;
@@ -356,20 +388,7 @@ void KWPageManager::removePage(const KWPage &page)
 
 QPointF KWPageManager::clipToDocument(const QPointF &point) const
 {
-    qreal startOfpage = 0.0;
-
-    KWPage page;
-    // decrease the pagenumbers of pages following the pageNumber
-    QMap<int, int>::const_iterator iter = d->pageNumbers.constBegin();
-    while (iter != d->pageNumbers.constEnd()) {
-        const KWPageManagerPrivate::Page p = d->pages[iter.value()];
-        startOfpage += p.style.pageLayout().height + d->padding.top + d->padding.bottom;
-        if (startOfpage >= point.y()) {
-            page = KWPage(d, iter.value());
-            break;
-        }
-        ++iter;
-    }
+    KWPage page = this->page(point);
     if (! page.isValid())
         page = last();
 
@@ -493,6 +512,7 @@ KInsets KWPageManager::padding() const
 void KWPageManager::setPadding(const KInsets &padding)
 {
     d->padding = padding;
+    d->invalidatePageOffsets();
 }
 
 bool KWPageManager::preferPageSpread() const
@@ -24,6 +24,7 @@
 
 #include <QHash>
 #include <QMap>
+#include <QVector>
 
 class KWPageManagerPrivate
 {
@@ -51,6 +52,19 @@ public:
 
     qreal pageOffset(int pageNum, bool bottom) const;
 
+    /**
+     * Return the index in the page offset lists of the first shown page that ends at or
+     * after the param y, or the last one if the document is shorter.
+     */
+    int pageIndexAt(qreal y) const;
+
+    /// call this when pages are added, removed, renumbered or change their page style.
+    void invalidatePageOffsets() {
+        offsetsValid = false;
+    }
+    /// rebuild the page offset lists if something changed since the last time.
+    void updatePageOffsets() const;
+
     /**
      * Update the page number for the page related to the pageId and also update the
      * page number of all pages following the page.
@@ -74,6 +88,14 @@ public:
     QHash <QString, KWPageStyle> pageStyles;
     KInsets padding;
     KWPageStyle defaultPageStyle;
+
+    // the pages as shown, in page number order; a pagespread is one entry.
+    mutable QVector<int> offsetPageNumbers; // page number of each shown page
+    mutable QVector<qreal> pageTops; // offset of the top of each shown page in the document
+    mutable QVector<qreal> pageHeights;
+    mutable qreal documentHeight; // the offset of the end of the last page, including padding
+    mutable bool offsetsValid;
+    mutable int offsetsRevision; // KWPageStylePrivate::pageLayoutRevision when the lists were built
 };
 
 #endif
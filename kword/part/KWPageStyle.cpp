@@ -34,6 +34,8 @@
 #include <QBuffer>
 #include <QColor>
 
+int KWPageStylePrivate::pageLayoutRevision = 0;
+
 KWPageStylePrivate::~KWPageStylePrivate()
 {
     if (fullPageBackground && !fullPageBackground->deref()) {
@@ -139,6 +141,7 @@ const KOdfPageLayoutData &KWPageStyle::pageLayout() const
 void KWPageStyle::setPageLayout(const KOdfPageLayoutData &pageLayout)
 {
     d->pageLayout = pageLayout;
+    ++KWPageStylePrivate::pageLayoutRevision;
 }
 
 const KOdfColumnData &KWPageStyle::columns() const
@@ -351,6 +354,7 @@ KOdfGenericStyle KWPageStyle::saveOdf() const
 void KWPageStyle::loadOdf(KOdfLoadingContext &context, const KXmlElement &masterNode, const KXmlElement &style, KResourceManager *documentResources)
 {
     d->pageLayout.loadOdf(style);
+    ++KWPageStylePrivate::pageLayoutRevision;
     KXmlElement props = KoXml::namedItemNS(style, KOdfXmlNS::style, "page-layout-properties");
     if (props.isNull())
         return;
@@ -31,6 +31,9 @@ public:
     ~KWPageStylePrivate();
     void clear();
 
+    /// changes every time the page layout of any page style changes, so page positions can be cached.
+    static int pageLayoutRevision;
+
     KOdfColumnData columns;
     KOdfPageLayoutData pageLayout;
     QString name;
@@ -57,6 +60,7 @@ public:
     void copyProperties(KWPageStylePrivate *other) {
         columns = other->columns;
         pageLayout = other->pageLayout;
+        ++pageLayoutRevision;
         //name = other->name;
         mainFrame = other->mainFrame;
         footNoteDistance = other->footNoteDistance;
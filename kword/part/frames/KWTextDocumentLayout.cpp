@@ -38,6 +38,10 @@
 #include <QList>
 #include <QPainterPath>
 #include <QTextBlock>
+#include <QTime>
+
+// a layout run gives control back to the event loop after this many milliseconds
+#define MAX_LAYOUT_CHUNK_TIME 50
 
 // #define DEBUG_TEXT
 // #define DEBUG_ANCHORS
@@ -172,6 +176,8 @@ void KWTextDocumentLayout::relayout()
 
     // make sure the ordering is proper
     m_frameSet->sortFrames();
+    if (m_frameSet->frames() != frames)
+        interruptLayout(); // the text flows differently, positions from the last run are useless.
     if (firstDirtyFrame) {
         // if the dirty frame has been resorted to no longer be the first one, then we should
         // mark dirty any frame that were previously later in the flow, but are now before it.
@@ -180,6 +186,7 @@ void KWTextDocumentLayout::relayout()
                 break;
             if (dirtyFrames.contains(frame)) {
                 static_cast<KTextShapeData*>(frame->shape()->userData())->foul();
+                interruptLayout();
                 // just the first is enough.
                 break;
             }
@@ -236,6 +243,8 @@ void KWTextDocumentLayout::layout()
 
     if (! m_state->start())
         return;
+    QTime chunkTime;
+    chunkTime.start();
     qreal endPos = 1E9;
     qreal bottomOfText = 0.0;
     bool newParagraph = true;
@@ -492,6 +501,8 @@ void KWTextDocumentLayout::layout()
                                               m_state->shape->size().width(), m_state->y() - posY));
 
             if (! moreText) {
+                if (m_state->reusedLayout()) // the text after the last line we positioned kept its layout.
+                    bottomOfText = m_state->y();
                 const int frameCount = m_frameSet->frameCount();
                 const int framesInUse = m_state->shapeNumber + 1;
                 if (framesInUse < frameCount && framesInUse != m_lastKnownFrameCount)
@@ -546,9 +557,13 @@ void KWTextDocumentLayout::layout()
             continue;
         }
 
-        if (m_state->interrupted || (newParagraph && m_state->y() > endPos)) {
+        if (m_state->interrupted || (newParagraph && (m_state->y() > endPos
+                        || chunkTime.elapsed() > MAX_LAYOUT_CHUNK_TIME))) {
             // enough for now. Try again later.
             TDEBUG << "schedule a next layout due to having done a layout of quite some space";
+            const int characterCount = document()->characterCount();
+            if (characterCount > 0)
+                m_frameSet->layoutProgress(qMin(99, int(m_state->cursorPosition() * 100.0 / characterCount)));
             scheduleLayoutWithoutInterrupt();
             return;
         }
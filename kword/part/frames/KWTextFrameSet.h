@@ -125,6 +125,12 @@ signals:
     void decorationFrameResize(KWTextFrameSet *fs);
     /// emitted when all the text is fully layouted
     void layoutDone();
+    /**
+     * Emitted when a layout run stopped to give control back to the event loop before
+     * all text was layouted.
+     * @param percent the part of the text that is layouted so far.
+     */
+    void layoutProgress(int percent);
 
 protected:
     friend class KWTextDocumentLayout;
@@ -653,6 +653,48 @@ void TestPageManager::testPageOffset()
     QCOMPARE(page.offsetInDocument(), (qreal) 400 * 49);
 }
 
+void TestPageManager::testPageNumberForPosition()
+{
+    KWPageManager *pageManager = new KWPageManager();
+    pageManager->setPadding(KInsets(1, 2, 3, 4));
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 10)), -1);
+
+    KOdfPageLayoutData lay;
+    lay.width = 100;
+    lay.height = 100;
+    KWPageStyle style1("style1");
+    style1.setPageLayout(lay);
+    lay.height = 200;
+    KWPageStyle style2("style2");
+    style2.setPageLayout(lay);
+
+    for (int i = 0; i < 1000; ++i)
+        pageManager->appendPage(i % 2 ? style2 : style1);
+    QCOMPARE(pageManager->pageCount(), 1000);
+
+    // each pair of pages is 100 + 200 + 2 * 4 of padding high
+    QCOMPARE(pageManager->pageNumber(QPointF(0, -10)), 1);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 104)), 1);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 105)), 2);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 308)), 2);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 309)), 3);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 250 * 308 + 1)), 501);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 500 * 308 + 1000)), 1000);
+    QCOMPARE(pageManager->topOfPage(501), 250 * 308.);
+    QCOMPARE(pageManager->bottomOfPage(502), 251 * 308. - 4);
+
+    pageManager->removePage(1);
+    QCOMPARE(pageManager->pageCount(), 999);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 204)), 1);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 205)), 2);
+
+    lay.height = 50;
+    style2.setPageLayout(lay);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 54)), 1);
+    QCOMPARE(pageManager->pageNumber(QPointF(0, 55)), 2);
+    QCOMPARE(pageManager->topOfPage(3), 54. + 104.);
+}
+
 void TestPageManager::testBackgroundRefCount()
 {
     KWPageStyle ps1("test");
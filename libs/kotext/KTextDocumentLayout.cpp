@@ -38,6 +38,7 @@
 #include <QTextTableCell>
 #include <QTextList>
 #include <QTimer>
+#include <QVector>
 
 class LayoutStateDummy : public KTextDocumentLayout::LayoutState
 {
@@ -100,7 +101,15 @@ public:
             : inlineTextObjectManager(0),
             scheduled(false),
             parent(parent_),
-            resizeMethod(KTextDocument::NoResize) {
+            resizeMethod(KTextDocument::NoResize),
+            changedRangeEnd(-1),
+            fullRelayout(true),
+            shapeIndexValid(false),
+            shapeIndexOrdered(true),
+            shapeIndexRevision(0),
+            unlayoutedShape(0),
+            unlayoutedShapeOrder(-1),
+            blockIndexValid(false) {
     }
 
     ~Private()
@@ -116,6 +125,9 @@ public:
     void postLayoutHook() {
         Q_ASSERT(parent);
         Q_ASSERT(parent->m_state);
+        // all text is positioned, the next run only has to cover new changes.
+        changedRangeEnd = -1;
+        fullRelayout = false;
         KShape *shape = parent->m_state->shape;
         if (shape == 0)
             return;
@@ -133,14 +145,171 @@ public:
 
     void adjustSize();
 
+    /// move the positions stored after a document change so they stay valid without a relayout
+    void movePositions(KShape *changedShape, int position, int charsRemoved, int charsAdded);
+
+    /// rebuild the ordered list of text ranges of all shapes, if the shapes changed since the last time.
+    void updateShapeIndex();
+    /// rebuild the list of top-level blocks, if the document changed since the last time.
+    void updateBlockIndex();
+    /// return where hit testing a point with the param y coordinate can start in the root frame.
+    QTextFrame::iterator hitTestStart(qreal y);
+    /// return the bottom of the lines of the top-level block at the param index in the block index.
+    qreal blockBottom(int index) const;
+
     QList<KShape *> shapes;
     KInlineTextObjectManager *inlineTextObjectManager;
     bool scheduled;
     KTextDocumentLayout *parent;
     KTextDocument::ResizeMethod resizeMethod;
     KPostscriptPaintDevice *paintDevice;
+    int changedRangeEnd; // end of the text changed since the last complete layout run
+    bool fullRelayout; // something other than a text change requested the layout
+
+    struct ShapeSpan {
+        int position;
+        int endPosition; // -1 means up to the end of the document
+        int order; // index in the list of shapes
+        KShape *shape;
+    };
+    QVector<ShapeSpan> shapeIndex; // the layouted shapes, sorted on position
+    bool shapeIndexValid;
+    bool shapeIndexOrdered; // false if the text ranges overlap, in which case shapeIndex is not used
+    int shapeIndexRevision; // KTextShapeData::positionsRevision() when shapeIndex was built
+    KShape *unlayoutedShape; // the first shape without text position, it matches any position
+    int unlayoutedShapeOrder;
+
+    QVector<QTextFrame::iterator> blockIndex; // the blocks directly in the root frame
+    bool blockIndexValid;
 };
 
+static int movedPosition(int pos, int position, int charsRemoved, int charsAdded)
+{
+    if (pos < position)
+        return pos;
+    if (pos >= position + charsRemoved)
+        return pos + charsAdded - charsRemoved;
+    return position + charsAdded;
+}
+
+void KTextDocumentLayout::Private::movePositions(KShape *changedShape, int position, int charsRemoved, int charsAdded)
+{
+    if (charsAdded == charsRemoved)
+        return;
+    bool found = false;
+    foreach (KShape *shape, parent->shapes()) {
+        if (shape == changedShape)
+            found = true;
+        if (!found)
+            continue;
+        KTextShapeData *data = qobject_cast<KTextShapeData*>(shape->userData());
+        if (data == 0)
+            continue;
+        // the changed shape keeps its start, all shapes after it shift along with the text.
+        if (shape != changedShape && data->position() > position)
+            data->setPosition(movedPosition(data->position(), position, charsRemoved, charsAdded));
+        if (data->endPosition() >= position)
+            data->setEndPosition(movedPosition(data->endPosition(), position, charsRemoved, charsAdded));
+    }
+
+    if (inlineTextObjectManager == 0)
+        return;
+    foreach (KInlineObject *object, inlineTextObjectManager->inlineTextObjects()) {
+        if (object->document() == parent->document() && object->textPosition() >= position + charsRemoved)
+            object->setTextPosition(movedPosition(object->textPosition(), position, charsRemoved, charsAdded));
+    }
+}
+
+void KTextDocumentLayout::Private::updateShapeIndex()
+{
+    if (shapeIndexValid && shapeIndexRevision == KTextShapeData::positionsRevision())
+        return;
+    shapeIndex.clear();
+    shapeIndexOrdered = true;
+    unlayoutedShape = 0;
+    unlayoutedShapeOrder = -1;
+    int order = 0;
+    foreach (KShape *shape, parent->shapes()) {
+        KTextShapeData *data = qobject_cast<KTextShapeData*>(shape->userData());
+        ++order;
+        if (data == 0)
+            continue;
+        if (data->position() < 0) {
+            if (data->endPosition() != -1)
+                shapeIndexOrdered = false;
+            else if (unlayoutedShape == 0) {
+                unlayoutedShape = shape;
+                unlayoutedShapeOrder = order;
+            }
+            continue;
+        }
+        if (!shapeIndex.isEmpty()) {
+            const ShapeSpan &previous = shapeIndex.last();
+            if (previous.endPosition == -1 || previous.endPosition > data->position())
+                shapeIndexOrdered = false;
+        }
+        ShapeSpan span;
+        span.position = data->position();
+        span.endPosition = data->endPosition();
+        span.order = order;
+        span.shape = shape;
+        shapeIndex.append(span);
+    }
+    shapeIndexRevision = KTextShapeData::positionsRevision();
+    shapeIndexValid = true;
+}
+
+void KTextDocumentLayout::Private::updateBlockIndex()
+{
+    if (blockIndexValid)
+        return;
+    blockIndex.clear();
+    QTextFrame *root = parent->document()->rootFrame();
+    for (QTextFrame::iterator it = root->begin(); it != root->end(); ++it) {
+        if (it.currentFrame() == 0 && it.currentBlock().isValid())
+            blockIndex.append(it);
+    }
+    blockIndexValid = true;
+}
+
+qreal KTextDocumentLayout::Private::blockBottom(int index) const
+{
+    // a block without lines is not shown, it takes the bottom of the block before it.
+    for (int i = index; i >= 0; --i) {
+        QTextLayout *layout = blockIndex[i].currentBlock().layout();
+        if (layout->lineCount() > 0)
+            return layout->boundingRect().bottom();
+    }
+    return -1E9;
+}
+
+QTextFrame::iterator KTextDocumentLayout::Private::hitTestStart(qreal y)
+{
+    QTextFrame *root = parent->document()->rootFrame();
+    updateBlockIndex();
+    if (blockIndex.isEmpty())
+        return root->begin();
+    // the layout runs in document order, as long as it did not reach the last block the lines
+    // of earlier blocks can still be at their old place and the blocks are not sorted on y.
+    if (blockIndex.last().currentBlock().layout()->lineCount() == 0)
+        return root->begin();
+
+    // find the first block that is not above the point; everything before it can be skipped.
+    int low = 0;
+    int high = blockIndex.count();
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (blockBottom(middle) < y)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low == 0)
+        return root->begin();
+    QTextFrame::iterator it = blockIndex[low - 1];
+    return ++it;
+}
+
 void KTextDocumentLayout::Private::adjustSize()
 {
     if (parent->resizeMethod() == KTextDocument::NoResize)
@@ -196,6 +365,7 @@ void KTextDocumentLayout::setLayout(LayoutState *layout)
     Q_ASSERT(layout);
     delete m_state;
     m_state = layout;
+    d->fullRelayout = true;
     scheduleLayout();
 }
 
@@ -211,11 +381,13 @@ bool KTextDocumentLayout::hasLayouter() const
 void KTextDocumentLayout::addShape(KShape *shape)
 {
     d->shapes.append(shape);
+    d->shapeIndexValid = false;
 
     KTextShapeData *data = qobject_cast<KTextShapeData*>(shape->userData());
     if (data) {
         data->foul();
         m_state->interrupted = true;
+        d->fullRelayout = true;
     }
     emit shapeAdded(shape);
 }
@@ -267,7 +439,7 @@ QRectF KTextDocumentLayout::frameBoundingRect(QTextFrame *frame) const
 
 int KTextDocumentLayout::hitTest(const QPointF &point, Qt::HitTestAccuracy accuracy) const
 {
-    int position = hitTestIterated(document()->rootFrame()->begin(),
+    int position = hitTestIterated(d->hitTestStart(point.y()),
                         document()->rootFrame()->end(), point, accuracy);
     if (accuracy != Qt::ExactHit && position == -1)
         return document()->rootFrame()->lastPosition();
@@ -337,7 +509,7 @@ int KTextDocumentLayout::pageCount() const
 
 void KTextDocumentLayout::documentChanged(int position, int charsRemoved, int charsAdded)
 {
-    Q_UNUSED(charsRemoved);
+    d->blockIndexValid = false;
     if (shapes().count() == 0) // nothing to do.
         return;
 
@@ -371,14 +543,20 @@ void KTextDocumentLayout::documentChanged(int position, int charsRemoved, int ch
         from = block.position() + block.length();
     }
 
+    // keep track of the changed text so the layout can stop as soon as it is past it.
+    if (d->changedRangeEnd >= position)
+        d->changedRangeEnd = movedPosition(d->changedRangeEnd, position, charsRemoved, charsAdded);
+    d->changedRangeEnd = qMax(d->changedRangeEnd, position + charsAdded);
+
     foreach (KShape *shape, shapes()) {
         KTextShapeData *data = qobject_cast<KTextShapeData*>(shape->userData());
         Q_ASSERT(data);
         if (data && data->position() <= position && data->endPosition() >= position) {
             // found our (first) shape to re-layout
+            d->movePositions(shape, position, charsRemoved, charsAdded);
             data->foul();
             m_state->interrupted = true;
-            scheduleLayout();
+            scheduleLayoutWithoutInterrupt();
             return;
         }
     }
@@ -388,7 +566,15 @@ void KTextDocumentLayout::documentChanged(int position, int charsRemoved, int ch
     Q_ASSERT(data);
     data->foul();
     m_state->interrupted = true;
-    scheduleLayout();
+    d->fullRelayout = true;
+    scheduleLayoutWithoutInterrupt();
+}
+
+int KTextDocumentLayout::changedRangeEnd() const
+{
+    if (d->fullRelayout)
+        return -1;
+    return d->changedRangeEnd;
 }
 
 void KTextDocumentLayout::drawInlineObject(QPainter *painter, const QRectF &rect, QTextInlineObject object, int position, const QTextFormat &format)
@@ -446,6 +632,7 @@ void KTextDocumentLayout::scheduleLayoutWithoutInterrupt()
 
 void KTextDocumentLayout::scheduleLayout()
 {
+    d->fullRelayout = true;
     if (! d->scheduled) {
         scheduleLayoutWithoutInterrupt();
         interruptLayout();
@@ -459,6 +646,7 @@ void KTextDocumentLayout::relayout()
 
 void KTextDocumentLayout::interruptLayout()
 {
+    d->fullRelayout = true;
     m_state->interrupted = true;
 }
 
@@ -526,15 +714,35 @@ QList<KShape*> KTextDocumentLayout::shapes() const
 
 KShape* KTextDocumentLayout::shapeForPosition(int position) const
 {
-    // TODO make faster
-    foreach(KShape *shape, shapes()) {
-        KTextShapeData *data = qobject_cast<KTextShapeData*>(shape->userData());
-        if (data == 0)
-            continue;
-        if (data->position() <= position && (data->endPosition() == -1 || data->endPosition() > position))
-            return shape;
+    d->updateShapeIndex();
+    if (!d->shapeIndexOrdered) {
+        foreach(KShape *shape, shapes()) {
+            KTextShapeData *data = qobject_cast<KTextShapeData*>(shape->userData());
+            if (data == 0)
+                continue;
+            if (data->position() <= position && (data->endPosition() == -1 || data->endPosition() > position))
+                return shape;
+        }
+        return 0;
+    }
+
+    // find the last shape that starts at or before position
+    int low = 0;
+    int high = d->shapeIndex.count();
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (d->shapeIndex[middle].position <= position)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low > 0) {
+        const Private::ShapeSpan &span = d->shapeIndex[low - 1];
+        if ((span.endPosition == -1 || span.endPosition > position)
+                && (d->unlayoutedShape == 0 || span.order < d->unlayoutedShapeOrder))
+            return span.shape;
     }
-    return 0;
+    return d->unlayoutedShape;
 }
 
 void KTextDocumentLayout::setResizeMethod(KTextDocument::ResizeMethod method)
@@ -183,6 +183,14 @@ public:
         virtual void registerInlineObject(const QTextInlineObject &inlineObject) = 0;
         /// called by the KTextDocumentLayout to find out which if any table cell is hit. Returns 0 when no hit
         virtual QTextTableCell hitTestTable(QTextTable *table, const QPointF &point) = 0;
+        /**
+         * Return true if the last call to nextParag() found that the rest of the document
+         * would be laid out exactly as before and skipped to its end instead.
+         * @see KTextDocumentLayout::changedRangeEnd()
+         */
+        virtual bool reusedLayout() const {
+            return false;
+        }
 
         /// the index in the list of shapes (or frameset) of the shape we are currently layouting.
         int shapeNumber;
@@ -205,6 +213,14 @@ public:
     /// reimplemented from QAbstractTextDocumentLayout
     virtual void documentChanged(int position, int charsRemoved, int charsAdded);
 
+    /**
+     * Returns the document position up to which the text has been changed since the last
+     * complete layout run, or -1 if the layout has to be redone till the end of the document.
+     * A LayoutState can stop laying out once a paragraph starting after this position ends
+     * up at the same place it was before, since the text following it did not change.
+     */
+    int changedRangeEnd() const;
+
     /**
      * Sets the document's resizing method. @see KTextDocument::setResizeMethod
      */
@@ -59,6 +59,8 @@
 #include <KUndoStack>
 #include <QUndoCommand>
 
+static int s_positionsRevision = 0;
+
 class KTextShapeDataPrivate : public KTextShapeDataBasePrivate
 {
 public:
@@ -97,10 +99,12 @@ KTextShapeData::KTextShapeData()
     : KTextShapeDataBase(*(new KTextShapeDataPrivate()))
 {
     setDocument(new QTextDocument, true);
+    ++s_positionsRevision;
 }
 
 KTextShapeData::~KTextShapeData()
 {
+    ++s_positionsRevision;
 }
 
 void KTextShapeData::setDocument(QTextDocument *document, bool transferOwnership)
@@ -152,7 +156,10 @@ int KTextShapeData::position() const
 void KTextShapeData::setPosition(int position)
 {
     Q_D(KTextShapeData);
+    if (d->position == position)
+        return;
     d->position = position;
+    ++s_positionsRevision;
 }
 
 int KTextShapeData::endPosition() const
@@ -164,13 +171,22 @@ int KTextShapeData::endPosition() const
 void KTextShapeData::setEndPosition(int position)
 {
     Q_D(KTextShapeData);
+    if (d->endPosition == position)
+        return;
     d->endPosition = position;
+    ++s_positionsRevision;
 }
 
 void KTextShapeData::foul()
 {
     Q_D(KTextShapeData);
     d->dirty = true;
+    ++s_positionsRevision;
+}
+
+int KTextShapeData::positionsRevision()
+{
+    return s_positionsRevision;
 }
 
 void KTextShapeData::wipe()
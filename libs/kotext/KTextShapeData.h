@@ -108,6 +108,13 @@ public:
     /// emits a relayout
     void fireResizeEvent();
 
+    /**
+     * Return a number that changes whenever the position, end-position or dirty state of any
+     * text shape data changes, or one is created or deleted.
+     * KTextDocumentLayout uses this to know when its position-to-shape lookup is outdated.
+     */
+    static int positionsRevision();
+
     enum RelayoutForPageState {
         NormalState = 0, ///< totally outside the relayout-for-page
         LayoutCopyShape, ///< doing a relayout for page
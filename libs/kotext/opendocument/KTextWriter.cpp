@@ -171,6 +171,7 @@ public:
     QString saveParagraphStyle(const QTextBlock &block);
     QString saveParagraphStyle(const QTextBlockFormat &blockFormat, const QTextCharFormat &charFormat);
     QString saveCharacterStyle(const QTextCharFormat &charFormat, const QTextCharFormat &blockCharFormat);
+    QString saveCharacterStyle(const QTextFragment &fragment, const QTextBlock &block);
     QHash<QTextList *, QString> saveListStyles(QTextBlock block, int to);
     void saveParagraph(const QTextBlock &block, int from, int to);
     void saveTable(QTextTable *table, QHash<QTextList *, QString> &listStyles);
@@ -192,6 +193,11 @@ public:
     KDocumentRdfBase *rdfData;
     QTextDocument *document;
 
+    // Generated style names of this write, keyed on the format indexes of the
+    // document so that blocks and fragments sharing a format are converted only once.
+    QHash<QPair<int, int>, QString> paragraphStyleNames;
+    QHash<QPair<int, int>, QString> characterStyleNames;
+
     QStack<int> changeStack;
     QMap<int, QString> changeTransTable;
     QList<int> savedDeleteChanges;
@@ -364,13 +370,22 @@ QString KTextWriter::Private::generateDeleteChangeXml(KDeleteChangeMarker *marke
     writer = &newXmlWriter;
     context.setXmlWriter(newXmlWriter);
 
+    //The format indexes of the fragment document differ from the ones of the
+    //actual document, so its style names need their own caches
+    const QHash<QPair<int, int>, QString> oldParagraphStyleNames = paragraphStyleNames;
+    const QHash<QPair<int, int>, QString> oldCharacterStyleNames = characterStyleNames;
+    paragraphStyleNames.clear();
+    characterStyleNames.clear();
+
     //Call writeBlocks to generate the xml
     QHash<QTextList *,QString> listStyles = saveListStyles(doc.firstBlock(), doc.characterCount());
     writeBlocks(&doc, 0, doc.characterCount(),listStyles);
 
-    //Restore the actual xml writer
+    //Restore the actual xml writer and style name caches
     writer = &oldWriter;
     context.setXmlWriter(oldWriter);
+    paragraphStyleNames = oldParagraphStyleNames;
+    characterStyleNames = oldCharacterStyleNames;
 
     QString generatedXmlString(xmlArray);
     return generatedXmlString;
@@ -618,7 +633,14 @@ QString KTextWriter::saveParagraphStyle(const QTextBlockFormat &blockFormat, con
 
 QString KTextWriter::Private::saveParagraphStyle(const QTextBlock &block)
 {
-    return KTextWriter::saveParagraphStyle(block, styleManager, context);
+    const QPair<int, int> key(block.blockFormatIndex(), block.charFormatIndex());
+    QHash<QPair<int, int>, QString>::const_iterator it = paragraphStyleNames.constFind(key);
+    if (it != paragraphStyleNames.constEnd())
+        return it.value();
+
+    QString generatedName = KTextWriter::saveParagraphStyle(block, styleManager, context);
+    paragraphStyleNames.insert(key, generatedName);
+    return generatedName;
 }
 
 QString KTextWriter::Private::saveParagraphStyle(const QTextBlockFormat &blockFormat, const QTextCharFormat &charFormat)
@@ -664,6 +686,18 @@ QString KTextWriter::Private::saveCharacterStyle(const QTextCharFormat &charForm
     return generatedName;
 }
 
+QString KTextWriter::Private::saveCharacterStyle(const QTextFragment &fragment, const QTextBlock &block)
+{
+    const QPair<int, int> key(fragment.charFormatIndex(), block.charFormatIndex());
+    QHash<QPair<int, int>, QString>::const_iterator it = characterStyleNames.constFind(key);
+    if (it != characterStyleNames.constEnd())
+        return it.value();
+
+    QString generatedName = saveCharacterStyle(fragment.charFormat(), block.charFormat());
+    characterStyleNames.insert(key, generatedName);
+    return generatedName;
+}
+
 // A convinience function to get a listId from a list-format
 static KListStyle::ListIdType ListId(const QTextListFormat &format)
 {
@@ -778,7 +812,6 @@ void KTextWriter::Private::saveParagraph(const QTextBlock &block, int from, int
     }
 
     // Write the fragments and their formats
-    QTextCharFormat blockCharFormat = cursor.blockCharFormat();
     QTextCharFormat previousCharFormat;
     QTextBlock::iterator it;
     for (it = block.begin(); !(it.atEnd()); ++it) {
@@ -842,7 +875,7 @@ void KTextWriter::Private::saveParagraph(const QTextBlock &block, int from, int
                     bool saveSpan = dynamic_cast<KVariable*>(inlineObject) != 0;
 
                     if (saveSpan) {
-                        QString styleName = saveCharacterStyle(charFormat, blockCharFormat);
+                        QString styleName = saveCharacterStyle(currentFragment, block);
                         if (!styleName.isEmpty()) {
                             writer->startElement("text:span", false);
                             writer->addAttribute("text:style-name", styleName);
@@ -899,7 +932,7 @@ void KTextWriter::Private::saveParagraph(const QTextBlock &block, int from, int
                     }
                 }
             } else {
-                QString styleName = saveCharacterStyle(charFormat, blockCharFormat);
+                QString styleName = saveCharacterStyle(currentFragment, block);
 
                 TagInformation fragmentTagInformation;
                 if (charFormat.isAnchor()) {
@@ -2319,6 +2352,8 @@ void KTextWriter::Private::writeNode(QTextStream &outputXmlStream, KXmlNode &nod
 void KTextWriter::write(QTextDocument *document, int from, int to)
 {
     d->document = document;
+    d->paragraphStyleNames.clear();
+    d->characterStyleNames.clear();
     d->styleManager = KTextDocument(document).styleManager();
     d->layout = qobject_cast<KTextDocumentLayout*>(document->documentLayout());
 
@@ -20,6 +20,8 @@
  */
 #include "TestDocumentLayout.h"
 #include "MockTextShape.h"
+
+#include <KTextShapeData.h>
 #include <QtCore/QPointF>
 #include <QtGui/QTextBlock>
 #include <QtGui/QTextLine>
@@ -98,6 +100,45 @@ void TestDocumentLayout::testHitTest()
     QVERIFY(layout->hitTest(QPointF(20, paragOffets[1] + 20), Qt::FuzzyHit) > 109);
 }
 
+void TestDocumentLayout::testShapeForPosition()
+{
+    initForNewTest();
+    doc->setPlainText("Lorem ipsum dolor sit amet, consectetuer adipiscing elit.");
+    MockTextShape *shape2 = new MockTextShape();
+    MockTextShape *shape3 = new MockTextShape();
+    layout->addShape(shape2);
+    layout->addShape(shape3);
+
+    KTextShapeData *data1 = qobject_cast<KTextShapeData*>(shape1->userData());
+    KTextShapeData *data2 = qobject_cast<KTextShapeData*>(shape2->userData());
+    KTextShapeData *data3 = qobject_cast<KTextShapeData*>(shape3->userData());
+    data1->setPosition(0);
+    data1->setEndPosition(20);
+    data2->setPosition(20);
+    data2->setEndPosition(40);
+
+    // shape3 has no text yet, so it is used for everything after the others.
+    QCOMPARE(layout->shapeForPosition(0), shape1);
+    QCOMPARE(layout->shapeForPosition(19), shape1);
+    QCOMPARE(layout->shapeForPosition(20), shape2);
+    QCOMPARE(layout->shapeForPosition(39), shape2);
+    QCOMPARE(layout->shapeForPosition(40), shape3);
+
+    // changing the positions is noticed without telling the layout
+    data3->setPosition(40);
+    data3->setEndPosition(50);
+    QCOMPARE(layout->shapeForPosition(45), shape3);
+    QCOMPARE(layout->shapeForPosition(50), static_cast<KShape*>(0));
+    data2->setEndPosition(45);
+    QCOMPARE(layout->shapeForPosition(42), shape2);
+    QCOMPARE(layout->shapeForPosition(45), shape3);
+
+    // overlapping shapes; the first one wins
+    data1->setEndPosition(30);
+    QCOMPARE(layout->shapeForPosition(25), shape1);
+    QCOMPARE(layout->shapeForPosition(30), shape2);
+}
+
 QTEST_KDEMAIN(TestDocumentLayout, GUI)
 
 #include <TestDocumentLayout.moc>
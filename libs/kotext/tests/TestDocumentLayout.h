@@ -40,6 +40,8 @@ private slots:
 
     /// Test the hittest of KTextDocumentLayout
     void testHitTest();
+    /// Test finding the shape of a text position
+    void testShapeForPosition();
 
 private:
     void initForNewTest();
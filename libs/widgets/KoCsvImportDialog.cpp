@@ -248,6 +248,46 @@ void KoCsvImportDialog::setThousandsSeparator(const QString& separator)
     d->dialog->m_thousandsSeparator->setText(separator);
 }
 
+QString KoCsvImportDialog::delimiter() const
+{
+    return d->delimiter;
+}
+
+QChar KoCsvImportDialog::textQuote() const
+{
+    return d->textQuote;
+}
+
+bool KoCsvImportDialog::ignoreDuplicates() const
+{
+    return d->ignoreDuplicates;
+}
+
+QTextCodec* KoCsvImportDialog::codec() const
+{
+    return d->codec;
+}
+
+int KoCsvImportDialog::startRow() const
+{
+    return d->startRow + 1;
+}
+
+int KoCsvImportDialog::endRow() const
+{
+    return d->endRow;
+}
+
+int KoCsvImportDialog::startCol() const
+{
+    return d->startCol + 1;
+}
+
+int KoCsvImportDialog::endCol() const
+{
+    return d->endCol;
+}
+
 
 // ----------------------------------------------------------------
 
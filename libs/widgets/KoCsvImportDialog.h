@@ -25,6 +25,8 @@
 
 #include "kowidgets_export.h"
 
+class QTextCodec;
+
 /**
  * A dialog to choose the options for importing CSV data.
  */
@@ -120,6 +122,48 @@ public:
      */
     void setThousandsSeparator(const QString& separator);
 
+    /**
+     * \return the delimiter of the fields
+     */
+    QString delimiter() const;
+
+    /**
+     * \return the character enclosing quoted fields or a null character
+     */
+    QChar textQuote() const;
+
+    /**
+     * \return whether consecutive delimiters are treated as one
+     */
+    bool ignoreDuplicates() const;
+
+    /**
+     * \return the codec used to decode the data
+     */
+    QTextCodec* codec() const;
+
+    /**
+     * \return the first row to import, 1 based
+     * The import range and the options above allow to read the data without
+     * the table of this dialog, e.g. if only the beginning was set as preview.
+     */
+    int startRow() const;
+
+    /**
+     * \return the last row to import or -1 for all rows
+     */
+    int endRow() const;
+
+    /**
+     * \return the first column to import, 1 based
+     */
+    int startCol() const;
+
+    /**
+     * \return the last column to import or -1 for all columns
+     */
+    int endCol() const;
+
 protected slots:
     void returnPressed();
     void formatChanged(const QString&);
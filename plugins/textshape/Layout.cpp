@@ -71,6 +71,7 @@ Layout::Layout(KTextDocumentLayout *parent)
         m_data(0),
         m_isRtl(false),
         m_inTable(false),
+        m_reusedLayout(false),
         m_parent(parent),
         m_textShape(0),
         m_demoText(false),
@@ -355,6 +356,7 @@ bool Layout::nextParag()
 {
     Q_ASSERT(shape);
     m_inlineObjectHeights.clear();
+    m_reusedLayout = false;
     QTextBlock prevBlock = m_block;
     if (layout && !m_restartingFirstCellAfterTableBreak) { // guard against first time or first time after table relayout
         layout->endLayout();
@@ -417,6 +419,8 @@ bool Layout::nextParag()
         // Save the current table cell.
         m_tableCell = table->cellAt(m_block.position());
         Q_ASSERT(m_tableCell.isValid());
+    } else if (skipUnchangedText()) {
+        return false;
     }
     m_format = m_block.blockFormat();
     m_blockData = dynamic_cast<KTextBlockData*>(m_block.userData());
@@ -915,6 +919,7 @@ void Layout::resetPrivate()
 {
     m_demoText = false;
     m_endOfDemoText = false;
+    m_reusedLayout = false;
     m_y = 0;
     m_data = 0;
     shape = 0;
@@ -1014,6 +1019,77 @@ void Layout::resetPrivate()
         shapeNumber++;
 }
 
+bool Layout::skipUnchangedText()
+{
+    const int changedRangeEnd = m_parent->changedRangeEnd();
+    if (changedRangeEnd < 0 || m_block.position() <= changedRangeEnd)
+        return false;
+    // state carried over from the previous paragraphs makes the position unpredictable.
+    if (m_newShape || m_inTable || m_frameStack.count() > 1 || m_dropCapsAffectsNMoreLines > 0)
+        return false;
+    if (m_parent->resizeMethod() != KTextDocument::NoResize
+            || m_data->verticalAlignment() == Qt::AlignVCenter || m_data->verticalAlignment() == Qt::AlignBottom)
+        return false;
+
+    QTextLayout *blockLayout = m_block.layout();
+    if (blockLayout->lineCount() == 0 || m_block.textList())
+        return false;
+    const QTextBlockFormat format = m_block.blockFormat();
+    if (format.hasProperty(KParagraphStyle::MasterPageName) || format.boolProperty(KParagraphStyle::DropCaps)
+            || (format.pageBreakPolicy() & QTextFormat::PageBreak_AlwaysBefore))
+        return false;
+    // borders are merged with the neighbouring paragraphs, don't try to predict those.
+    KTextBlockData *blockData = dynamic_cast<KTextBlockData*>(m_block.userData());
+    KTextBlockData *prevBlockData = dynamic_cast<KTextBlockData*>(m_block.previous().userData());
+    if ((blockData && blockData->border()) || (prevBlockData && prevBlockData->border()))
+        return false;
+
+    // this is where nextParag() would place the first line, see topMargin() and updateBorders()
+    const qreal y = m_y + format.topMargin() + m_data->shapeMargins().top
+        + format.doubleProperty(KParagraphStyle::TopPadding);
+    if (qAbs(blockLayout->lineAt(0).y() - y) > 0.126) // rounding problems due to Qt-scribe internally using ints.
+        return false;
+
+    // the old layout of the rest of the text is only valid if the following shapes still hold it.
+    QList<KShape *> shapes = m_parent->shapes();
+    int lastShapeNumber = shapeNumber;
+    for (int i = shapeNumber + 1; i < shapes.count(); ++i) {
+        KTextShapeData *data = qobject_cast<KTextShapeData*>(shapes[i]->userData());
+        if (data == 0)
+            continue;
+        if (data->isDirty())
+            return false;
+        if (data->position() >= 0)
+            lastShapeNumber = i;
+    }
+    KShape *lastShape = shapes[lastShapeNumber];
+    KTextShapeData *lastData = qobject_cast<KTextShapeData*>(lastShape->userData());
+    const QTextBlock lastBlock = m_parent->document()->lastBlock();
+    if (lastData->endPosition() < lastBlock.position() + lastBlock.length() - 1)
+        return false; // the text did not fit in the shapes.
+    QTextLayout *lastLayout = lastBlock.layout();
+    if (lastLayout->lineCount() == 0)
+        return false;
+
+    // done; leave the state as if we laid out all text.
+    m_data->wipe();
+    if (m_textShape)
+        m_textShape->markLayoutDone();
+    shapeNumber = lastShapeNumber;
+    shape = lastShape;
+    m_data = lastData;
+    m_textShape = dynamic_cast<TextShape*>(lastShape);
+    m_shapeBorder = shape->insets();
+    m_shapeBorder += m_data->insets();
+    QTextLine lastLine = lastLayout->lineAt(lastLayout->lineCount() - 1);
+    m_y = lastLine.y() + lastLine.height();
+    m_block = lastBlock.next();
+    updateFrameStack();
+    cleanupShapes();
+    m_reusedLayout = true;
+    return true;
+}
+
 void Layout::updateBorders()
 {
     Q_ASSERT(m_data);
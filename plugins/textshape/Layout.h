@@ -69,6 +69,10 @@ public:
     /// called by the KTextDocumentLayout to notify the LayoutState of a successfully resized inline object
     virtual void registerInlineObject(const QTextInlineObject &inlineObject);
     virtual QTextTableCell hitTestTable(QTextTable *table, const QPointF &point);
+    /// reimplemented from superclass
+    virtual bool reusedLayout() const {
+        return m_reusedLayout;
+    }
 
     /// paint the document
     virtual void draw(QPainter *painter, const KTextDocumentLayout::PaintContext & context);
@@ -112,6 +116,15 @@ private:
     qreal findFootnote(const QTextLine &line, int *oldLength);
     void resetPrivate();
 
+    /**
+     * Skip to the end of the document if the current block and everything after it
+     * would be laid out exactly as in the previous layout run.
+     * This is only possible when the block follows all text changed since then and
+     * starts at the same position it had before.
+     * @return true if the layout run is finished.
+     */
+    bool skipUnchangedText();
+
     /**
      * Handle any table layout work that needs to be done for the current block.
      *
@@ -148,6 +161,7 @@ private:
     QTextBlock::Iterator m_fragmentIterator;
     KTextShapeData *m_data;
     bool m_newShape, m_newParag, m_isRtl, m_inTable;
+    bool m_reusedLayout;
     KInsets m_borderInsets;
     KInsets m_shapeBorder;
     KTextDocumentLayout *m_parent;
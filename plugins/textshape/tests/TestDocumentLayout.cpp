@@ -930,6 +930,40 @@ void TestDocumentLayout::testShapePosition2()
     QCOMPARE(shape2->textShapeData()->endPosition(), m_loremIpsum.length() + 5);
 }
 
+void TestDocumentLayout::testIncrementalLayout()
+{
+    initForNewTest("line\nParag2\nSimple Parag\nLast");
+
+    m_shape1->setSize(QSizeF(200, 40));
+    MockTextShape *shape2 = new MockTextShape();
+    shape2->setSize(QSizeF(200, 100));
+    m_layout->addShape(shape2);
+
+    m_layout->layout();
+    QVERIFY(!m_textLayout->reusedLayout());
+    QTextBlock last = m_doc->lastBlock();
+    const qreal lastY = last.layout()->lineAt(0).y();
+
+    // typing in the first parag does not change its height, the rest can be reused.
+    QTextCursor cursor(m_doc);
+    cursor.setPosition(4);
+    cursor.insertText("s");
+    m_layout->layout();
+    QVERIFY(m_textLayout->reusedLayout());
+    QCOMPARE(last.layout()->lineCount(), 1);
+    QCOMPARE(last.layout()->lineAt(0).y(), lastY);
+    QCOMPARE(m_shape1->textShapeData()->position(), 0);
+    QCOMPARE(m_shape1->textShapeData()->endPosition(), 12);
+    QCOMPARE(shape2->textShapeData()->position(), 13);
+    QCOMPARE(shape2->textShapeData()->endPosition(), 31);
+
+    // a parag that grows pushes the rest down.
+    cursor.insertText(QString(QChar::LineSeparator));
+    m_layout->layout();
+    QVERIFY(!m_textLayout->reusedLayout());
+    QVERIFY(last.layout()->lineAt(0).y() > lastY);
+}
+
 QTEST_KDEMAIN(TestDocumentLayout, GUI)
 
 #include <TestDocumentLayout.moc>
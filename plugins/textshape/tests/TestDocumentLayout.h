@@ -63,6 +63,8 @@ private slots:
     /// test data integrety for multiple shapes.
     void testShapePosition();
     void testShapePosition2();
+    /// Test that an edit which keeps the height of its parag does not relayout the rest.
+    void testIncrementalLayout();
 
 // Block styles
     /// Test top, left, right and bottom margins of paragraphs.